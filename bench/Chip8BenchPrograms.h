@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8Types.h"
+
+#include <initializer_list>
+#include <vector>
+
+/**
+* A named synthetic program that stands in for one kind of real program.
+*/
+struct Chip8BenchWorkload
+{
+	const char* name;
+	std::vector<u8> program;
+};
+
+
+/**
+* Synthetic programs built into the benchmarks, so they run without any program files.
+*/
+namespace Chip8BenchPrograms
+{
+	/**
+	* Appends big-endian opcodes to a program image.
+	*/
+	inline void Append(std::vector<u8>& program, std::initializer_list<u16> ops)
+	{
+		for (const auto op : ops)
+		{
+			program.push_back(static_cast<u8>(op >> 8));
+			program.push_back(static_cast<u8>(op));
+		}
+	}
+
+	/**
+	* Builds a program that runs the setup opcodes once, then count copies of op in a loop.
+	* The jump back is the only other instruction in the loop, so it is amortized over the copies.
+	*/
+	inline std::vector<u8> MakeOpcodeLoop(std::initializer_list<u16> setup, u16 op, u16 count = 64)
+	{
+		std::vector<u8> program;
+		Append(program, setup);
+		const auto loopStart = static_cast<u16>(CHIP8_PROGRAM_START + program.size());
+		for (u16 i = 0; i < count; ++i)
+		{
+			Append(program, { op });
+		}
+
+		Append(program, { static_cast<u16>(0x1000 | loopStart) });
+		return program;
+	}
+
+	/**
+	* Builds a program that calls an empty subroutine twice in a loop.
+	*/
+	inline std::vector<u8> MakeCallLoop()
+	{
+		std::vector<u8> program;
+		Append(program, {
+			0x2206,	// 0x200: CALL 0x206
+			0x2206,	// 0x202: CALL 0x206
+			0x1200,	// 0x204: JP 0x200
+			0x00EE	// 0x206: RET
+		});
+		return program;
+	}
+
+	/**
+	* Builds a program that draws an n-line font sprite at (x, y) over and over.
+	*/
+	inline std::vector<u8> MakeDrawLoop(u8 x, u8 y, u8 lines)
+	{
+		return MakeOpcodeLoop({
+			static_cast<u16>(0x6000 | x),					// LD V0, x
+			static_cast<u16>(0x6100 | y),					// LD V1, y
+			0xA000 | CHIP8_PROGRAM_DEFAULT_SPRITES_START	// LD I, (the font sprites)
+		}, static_cast<u16>(0xD010 | (lines & 0xF)));
+	}
+
+	/**
+	* Builds the workloads of the macro benchmark. Each loops forever, so it can run for any amount of cycles.
+	*/
+	inline std::vector<Chip8BenchWorkload> MakeWorkloads()
+	{
+		std::vector<Chip8BenchWorkload> workloads;
+
+		// Draws font sprites all over the display, as games redrawing their playfield do.
+		std::vector<u8> sprite;
+		Append(sprite, {
+			0xF229,	// 0x200: LD F, V2
+			0xD015,	// 0x202: DRW V0, V1, 5
+			0x7005,	// 0x204: ADD V0, 5
+			0x7103,	// 0x206: ADD V1, 3
+			0x7201,	// 0x208: ADD V2, 1
+			0x1200	// 0x20A: JP 0x200
+		});
+		workloads.push_back(Chip8BenchWorkload{ "sprite", sprite });
+
+		// Arithmetic and logic on the registers, with the occasional skip.
+		std::vector<u8> alu;
+		Append(alu, {
+			0x7013,	// 0x200: ADD V0, 0x13
+			0x8104,	// 0x202: ADD V1, V0
+			0x8215,	// 0x204: SUB V2, V1
+			0x8306,	// 0x206: SHR V3
+			0x8421,	// 0x208: OR V4, V2
+			0x8512,	// 0x20A: AND V5, V1
+			0x8643,	// 0x20C: XOR V6, V4
+			0x870E,	// 0x20E: SHL V7
+			0x8317,	// 0x210: SUBN V3, V1
+			0x4F00,	// 0x212: SNE VF, 0
+			0x7801,	// 0x214: ADD V8, 1
+			0x1200	// 0x216: JP 0x200
+		});
+		workloads.push_back(Chip8BenchWorkload{ "alu", alu });
+
+		// Nested subroutine calls.
+		std::vector<u8> call;
+		Append(call, {
+			0x2206,	// 0x200: CALL 0x206
+			0x2206,	// 0x202: CALL 0x206
+			0x1200,	// 0x204: JP 0x200
+			0x220C,	// 0x206: CALL 0x20C
+			0x220C,	// 0x208: CALL 0x20C
+			0x00EE,	// 0x20A: RET
+			0x7001,	// 0x20C: ADD V0, 1
+			0x00EE	// 0x20E: RET
+		});
+		workloads.push_back(Chip8BenchWorkload{ "call", call });
+
+		// Beeps, then spins on DT until it runs out, as most programs wait for the next frame.
+		std::vector<u8> timer;
+		Append(timer, {
+			0x6003,	// 0x200: LD V0, 3
+			0xF015,	// 0x202: LD DT, V0
+			0xF018,	// 0x204: LD ST, V0
+			0xF007,	// 0x206: LD V0, DT
+			0x3000,	// 0x208: SE V0, 0
+			0x1206,	// 0x20A: JP 0x206
+			0x1200	// 0x20C: JP 0x200
+		});
+		workloads.push_back(Chip8BenchWorkload{ "timer", timer });
+
+		// Rewrites the immediate of the ADD it is about to run.
+		std::vector<u8> selfModifying;
+		Append(selfModifying, {
+			0xA20A,	// 0x200: LD I, 0x20A
+			0x6073,	// 0x202: LD V0, 0x73 (the high byte of ADD V3, byte)
+			0x7101,	// 0x204: ADD V1, 1
+			0xF155,	// 0x206: LD [I], V1
+			0x6200,	// 0x208: LD V2, 0
+			0x7300,	// 0x20A: ADD V3, (V1)
+			0x1200	// 0x20C: JP 0x200
+		});
+		workloads.push_back(Chip8BenchWorkload{ "self_modifying", selfModifying });
+
+		return workloads;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,425 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Chip8AudioBackend.h"
+#include "Chip8AudioRecorder.h"
+#include "Chip8BenchPrograms.h"
+#include "Chip8Beeper.h"
+#include "Chip8CPU.h"
+#include "Chip8Display.h"
+#include "Chip8Helper.h"
+#include "Chip8Keyboard.h"
+#include "Chip8Memory.h"
+
+/**
+* Options for a macro benchmark run.
+*/
+struct MacroOptions
+{
+	unsigned long long cycles = 20000000;
+	u32 stepsPerFrame = CHIP8_CPU_STEPS_PER_FRAME;
+	unsigned int repetitions = 3;
+	std::string outputFileName;
+	std::vector<std::string> workloadNames;
+};
+
+
+/**
+* The result of running a workload.
+*/
+struct MacroResult
+{
+	std::string name;
+	unsigned long long instructions;
+	unsigned long long frames;
+	double executeSeconds; // Fastest of the timed runs that only run the machine.
+	double seconds; // Fastest of the timed runs that also present every frame.
+	double inputSeconds, cpuSeconds, audioSeconds, displaySeconds; // From the instrumented run.
+	unsigned long long peakRSSKilobytes;
+	u64 displayHash, audioHash;
+	bool isOK;
+};
+
+
+/**
+* Sends the beep to a recorder, adding the time spent doing so to a counter.
+*/
+class MacroTimedAudioBackend : public Chip8AudioBackend
+{
+public:
+	explicit MacroTimedAudioBackend(std::chrono::steady_clock::duration& time) : time_(time), recorder_(false) {}
+
+	bool PushEvent(const Chip8AudioEvent& event) override
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const auto isOK = recorder_.PushEvent(event);
+		time_ += std::chrono::steady_clock::now() - start;
+		return isOK;
+	}
+
+	void OnTimerTick() override
+	{
+		const auto start = std::chrono::steady_clock::now();
+		recorder_.OnTimerTick();
+		time_ += std::chrono::steady_clock::now() - start;
+	}
+
+	u64 GetHash() const { return recorder_.GetHash(); }
+
+private:
+	std::chrono::steady_clock::duration& time_;
+	Chip8AudioRecorder recorder_;
+};
+
+
+/**
+* The real machine a workload runs on, presenting each frame into an RGBA framebuffer as a frontend
+* uploading a texture would.
+*/
+class MacroMachine
+{
+public:
+	MacroMachine(const std::vector<u8>& program, u32 stepsPerFrame, std::chrono::steady_clock::duration& audioTime) :
+	audioBackend_(new MacroTimedAudioBackend(audioTime)),
+	beeper_(std::unique_ptr<Chip8AudioBackend>(audioBackend_)),
+	cpu_(ram_, display_, keyboard_, &beeper_),
+	frameBuffer_(CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT * 4)
+	{
+		isLoaded_ = ram_.WriteBlock(CHIP8_PROGRAM_START, program.data(), static_cast<u16>(program.size()));
+		cpu_.SetStepsPerFrame(stepsPerFrame);
+		cpu_.SetRealTimeTimers(false);
+		cpu_.SeedRandom(0);
+	}
+
+	bool IsLoaded() const { return isLoaded_; }
+
+	inline void UpdateInput() { keyboard_.Update(); }
+
+	inline bool RunFrame() { return cpu_.RunFrame(); }
+
+	inline void Present()
+	{
+		const auto size = display_.GetSize();
+		display_.CopyPixels(pixels_);
+		frameBuffer_.resize(static_cast<size_t>(size));
+		for (u16 i = 0; i < size; ++i)
+		{
+			frameBuffer_[i] = (pixels_[i] != 0 ? 0xFFFFFFFF : 0xFF000000);
+		}
+	}
+
+	u64 GetDisplayHash() const
+	{
+		u8 pixels[CHIP8_DISPLAY_MAX_WIDTH * CHIP8_DISPLAY_MAX_HEIGHT];
+		display_.CopyPixels(pixels);
+		return Chip8Helper::HashFNV1a(pixels, display_.GetSize());
+	}
+
+	u64 GetAudioHash() const { return audioBackend_->GetHash(); }
+
+private:
+	Chip8Memory ram_;
+	Chip8Display display_;
+	Chip8Keyboard keyboard_;
+	MacroTimedAudioBackend* audioBackend_; // Owned by beeper_.
+	Chip8Beeper beeper_;
+	Chip8CPU cpu_;
+	u8 pixels_[CHIP8_DISPLAY_MAX_WIDTH * CHIP8_DISPLAY_MAX_HEIGHT];
+	std::vector<u32> frameBuffer_;
+	bool isLoaded_;
+};
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] [<workload>...]" << std::endl
+		<< "Runs built-in synthetic programs (sprite, alu, call, timer and self_modifying, or the named ones) on the" << std::endl
+		<< "emulator for a fixed amount of cycles, and writes the results as JSON. The instruction rate is measured" << std::endl
+		<< "on runs that don't present the frames, and the frame rate on runs that do." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --cycles <n>       Instructions to run each workload for (default: 20000000)" << std::endl
+		<< "  --steps <n>        Instructions per frame (default: " << CHIP8_CPU_STEPS_PER_FRAME << ")" << std::endl
+		<< "  --repetitions <n>  Timed runs of each workload, of which the fastest is reported (default: 3)" << std::endl
+		<< "  -o <file>          Write the JSON to a file instead of the standard output" << std::endl;
+}
+
+
+/**
+* Gets the peak resident set size of the process in kilobytes, or 0 if it is unknown.
+*/
+static unsigned long long GetPeakRSSKilobytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+
+	// Linux reports kilobytes, macOS bytes.
+#ifdef __APPLE__
+	return static_cast<unsigned long long>(usage.ru_maxrss) / 1024;
+#else
+	return static_cast<unsigned long long>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+
+/**
+* Gets a duration in seconds.
+*/
+static inline double ToSeconds(std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration<double>(duration).count();
+}
+
+
+/**
+* Runs a workload once as fast as the machine goes, presenting every frame or not, and records its status and hashes.
+* Returns the time it took in seconds.
+*/
+static double TimeRun(const Chip8BenchWorkload& workload, const MacroOptions& options, bool isPresenting, MacroResult& result)
+{
+	std::chrono::steady_clock::duration audioTime(0);
+	MacroMachine machine(workload.program, options.stepsPerFrame, audioTime);
+	result.isOK = machine.IsLoaded();
+
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned long long frame = 0; frame < result.frames && result.isOK; ++frame)
+	{
+		machine.UpdateInput();
+		result.isOK = machine.RunFrame();
+		if (isPresenting)
+		{
+			machine.Present();
+		}
+	}
+	const auto seconds = ToSeconds(std::chrono::steady_clock::now() - start);
+
+	result.displayHash = machine.GetDisplayHash();
+	result.audioHash = machine.GetAudioHash();
+	return seconds;
+}
+
+
+/**
+* Runs a workload: the timed runs first, then one run that times each subsystem every frame (which slows it down
+* too much to be timed itself).
+* Presenting a frame costs as much as running many instructions, so each repetition times a run that only runs the
+* machine, which the instruction rate is measured on, and one that also presents every frame, which the frame rate is.
+*/
+static MacroResult RunWorkload(const Chip8BenchWorkload& workload, const MacroOptions& options)
+{
+	MacroResult result = {};
+	result.name = workload.name;
+	result.frames = (options.cycles + options.stepsPerFrame - 1) / options.stepsPerFrame;
+	result.instructions = result.frames * options.stepsPerFrame;
+	result.executeSeconds = 0.0;
+	result.seconds = 0.0;
+	result.isOK = true;
+
+	for (unsigned int i = 0; i < options.repetitions && result.isOK; ++i)
+	{
+		const auto executeSeconds = TimeRun(workload, options, false, result);
+		const auto seconds = (result.isOK ? TimeRun(workload, options, true, result) : 0.0);
+		result.executeSeconds = (i == 0 ? executeSeconds : std::min(result.executeSeconds, executeSeconds));
+		result.seconds = (i == 0 ? seconds : std::min(result.seconds, seconds));
+	}
+
+	std::chrono::steady_clock::duration audioTime(0);
+	std::chrono::steady_clock::duration inputTime(0), cpuTime(0), displayTime(0);
+	MacroMachine machine(workload.program, options.stepsPerFrame, audioTime);
+	for (unsigned long long frame = 0; frame < result.frames && result.isOK; ++frame)
+	{
+		const auto inputStart = std::chrono::steady_clock::now();
+		machine.UpdateInput();
+		const auto cpuStart = std::chrono::steady_clock::now();
+		result.isOK = machine.RunFrame();
+		const auto displayStart = std::chrono::steady_clock::now();
+		machine.Present();
+		const auto end = std::chrono::steady_clock::now();
+
+		inputTime += cpuStart - inputStart;
+		cpuTime += displayStart - cpuStart;
+		displayTime += end - displayStart;
+	}
+
+	// The audio backend is called from within the CPU's frames.
+	result.inputSeconds = ToSeconds(inputTime);
+	result.cpuSeconds = ToSeconds(cpuTime - audioTime);
+	result.audioSeconds = ToSeconds(audioTime);
+	result.displaySeconds = ToSeconds(displayTime);
+	result.peakRSSKilobytes = GetPeakRSSKilobytes();
+	return result;
+}
+
+
+/**
+* Writes the results as JSON.
+*/
+static void WriteJSON(std::ostream& out, const std::vector<MacroResult>& results, const MacroOptions& options)
+{
+	const auto writeSplit = [&out](const char* name, double seconds, double total, bool isLast)
+	{
+		out << "        \"" << name << "\": " << (total > 0.0 ? seconds / total : 0.0) << (isLast ? "" : ",") << std::endl;
+	};
+
+	out << std::setprecision(9)
+		<< "{" << std::endl
+		<< "  \"benchmark\": \"sd5chip8-macro\"," << std::endl
+		<< "  \"version\": 2," << std::endl
+		<< "  \"cycles\": " << options.cycles << "," << std::endl
+		<< "  \"steps_per_frame\": " << options.stepsPerFrame << "," << std::endl
+		<< "  \"repetitions\": " << options.repetitions << "," << std::endl
+		<< "  \"peak_rss_kb\": " << GetPeakRSSKilobytes() << "," << std::endl
+		<< "  \"workloads\": [" << std::endl;
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const auto& result = results[i];
+		const auto splitTotal = result.inputSeconds + result.cpuSeconds + result.audioSeconds + result.displaySeconds;
+		out << "    {" << std::endl
+			<< "      \"name\": \"" << result.name << "\"," << std::endl
+			<< "      \"status\": \"" << (result.isOK ? "ok" : "cpu_error") << "\"," << std::endl
+			<< "      \"instructions\": " << result.instructions << "," << std::endl
+			<< "      \"frames\": " << result.frames << "," << std::endl
+			<< "      \"execute_seconds\": " << result.executeSeconds << "," << std::endl
+			<< "      \"seconds\": " << result.seconds << "," << std::endl
+			<< "      \"present_seconds\": " << std::max(0.0, result.seconds - result.executeSeconds) << "," << std::endl
+			<< "      \"instructions_per_second\": " << (result.executeSeconds > 0.0 ? result.instructions / result.executeSeconds : 0.0) << "," << std::endl
+			<< "      \"frames_per_second\": " << (result.seconds > 0.0 ? result.frames / result.seconds : 0.0) << "," << std::endl
+			<< "      \"peak_rss_kb\": " << result.peakRSSKilobytes << "," << std::endl
+			<< std::hex
+			<< "      \"display_hash\": \"" << result.displayHash << "\"," << std::endl
+			<< "      \"audio_hash\": \"" << result.audioHash << "\"," << std::endl
+			<< std::dec
+			<< "      \"time_split\": {" << std::endl;
+		writeSplit("input", result.inputSeconds, splitTotal, false);
+		writeSplit("cpu", result.cpuSeconds, splitTotal, false);
+		writeSplit("audio", result.audioSeconds, splitTotal, false);
+		writeSplit("display", result.displaySeconds, splitTotal, true);
+		out << "      }" << std::endl
+			<< "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+
+	out << "  ]" << std::endl
+		<< "}" << std::endl;
+}
+
+
+/**
+* Main entry point for the macro benchmark.
+*/
+int main(int argc, char* argv[])
+{
+	MacroOptions options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--cycles") == 0 && hasValue)
+		{
+			options.cycles = std::max(1ULL, std::strtoull(argv[++i], nullptr, 0));
+		}
+		else if (std::strcmp(argv[i], "--steps") == 0 && hasValue)
+		{
+			options.stepsPerFrame = std::max(1u, static_cast<u32>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue)
+		{
+			options.repetitions = std::max(1u, static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (std::strcmp(argv[i], "-o") == 0 && hasValue)
+		{
+			options.outputFileName = argv[++i];
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{
+			options.workloadNames.push_back(argv[i]);
+		}
+	}
+
+	auto workloads = Chip8BenchPrograms::MakeWorkloads();
+	for (const auto& name : options.workloadNames)
+	{
+		if (std::none_of(workloads.begin(), workloads.end(), [&name](const Chip8BenchWorkload& workload) { return name == workload.name; }))
+		{
+			std::cerr << "Unknown workload \"" << name << "\"." << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<MacroResult> results;
+	auto isAllOK = true;
+	for (const auto& workload : workloads)
+	{
+		if (!options.workloadNames.empty() &&
+			std::find(options.workloadNames.begin(), options.workloadNames.end(), workload.name) == options.workloadNames.end())
+		{
+			continue;
+		}
+
+		results.push_back(RunWorkload(workload, options));
+		const auto& result = results.back();
+		isAllOK &= result.isOK;
+		std::cerr << std::left << std::setw(16) << result.name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << result.instructions / result.executeSeconds / 1e6 << " M instructions/s"
+			<< std::setw(12) << result.frames / result.seconds << " frames/s"
+			<< std::setw(8) << std::max(0.0, result.seconds - result.executeSeconds) / result.seconds * 100.0 << "% presenting"
+			<< (result.isOK ? "" : " (CPU error)") << std::endl;
+	}
+	std::cerr << std::defaultfloat;
+
+	if (options.outputFileName.empty())
+	{
+		WriteJSON(std::cout, results, options);
+	}
+	else
+	{
+		auto file = std::ofstream(options.outputFileName);
+		WriteJSON(file, results, options);
+		if (!file.good())
+		{
+			std::cerr << "Failed to write the results to \"" << options.outputFileName << "\"." << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return (isAllOK ? EXIT_SUCCESS : EXIT_FAILURE);
+}
\ No newline at end of file
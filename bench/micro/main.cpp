@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Chip8.h"
+#include "Chip8AudioRecorder.h"
+#include "Chip8AudioSynth.h"
+#include "Chip8BenchPrograms.h"
+#include "Chip8CPU.h"
+#include "Chip8Display.h"
+#include "Chip8Keyboard.h"
+#include "Chip8Memory.h"
+#include "Chip8Quirks.h"
+
+/**
+* A machine with a program loaded, for benchmarking the CPU one step at a time.
+* There is no beeper, and the timers follow emulated time so nothing depends on the clock.
+*/
+struct BenchMachine
+{
+	Chip8Memory ram;
+	Chip8Display display;
+	Chip8Keyboard keyboard;
+	Chip8CPU cpu;
+
+	explicit BenchMachine(const std::vector<u8>& program, u32 quirks = CHIP8_QUIRKS_DEFAULT) :
+	cpu(ram, display, keyboard, nullptr, false, quirks)
+	{
+		ram.WriteBlock(CHIP8_PROGRAM_START, program.data(), static_cast<u16>(program.size()));
+		cpu.SetRealTimeTimers(false);
+		cpu.SeedRandom(0);
+	}
+};
+
+
+/**
+* A video backend that converts the display to 32-bit pixels in memory, as a frontend uploading it to a texture would.
+*/
+class BenchFrameBufferVideo : public Chip8VideoBackend
+{
+public:
+	void Clear() override { std::fill(frameBuffer_.begin(), frameBuffer_.end(), 0xFF000000); }
+
+	void DrawDisplay(const Chip8Display& display) override
+	{
+		display.CopyPixels(pixels_);
+		frameBuffer_.resize(display.GetSize());
+		for (u16 i = 0; i < display.GetSize(); ++i)
+		{
+			frameBuffer_[i] = (pixels_[i] != 0 ? 0xFFFFFFFF : 0xFF000000);
+		}
+	}
+
+	const u32* GetFrameBuffer() const { return frameBuffer_.data(); }
+
+private:
+	u8 pixels_[CHIP8_DISPLAY_MAX_WIDTH * CHIP8_DISPLAY_MAX_HEIGHT];
+	std::vector<u32> frameBuffer_;
+};
+
+
+/**
+* Discards std::cout and std::cerr for as long as it lives, as loading a program reports its progress.
+*/
+class BenchQuietOutput
+{
+public:
+	BenchQuietOutput() : coutBuffer_(std::cout.rdbuf(nullptr)), cerrBuffer_(std::cerr.rdbuf(nullptr)) {}
+	~BenchQuietOutput()
+	{
+		std::cout.rdbuf(coutBuffer_);
+		std::cerr.rdbuf(cerrBuffer_);
+		std::cout.clear();
+		std::cerr.clear();
+	}
+
+private:
+	std::streambuf* coutBuffer_;
+	std::streambuf* cerrBuffer_;
+};
+
+
+/**
+* Steps a machine through a program, reporting each step as an item.
+*/
+static void RunSteps(benchmark::State& state, BenchMachine& machine)
+{
+	for (auto _ : state)
+	{
+		if (!machine.cpu.Step())
+		{
+			state.SkipWithError("The CPU failed to execute the program.");
+			break;
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+
+/* Chip8CPU::ExecuteOpcode, by opcode class - each runs 64 copies of the opcode in a loop. */
+
+static void BM_Opcode(benchmark::State& state, std::vector<u8> program)
+{
+	BenchMachine machine(program);
+	RunSteps(state, machine);
+}
+
+BENCHMARK_CAPTURE(BM_Opcode, jp_self, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x1200, 0));
+BENCHMARK_CAPTURE(BM_Opcode, call_ret, Chip8BenchPrograms::MakeCallLoop());
+BENCHMARK_CAPTURE(BM_Opcode, se_vx_byte, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x3AFF));
+BENCHMARK_CAPTURE(BM_Opcode, ld_vx_byte, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x6A12));
+BENCHMARK_CAPTURE(BM_Opcode, add_vx_byte, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x7A01));
+BENCHMARK_CAPTURE(BM_Opcode, or_vx_vy, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x8AB1));
+BENCHMARK_CAPTURE(BM_Opcode, add_vx_vy, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x8AB4));
+BENCHMARK_CAPTURE(BM_Opcode, sub_vx_vy, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x8AB5));
+BENCHMARK_CAPTURE(BM_Opcode, shr_vx, Chip8BenchPrograms::MakeOpcodeLoop({}, 0x8AB6));
+BENCHMARK_CAPTURE(BM_Opcode, ld_i_addr, Chip8BenchPrograms::MakeOpcodeLoop({}, 0xA300));
+BENCHMARK_CAPTURE(BM_Opcode, rnd, Chip8BenchPrograms::MakeOpcodeLoop({}, 0xCAFF));
+BENCHMARK_CAPTURE(BM_Opcode, skp, Chip8BenchPrograms::MakeOpcodeLoop({}, 0xEA9E));
+BENCHMARK_CAPTURE(BM_Opcode, ld_dt_vx, Chip8BenchPrograms::MakeOpcodeLoop({}, 0xFA15));
+BENCHMARK_CAPTURE(BM_Opcode, add_i_vx, Chip8BenchPrograms::MakeOpcodeLoop({ 0x6A00 }, 0xFA1E));
+BENCHMARK_CAPTURE(BM_Opcode, ld_b_vx, Chip8BenchPrograms::MakeOpcodeLoop({ 0xA300, 0x6AFF }, 0xFA33));
+BENCHMARK_CAPTURE(BM_Opcode, ld_iaddr_vf, Chip8BenchPrograms::MakeOpcodeLoop({ 0xA300 }, 0xFF55));
+BENCHMARK_CAPTURE(BM_Opcode, ld_vf_iaddr, Chip8BenchPrograms::MakeOpcodeLoop({ 0xA300 }, 0xFF65));
+
+
+/* Chip8CPU::ExecuteOpDRW - state.range(0) is the sprite height. */
+
+static void BM_DrawInside(benchmark::State& state)
+{
+	BenchMachine machine(Chip8BenchPrograms::MakeDrawLoop(8, 8, static_cast<u8>(state.range(0))));
+	RunSteps(state, machine);
+}
+
+static void BM_DrawWrapped(benchmark::State& state)
+{
+	// Crosses both the right and the bottom edge.
+	BenchMachine machine(Chip8BenchPrograms::MakeDrawLoop(CHIP8_DISPLAY_WIDTH - 4, CHIP8_DISPLAY_HEIGHT - 2, static_cast<u8>(state.range(0))));
+	RunSteps(state, machine);
+}
+
+static void BM_DrawClipped(benchmark::State& state)
+{
+	// The SCHIP profile clips sprites - the clip flag on its own matches no profile and runs the CPU variant
+	// that checks its quirks at run time.
+	BenchMachine machine(Chip8BenchPrograms::MakeDrawLoop(CHIP8_DISPLAY_WIDTH - 4, CHIP8_DISPLAY_HEIGHT - 2, static_cast<u8>(state.range(0))),
+		CHIP8_QUIRKS_SCHIP);
+	RunSteps(state, machine);
+}
+
+BENCHMARK(BM_DrawInside)->Arg(1)->Arg(5)->Arg(15);
+BENCHMARK(BM_DrawWrapped)->Arg(1)->Arg(5)->Arg(15);
+BENCHMARK(BM_DrawClipped)->Arg(1)->Arg(5)->Arg(15);
+
+
+/* Chip8Display - state.range(0) and state.range(1) are the display width and height. */
+
+static void BM_DisplayClear(benchmark::State& state)
+{
+	Chip8Display display;
+	display.Reset(static_cast<u8>(state.range(0)), static_cast<u8>(state.range(1)));
+	for (auto _ : state)
+	{
+		display.Clear();
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * display.GetSize());
+}
+
+static void BM_DisplayRender(benchmark::State& state)
+{
+	BenchFrameBufferVideo video;
+
+	// Light every other pixel, so half of them are drawn.
+	Chip8Display display;
+	display.Reset(static_cast<u8>(state.range(0)), static_cast<u8>(state.range(1)));
+	for (u16 y = 0; y < display.GetHeight(); ++y)
+	{
+		for (u16 x = (y & 1); x < display.GetWidth(); x += 2)
+		{
+			display.Plot(x, y);
+		}
+	}
+
+	for (auto _ : state)
+	{
+		video.DrawDisplay(display);
+		benchmark::DoNotOptimize(video.GetFrameBuffer());
+	}
+
+	state.SetItemsProcessed(state.iterations() * display.GetSize());
+}
+
+BENCHMARK(BM_DisplayClear)->Args({ CHIP8_DISPLAY_WIDTH, CHIP8_DISPLAY_HEIGHT })->Args({ 64, 64 });
+BENCHMARK(BM_DisplayRender)->Args({ CHIP8_DISPLAY_WIDTH, CHIP8_DISPLAY_HEIGHT })->Args({ 64, 64 });
+
+
+/* Chip8Memory - state.range(0) is the size of each block. */
+
+static void BM_MemoryReadValue(benchmark::State& state)
+{
+	Chip8Memory ram;
+	u16 address = 0;
+	u8 val;
+	for (auto _ : state)
+	{
+		ram.ReadValue(address, &val);
+		benchmark::DoNotOptimize(val);
+		address = (address + 1) & (CHIP8_MEMORY_SIZE - 1);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MemoryWriteValue(benchmark::State& state)
+{
+	Chip8Memory ram;
+	u16 address = 0;
+	for (auto _ : state)
+	{
+		ram.WriteValue(address, static_cast<u8>(address));
+		address = (address + 1) & (CHIP8_MEMORY_SIZE - 1);
+	}
+
+	benchmark::DoNotOptimize(ram.ReadValueUnchecked(0));
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_MemoryReadBlock(benchmark::State& state)
+{
+	Chip8Memory ram;
+	std::vector<u8> block(static_cast<size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		ram.ReadBlock(0, block.data(), static_cast<u16>(block.size()));
+		benchmark::DoNotOptimize(block.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_MemoryWriteBlock(benchmark::State& state)
+{
+	Chip8Memory ram;
+	const std::vector<u8> block(static_cast<size_t>(state.range(0)), 0xAA);
+	for (auto _ : state)
+	{
+		ram.WriteBlock(0, block.data(), static_cast<u16>(block.size()));
+		benchmark::ClobberMemory();
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_MemoryReadValue);
+BENCHMARK(BM_MemoryWriteValue);
+BENCHMARK(BM_MemoryReadBlock)->Arg(16)->Arg(CHIP8_MEMORY_SIZE);
+BENCHMARK(BM_MemoryWriteBlock)->Arg(16)->Arg(CHIP8_MEMORY_SIZE);
+
+
+/* Chip8::LoadProgram - state.range(0) is the size of the program. */
+
+static void BM_LoadProgram(benchmark::State& state)
+{
+	const std::vector<u8> program(static_cast<size_t>(state.range(0)), 0x12);
+	BenchFrameBufferVideo video;
+	Chip8 chip8(video, std::make_unique<Chip8AudioRecorder>(false));
+	BenchQuietOutput quiet;
+	for (auto _ : state)
+	{
+		if (!chip8.LoadProgram(program.data(), program.size()))
+		{
+			state.SkipWithError("Failed to load the program.");
+			break;
+		}
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_LoadProgram)->Arg(256)->Arg(CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_START);
+
+
+/* Chip8AudioSynth::Generate - state.range(0) is 1 to play an XO-CHIP pattern instead of the default tone. */
+
+static void BM_BeepGenerate(benchmark::State& state)
+{
+	Chip8AudioSynth synth;
+	if (state.range(0) != 0)
+	{
+		const u8 pattern[16] = { 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC, 0x55, 0xAA, 0x00, 0xFF, 0x0F, 0xF0, 0x33, 0xCC, 0x55, 0xAA };
+		synth.SetPattern(pattern);
+	}
+	synth.SetBeeping(true);
+
+	std::vector<s16> samples(CHIP8_BEEPER_DEFAULT_BUFFER_SAMPLES);
+	for (auto _ : state)
+	{
+		synth.Generate(samples.data(), samples.size());
+		benchmark::DoNotOptimize(samples.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * samples.size());
+}
+
+BENCHMARK(BM_BeepGenerate)->Arg(0)->Arg(1);
+
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Builds the emulator three ways - plain, with LTO, and with LTO and PGO trained on the benchmark workloads -
+# then runs the macro benchmark on each build, so the gain of each step shows in its throughput.
+#
+# Usage: scripts/pgo-build.sh [<build root>] [<extra cmake arguments>...]
+# The builds go to <build root>/plain, <build root>/lto and <build root>/pgo (default: _pgo), and each
+# benchmark's JSON results to <build root>/<build>.json. Set CYCLES to change the instructions per workload.
+
+set -e
+
+sourceDir=$(cd "$(dirname "$0")/.." && pwd)
+buildRoot=${1:-"$sourceDir/_pgo"}
+[ $# -gt 0 ] && shift
+jobs=$(nproc 2>/dev/null || echo 4)
+cycles=${CYCLES:-20000000}
+
+configureAndBuild() {
+	buildDir=$1
+	shift
+	cmake -S "$sourceDir" -B "$buildDir" -DCMAKE_BUILD_TYPE=Release -DSD5CHIP8_BUILD_TOOLS=OFF "$@"
+	cmake --build "$buildDir" -j "$jobs" --target sd5chip8-bench-macro
+}
+
+configureAndBuild "$buildRoot/plain" -DSD5CHIP8_ENABLE_LTO=OFF -DSD5CHIP8_PGO=OFF "$@"
+configureAndBuild "$buildRoot/lto" -DSD5CHIP8_ENABLE_LTO=ON -DSD5CHIP8_PGO=OFF "$@"
+
+# Both PGO stages build in the same directory, so the profiles match up with the objects they were taken from.
+configureAndBuild "$buildRoot/pgo" -DSD5CHIP8_ENABLE_LTO=ON -DSD5CHIP8_PGO=GENERATE "$@"
+cmake --build "$buildRoot/pgo" --target pgo-train
+configureAndBuild "$buildRoot/pgo" -DSD5CHIP8_ENABLE_LTO=ON -DSD5CHIP8_PGO=USE "$@"
+
+for build in plain lto pgo; do
+	echo
+	echo "== $build =="
+	"$buildRoot/$build/sd5chip8-bench-macro" --cycles "$cycles" -o "$buildRoot/$build.json"
+done
\ No newline at end of file
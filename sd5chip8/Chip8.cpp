@@ -1,16 +1,20 @@
 #include "Chip8.h"
 
-#include <fstream>
+#include <iomanip>
 #include <iostream>
-#include <thread>
+#include <sstream>
 
-#include "Chip8Helper.h"
+#include "Chip8Disassembler.h"
+#include "Chip8RomCache.h"
 
 
-Chip8::Chip8(sf::RenderTarget& target, const sf::Font* defaultSystemFont) :
-target_(target),
-defaultFont_(defaultSystemFont),
-isInDebugMode_(false)
+Chip8::Chip8(Chip8VideoBackend& video, std::unique_ptr<Chip8AudioBackend> audio, Chip8InputBackend* input) :
+video_(video),
+input_(input),
+beeper_(std::move(audio)),
+isInDebugMode_(false),
+isIdle_(false),
+needsRedraw_(false)
 {
 }
 
@@ -20,85 +24,255 @@ Chip8::~Chip8()
 }
 
 
-bool Chip8::LoadProgram(const std::string& fileName, bool isETI660Program)
+bool Chip8::LoadProgram(const std::string& fileName, bool isETI660Program, u32 quirks)
 {
-	std::cout << "Loading program \"" << fileName << "\", (" << (isETI660Program ? "ETI 660" : "Normal") << ")..." << std::endl;
+	std::cout << "Loading program \"" << fileName << "\", (" << (isETI660Program ? "ETI 660" : "Normal") << ", quirks: 0x" << std::hex << quirks << std::dec << ")..." << std::endl;
 	cpu_.reset();
 
-	auto file = std::ifstream(fileName, std::ios_base::binary);
-	if (!file.is_open())
+	// Map the file and get its image from the cache - a program that's been loaded before isn't copied again,
+	// and one too large for the platform's memory isn't copied at all.
+	const size_t maxSize = (isETI660Program ? CHIP8_MEMORY_ETI660_SIZE - CHIP8_PROGRAM_ETI660_START : CHIP8_ROM_MAX_SIZE);
+	Chip8RomLoadResult loadResult;
+	const auto image = Chip8RomCache::GetShared().Load(fileName, maxSize, &loadResult);
+	if (image == nullptr)
 	{
-		// Failed to open file.
-		std::cerr << "Failed to load program - could not open file." << std::endl;
+		std::cerr << "Failed to load program - " << Chip8RomCache::GetResultText(loadResult) << "." << std::endl;
 		return false;
 	}
 
-	// Init RAM.
-	ram_ = std::make_unique<Chip8Memory>((isETI660Program ? CHIP8_MEMORY_ETI660_SIZE : CHIP8_MEMORY_SIZE));
+	return LoadProgram(image->data.data(), image->data.size(), isETI660Program, quirks);
+}
+
+
+bool Chip8::LoadProgram(const u8* data, size_t size, bool isETI660Program, u32 quirks)
+{
+	cpu_.reset();
 
-	u16 size = 0;
-	u16 i = (isETI660Program ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START); // ETI660 programs start at 0x600, not 0x200.
-	while (file.good())
+	// Init RAM, reusing the existing RAM if it's the right size.
+	const u16 memSize = (isETI660Program ? CHIP8_MEMORY_ETI660_SIZE : CHIP8_MEMORY_SIZE);
+	if (ram_ == nullptr || ram_->GetAllocatedSize() != memSize)
 	{
-		if (!ram_->WriteValue(i, file.get()))
-		{
-			// Failed to write to memory - program maybe too big?
-			std::cerr << "Failed to load program - failed to copy program into memory, is the file too large?" << std::endl;
-			return false;
-		}
-		++i;
-		++size;
+		ram_ = std::make_unique<Chip8Memory>(memSize);
+	}
+	else
+	{
+		ram_->Reset();
 	}
 
-	if (!file.eof())
+	// Copy the program into memory in one go - it must fit between the program start and the end of RAM, as masked RAM would
+	// otherwise wrap the tail of it around over the interpreter area.
+	const u16 programStart = (isETI660Program ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START); // ETI660 programs start at 0x600, not 0x200.
+	if (size > static_cast<size_t>(memSize - programStart) || !ram_->WriteBlock(programStart, data, static_cast<u16>(size)))
 	{
-		// An IO error occurred.
-		std::cerr << "Failed to load program - IO error while reading file." << std::endl;
+		// Failed to write to memory - program maybe too big?
+		std::cerr << "Failed to load program - failed to copy program into memory, is the file too large?" << std::endl;
 		return false;
 	}
 
 	// Init CPU so that it is ready for the program.
 	std::cout << "Program load successful! (Size: " << size << "B)" << std::endl;
-	cpu_ = std::make_unique<Chip8CPU>(*ram_.get(), display_, &beeper_, isETI660Program);
+	cpu_ = std::make_unique<Chip8CPU>(*ram_.get(), display_, keyboard_, &beeper_, isETI660Program, quirks);
+	cpu_->SetDebugger(&debugger_);
 	return true;
 }
 
 
-bool Chip8::RunFrame()
+bool Chip8::LoadProgram(const Chip8RomPack& pack, const std::string& nameOrHash)
+{
+	std::cout << "Loading program \"" << nameOrHash << "\" from pack..." << std::endl;
+	cpu_.reset();
+
+	// The entry points straight into the mapped pack, so there's nothing to read from disk.
+	Chip8RomPackEntry entry;
+	if (!pack.Find(nameOrHash, &entry))
+	{
+		std::cerr << "Failed to load program - no program with that name or hash in the pack." << std::endl;
+		return false;
+	}
+
+	// Quirks of 0 in a pack mean the defaults for the program's platform.
+	const auto quirks = (entry.quirks != 0 ? entry.quirks : Chip8QuirksHelper::GetPlatformQuirks(entry.platform));
+	std::cout << "Found \"" << std::string(entry.name, entry.nameLength) << "\" (" << Chip8PlatformHelper::GetName(entry.platform)
+		<< ", quirks: 0x" << std::hex << quirks << std::dec << ")." << std::endl;
+	WarnIfUnsupportedPlatform(entry.platform);
+	if (!LoadProgram(entry.data, entry.size, Chip8PlatformHelper::IsETI660(entry.platform), quirks))
+	{
+		return false;
+	}
+
+	cpu_->SetStepsPerFrame(Chip8PlatformHelper::GetStepsPerFrame(entry.platform));
+	return true;
+}
+
+
+bool Chip8::LoadProgramAutoDetect(const std::string& fileName)
+{
+	std::cout << "Loading program \"" << fileName << "\", (detecting platform)..." << std::endl;
+	cpu_.reset();
+
+	// The platform isn't known until the program is analyzed, so it's only held to the largest any platform loads.
+	Chip8RomLoadResult loadResult;
+	const auto image = Chip8RomCache::GetShared().Load(fileName, CHIP8_ROM_MAX_SIZE, &loadResult);
+	if (image == nullptr)
+	{
+		std::cerr << "Failed to load program - " << Chip8RomCache::GetResultText(loadResult) << "." << std::endl;
+		return false;
+	}
+
+	return LoadProgram(image->data.data(), image->data.size(), Chip8RomAnalyzer::Analyze(image->data.data(), image->data.size()));
+}
+
+
+bool Chip8::LoadProgram(const u8* data, size_t size, const Chip8RomAnalysis& analysis)
+{
+	std::cout << "Platform: " << Chip8PlatformHelper::GetName(analysis.platform) << " (quirks: 0x" << std::hex << analysis.quirks << std::dec
+		<< ", steps per frame: " << analysis.stepsPerFrame << ")." << std::endl;
+
+	WarnIfUnsupportedPlatform(analysis.platform);
+	if (!LoadProgram(data, size, Chip8PlatformHelper::IsETI660(analysis.platform), analysis.quirks))
+	{
+		return false;
+	}
+
+	cpu_->SetStepsPerFrame(analysis.stepsPerFrame);
+	return true;
+}
+
+
+bool Chip8::SetStepsPerFrame(u32 steps)
 {
-	const auto nextSleepTime = std::chrono::high_resolution_clock::time_point(
-		Chip8Helper::GetNowDuration() + std::chrono::microseconds(CHIP8_FRAME_SLEEP_MICROSECONDS));
+	if (cpu_ == nullptr)
+	{
+		// CPU not active - no loaded program.
+		return false;
+	}
 
+	cpu_->SetStepsPerFrame(steps);
+	return true;
+}
+
+
+void Chip8::WarnIfUnsupportedPlatform(Chip8Platform platform) const
+{
+	if (platform == Chip8Platform::SChip || platform == Chip8Platform::XOChip)
+	{
+		std::cerr << "Warning: Extended instructions for this platform are not supported - running it as a Chip-8 program." << std::endl;
+	}
+}
+
+
+bool Chip8::RunFrame()
+{
 	if (cpu_ == nullptr)
 	{
 		// CPU not active - no loaded program.
-		target_.clear(sf::Color(0, 0, 0));
+		video_.Clear();
 		return true;
 	}
 
+	// Carry out any commands from an attached GDB client between frames.
+	if (gdbServer_ != nullptr)
+	{
+		gdbServer_->Poll(*cpu_, *ram_);
+	}
+
+	// Latch this frame's key state for the CPU.
+	if (input_ != nullptr)
+	{
+		input_->PollInput(keyboard_);
+	}
+	keyboard_.Update();
+
+	// If the program is blocked on LD Vx, K and no key is down, stepping and rendering would only
+	// produce the same frame again - go idle instead until a key event (or a redraw request) arrives.
+	// The CPU still has to run while the debugger has something to stop it for.
+	if (cpu_->IsWaitingForInput() && keyboard_.GetKeyState() == 0 && !debugger_.IsActive())
+	{
+		if (!needsRedraw_)
+		{
+			if (!isIdle_)
+			{
+				// Don't count the time spent idle as a stalled frame.
+				framePacer_.Resync();
+			}
+
+			isIdle_ = true;
+			return true;
+		}
+
+		isIdle_ = false;
+		needsRedraw_ = false;
+		Render();
+		return true;
+	}
+
+	isIdle_ = false;
+	needsRedraw_ = false;
+
 	// Run one CPU frame.
+	const auto wasPaused = debugger_.IsPaused();
 	const auto cpuFrameResult = cpu_->RunFrame();
 
-	// Render the display.
-	display_.Render(target_);
-
-	// Check if debug mode is on and that we have a valid font.
-	if (isInDebugMode_ && defaultFont_ != nullptr)
+	// Show where execution broke.
+	if (!wasPaused && debugger_.IsPaused())
 	{
-		cpu_->RenderCPUDebug(target_, *defaultFont_);
+		std::cout << "Debugger: " << debugger_.GetBreakReason() << std::endl;
+		isInDebugMode_ = true;
 	}
 
+	Render();
+
 	// If execution error, return false.
 	if (!cpuFrameResult)
 	{
 		return false;
 	}
 
-	std::this_thread::sleep_until(nextSleepTime);
+	// Wait until the next frame is due.
+	framePacer_.WaitForNextFrame();
 	return true;
 }
 
 
+void Chip8::Render()
+{
+	// Render the display.
+	video_.DrawDisplay(display_);
+
+	// Check if debug mode is on.
+	if (isInDebugMode_)
+	{
+		video_.DrawDebugText(Chip8DebugPanel::CPU, cpu_->GetDebugText());
+		video_.DrawDebugText(Chip8DebugPanel::Debugger, GetDebuggerText());
+		video_.DrawDebugText(Chip8DebugPanel::FrameStats, GetFrameStatsText());
+	}
+}
+
+
+void Chip8::RequestRedraw()
+{
+	needsRedraw_ = true;
+}
+
+
+bool Chip8::IsIdle() const
+{
+	return isIdle_;
+}
+
+
+bool Chip8::WaitForInput(std::chrono::milliseconds timeout)
+{
+	return keyboard_.WaitForQueuedEvent(timeout);
+}
+
+
+Chip8Keyboard& Chip8::GetKeyboard()
+{
+	return keyboard_;
+}
+
+
 bool Chip8::SoftReset()
 {
 	std::cout << "Performing soft reset..." << std::endl;
@@ -111,6 +285,8 @@ bool Chip8::SoftReset()
 	}
 
 	cpu_->Reset();
+	framePacer_.Reset();
+	isIdle_ = false;
 	return true;
 }
 
@@ -118,10 +294,130 @@ bool Chip8::SoftReset()
 void Chip8::SetDebugMode(bool val)
 {
 	isInDebugMode_ = val;
+	needsRedraw_ = true;
 }
 
 
 bool Chip8::IsInDebugMode() const
 {
 	return isInDebugMode_;
+}
+
+
+bool Chip8::WriteFrameStats(const std::string& statsFileName, const std::string& samplesFileName) const
+{
+	if (!framePacer_.WriteStatsCSV(statsFileName) || !framePacer_.WriteSamplesCSV(samplesFileName))
+	{
+		std::cerr << "Failed to write frame stats to \"" << statsFileName << "\" and \"" << samplesFileName << "\"." << std::endl;
+		return false;
+	}
+
+	std::cout << "Wrote frame stats to \"" << statsFileName << "\" and \"" << samplesFileName << "\"." << std::endl;
+	return true;
+}
+
+
+Chip8Debugger& Chip8::GetDebugger()
+{
+	return debugger_;
+}
+
+
+bool Chip8::ToggleBreakpointAtPC()
+{
+	if (cpu_ == nullptr)
+	{
+		std::cerr << "Cannot set a breakpoint - no CPU active!" << std::endl;
+		return false;
+	}
+
+	const auto pc = cpu_->GetRegisters().PC;
+	const auto isSet = debugger_.ToggleBreakpoint(pc);
+	std::cout << (isSet ? "Set" : "Removed") << " breakpoint at 0x" << std::hex << pc << std::dec << "." << std::endl;
+
+	needsRedraw_ = true;
+	return true;
+}
+
+
+bool Chip8::StartGdbServer(u16 port)
+{
+	if (gdbServer_ == nullptr)
+	{
+		gdbServer_ = std::make_unique<Chip8GdbServer>();
+	}
+	else if (gdbServer_->IsRunning())
+	{
+		return true;
+	}
+
+	return gdbServer_->Start(port);
+}
+
+
+const Chip8FramePacer& Chip8::GetFramePacer() const
+{
+	return framePacer_;
+}
+
+
+std::string Chip8::GetFrameStatsText() const
+{
+	const auto stats = framePacer_.GetStats();
+
+	std::ostringstream oss;
+	oss.setf(std::ios_base::fixed);
+	oss.precision(0);
+	oss << "Frame (us) min: " << stats.minFrameTime << ", avg: " << stats.avgFrameTime << ", p99: " << stats.p99FrameTime << std::endl
+		<< "Overshoot (us) min: " << stats.minOvershoot << ", avg: " << stats.avgOvershoot << ", p99: " << stats.p99Overshoot << std::endl
+		<< "Audio underruns: " << beeper_.GetUnderrunCount();
+	return oss.str();
+}
+
+
+std::string Chip8::GetDebuggerText() const
+{
+	const auto& reg = cpu_->GetRegisters();
+
+	std::ostringstream oss;
+	oss << std::hex << std::setfill('0');
+	oss << (debugger_.IsPaused() ? "PAUSED - " + debugger_.GetBreakReason() : "Running") << std::endl
+		<< "Stack:";
+	for (u8 i = 1; i <= reg.SP && i < 16; ++i)
+	{
+		oss << " 0x" << std::setw(3) << reg.stack[i];
+	}
+	oss << std::endl << std::endl;
+
+	// Disassembly around PC, marking breakpoints with * and PC with >.
+	const u32 memSize = ram_->GetAllocatedSize();
+	const u16 disasmStart = (reg.PC >= 8 ? reg.PC - 8 : 0);
+	for (u16 addr = disasmStart; addr < disasmStart + 20 && addr + 1u < memSize; addr += 2)
+	{
+		const u16 op = (ram_->ReadValueUnchecked(addr) << 8) | ram_->ReadValueUnchecked(addr + 1);
+		oss << (debugger_.HasBreakpoint(addr) ? '*' : ' ') << (addr == reg.PC ? '>' : ' ')
+			<< " 0x" << std::setw(3) << addr << "  " << std::setw(4) << op << "  " << Chip8Disassembler::FormatInstruction(op) << std::endl;
+	}
+	oss << std::endl;
+
+	// Memory at I, with -- for bytes past the end of RAM.
+	for (u32 row = 0; row < 4; ++row)
+	{
+		const u32 rowAddr = reg.I + row * 8;
+		oss << "0x" << std::setw(3) << rowAddr << ":";
+		for (u32 addr = rowAddr; addr < rowAddr + 8; ++addr)
+		{
+			if (addr < memSize)
+			{
+				oss << ' ' << std::setw(2) << +ram_->ReadValueUnchecked(static_cast<u16>(addr));
+			}
+			else
+			{
+				oss << " --";
+			}
+		}
+		oss << std::endl;
+	}
+
+	return oss.str();
 }
\ No newline at end of file
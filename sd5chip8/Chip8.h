@@ -4,31 +4,71 @@
 #include <memory>
 #include <chrono>
 
-#include <SFML\Graphics\RenderTarget.hpp>
-#include <SFML\Graphics\Font.hpp>
-
 #include "Chip8Constants.h"
 #include "Chip8CPU.h"
+#include "Chip8AudioBackend.h"
 #include "Chip8Beeper.h"
+#include "Chip8Debugger.h"
+#include "Chip8GdbServer.h"
+#include "Chip8InputBackend.h"
+#include "Chip8Keyboard.h"
+#include "Chip8FramePacer.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomPack.h"
+#include "Chip8VideoBackend.h"
 
 /**
 * The main chip8 class.
+* It reaches the outside world only through its video, audio and input backends, which the frontend implements.
 */
 class Chip8
 {
 public:
 	/**
-	* Create a new instance of the emulator hooked to a RenderTarget target.
-	* A font can be specified which will be used by the emulator for debug info .etc (optional - pass null if not needed)
+	* Create a new instance of the emulator drawing to a video backend and beeping through an audio backend.
+	* An input backend can be specified which is polled for key presses every frame (optional - pass null if
+	* keys are only queued on the keyboard)
 	*/
-	Chip8(sf::RenderTarget& target, const sf::Font* defaultSystemFont = nullptr);
+	Chip8(Chip8VideoBackend& video, std::unique_ptr<Chip8AudioBackend> audio, Chip8InputBackend* input = nullptr);
 	~Chip8();
 
 	/**
-	* Loads a Chip-8 program into memory.
+	* Loads a Chip-8 program into memory, to be run with the specified quirk flags (CHIP8_QUIRK_*).
+	* Returns true on success, false on failure.
+	*/
+	bool LoadProgram(const std::string& fileName, bool isETI660Program = false, u32 quirks = CHIP8_QUIRKS_DEFAULT);
+
+	/**
+	* Loads a Chip-8 program from memory, to be run with the specified quirk flags (CHIP8_QUIRK_*).
+	* Returns true on success, false on failure.
+	*/
+	bool LoadProgram(const u8* data, size_t size, bool isETI660Program = false, u32 quirks = CHIP8_QUIRKS_DEFAULT);
+
+	/**
+	* Loads a Chip-8 program into memory, analysing it to pick the platform, quirks and steps per frame to run it with.
+	* Returns true on success, false on failure.
+	*/
+	bool LoadProgramAutoDetect(const std::string& fileName);
+
+	/**
+	* Loads a Chip-8 program from memory for the platform, quirks and steps per frame picked by an analysis of it
+	* (from Chip8RomAnalyzer::Analyze()), so the analysis can be done ahead of time or on another thread.
+	* Returns true on success, false on failure.
+	*/
+	bool LoadProgram(const u8* data, size_t size, const Chip8RomAnalysis& analysis);
+
+	/**
+	* Loads a Chip-8 program from an open program pack, found by its name or its content hash.
+	* The program is loaded for the platform and with the quirks recorded for it in the pack.
 	* Returns true on success, false on failure.
 	*/
-	bool LoadProgram(const std::string& fileName, bool isETI660Program = false);
+	bool LoadProgram(const Chip8RomPack& pack, const std::string& nameOrHash);
+
+	/**
+	* Sets the amount of instructions the loaded program runs per frame, overriding the platform's default.
+	* Returns true on success, false if no program is loaded.
+	*/
+	bool SetStepsPerFrame(u32 steps);
 
 	/**
 	* Runs the loaded program for one frame.
@@ -37,6 +77,29 @@ public:
 	*/
 	bool RunFrame();
 
+	/**
+	* Makes the next frame draw to the video backend even if the program is idle, as when its contents were lost.
+	*/
+	void RequestRedraw();
+
+	/**
+	* Returns whether or not the last call to RunFrame went idle because the program is blocked waiting for a key.
+	* Nothing was stepped or drawn, so the frame shouldn't be displayed.
+	*/
+	bool IsIdle() const;
+
+	/**
+	* Sleeps while idle until a key event is queued from another thread or the timeout elapses.
+	* Window events should be polled again after this returns.
+	* Returns true if a key event was queued, false if the wait timed out.
+	*/
+	bool WaitForInput(std::chrono::milliseconds timeout);
+
+	/**
+	* Gets the Chip-8 keyboard. Key events can be queued on it from one other thread.
+	*/
+	Chip8Keyboard& GetKeyboard();
+
 	/**
 	* Performs a soft reset.
 	* Returns true on success, false on failure.
@@ -53,15 +116,69 @@ public:
 	*/
 	bool IsInDebugMode() const;
 
+	/**
+	* Gets the debugger attached to the CPU.
+	* Debug mode is turned on when it pauses execution.
+	*/
+	Chip8Debugger& GetDebugger();
+
+	/**
+	* Sets or removes a breakpoint on the instruction at PC.
+	* Returns true on success, false if no program is loaded.
+	*/
+	bool ToggleBreakpointAtPC();
+
+	/**
+	* Starts a GDB server on a local TCP port, for a debugger front-end to attach to.
+	* Returns true on success, false on failure.
+	*/
+	bool StartGdbServer(u16 port = CHIP8_GDB_DEFAULT_PORT);
+
+	/**
+	* Writes the frame timing stats and the individual frame samples to CSV files.
+	* Returns true on success, false on failure.
+	*/
+	bool WriteFrameStats(const std::string& statsFileName, const std::string& samplesFileName) const;
+
+	/**
+	* Gets the frame pacer used to time frames.
+	*/
+	const Chip8FramePacer& GetFramePacer() const;
+
 private:
-	const sf::Font* defaultFont_;
-	sf::RenderTarget& target_;
+	Chip8VideoBackend& video_;
+	Chip8InputBackend* input_;
 
 	std::unique_ptr<Chip8CPU> cpu_;
 	std::unique_ptr<Chip8Memory> ram_;
 	Chip8Display display_;
+	Chip8Keyboard keyboard_;
 	Chip8Beeper beeper_;
+	Chip8FramePacer framePacer_;
+	Chip8Debugger debugger_;
+	std::unique_ptr<Chip8GdbServer> gdbServer_;
 
 	bool isInDebugMode_;
-};
+	bool isIdle_;
+	bool needsRedraw_;
 
+	/**
+	* Warns that a program for a platform will only run with the Chip-8 instruction set, if it needs more.
+	*/
+	void WarnIfUnsupportedPlatform(Chip8Platform platform) const;
+
+	/**
+	* Draws the display and any debug info to the video backend.
+	*/
+	void Render();
+
+	/**
+	* Gets the debugger state, the disassembly around PC and the memory at I as text.
+	*/
+	std::string GetDebuggerText() const;
+
+	/**
+	* Gets the frame timing stats as text.
+	*/
+	std::string GetFrameStatsText() const;
+};
\ No newline at end of file
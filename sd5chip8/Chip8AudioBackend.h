@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+/**
+* POD struct that describes a change to the beep state, passed from the beeper to its audio backend.
+*/
+struct Chip8AudioEvent
+{
+	enum Type : u8
+	{
+		Reset,
+		Beeping,	// value is 1 to start beeping, 0 to stop
+		Pitch,		// value is the new pitch
+		Pattern		// pattern is the new 16-byte pattern
+	};
+
+	Type type;
+	u8 value;
+	u8 pattern[16];
+};
+
+
+/**
+* Interface for the destination of the Chip-8 beep, such as the audio device or a recording.
+*/
+class Chip8AudioBackend
+{
+public:
+	virtual ~Chip8AudioBackend() {}
+
+	/**
+	* Passes on a beep state change. Must only be called from one thread.
+	* Returns true on success, false if the change had to be dropped.
+	*/
+	virtual bool PushEvent(const Chip8AudioEvent& event) = 0;
+
+	/**
+	* Called each time the CPU timers tick (every 60th of a second of emulated time).
+	* Backends that produce audio from emulated time rather than real time render the tick's worth of samples here.
+	*/
+	virtual void OnTimerTick() {}
+
+	/**
+	* Gets the amount of times the backend ran out of samples to play.
+	*/
+	virtual unsigned long GetUnderrunCount() const { return 0; }
+};
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "Chip8AudioRecorder.h"
+
+#include "Chip8Helper.h"
+
+#include <fstream>
+
+
+Chip8AudioRecorder::Chip8AudioRecorder(bool keepSamples, unsigned int sampleRate, unsigned int amplitude) :
+keepSamples_(keepSamples),
+synth_(sampleRate, amplitude)
+{
+	Clear();
+}
+
+
+Chip8AudioRecorder::~Chip8AudioRecorder()
+{
+}
+
+
+void Chip8AudioRecorder::Clear()
+{
+	samples_.clear();
+	sampleCount_ = 0;
+	tickRemainder_ = 0;
+	hash_ = Chip8Helper::HashFNV1a(nullptr, 0);
+}
+
+
+bool Chip8AudioRecorder::PushEvent(const Chip8AudioEvent& event)
+{
+	// Same thread as the emulator, so changes can be applied straight away.
+	switch (event.type)
+	{
+	case Chip8AudioEvent::Reset:
+		synth_.Reset();
+		break;
+
+	case Chip8AudioEvent::Beeping:
+		synth_.SetBeeping(event.value != 0);
+		break;
+
+	case Chip8AudioEvent::Pitch:
+		synth_.SetPitch(event.value);
+		break;
+
+	case Chip8AudioEvent::Pattern:
+		synth_.SetPattern(event.pattern);
+		break;
+	}
+
+	return true;
+}
+
+
+void Chip8AudioRecorder::OnTimerTick()
+{
+	// Work out how many samples this tick lasts for, carrying the remainder so no time is lost between ticks.
+	const auto tickSamples = (synth_.GetSampleRate() + tickRemainder_) / CHIP8_CPU_TIMER_RATE;
+	tickRemainder_ = (synth_.GetSampleRate() + tickRemainder_) % CHIP8_CPU_TIMER_RATE;
+
+	sampleCount_ += tickSamples;
+
+	// Most programs are silent most of the time, and many never beep at all - skip synthesizing silence.
+	if (synth_.IsSilent())
+	{
+		hash_ = Chip8Helper::HashFNV1aZeros(tickSamples * sizeof(s16), hash_);
+		if (keepSamples_)
+		{
+			samples_.resize(samples_.size() + tickSamples, 0);
+		}
+
+		return;
+	}
+
+	// Only allocated once there is something to hear.
+	if (tickBuf_.empty())
+	{
+		tickBuf_.resize(synth_.GetSampleRate() / CHIP8_CPU_TIMER_RATE + 1);
+	}
+
+	synth_.Generate(tickBuf_.data(), tickSamples);
+	hash_ = Chip8Helper::HashFNV1a(tickBuf_.data(), tickSamples * sizeof(s16), hash_);
+
+	if (keepSamples_)
+	{
+		samples_.insert(samples_.end(), tickBuf_.begin(), tickBuf_.begin() + tickSamples);
+	}
+}
+
+
+const std::vector<s16>& Chip8AudioRecorder::GetSamples() const
+{
+	return samples_;
+}
+
+
+unsigned long long Chip8AudioRecorder::GetSampleCount() const
+{
+	return sampleCount_;
+}
+
+
+u64 Chip8AudioRecorder::GetHash() const
+{
+	return hash_;
+}
+
+
+bool Chip8AudioRecorder::WriteWAV(const std::string& fileName) const
+{
+	auto file = std::ofstream(fileName, std::ios_base::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Writes a little-endian value of the specified size in bytes.
+	const auto writeLE = [&file](u32 val, int size)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			file.put(static_cast<char>((val >> (i * 8)) & 0xFF));
+		}
+	};
+
+	const u32 dataSize = static_cast<u32>(samples_.size() * sizeof(s16));
+	const u32 sampleRate = synth_.GetSampleRate();
+
+	// RIFF header.
+	file.write("RIFF", 4);
+	writeLE(36 + dataSize, 4);
+	file.write("WAVE", 4);
+
+	// Format chunk - 16-bit mono PCM.
+	file.write("fmt ", 4);
+	writeLE(16, 4);					// Chunk size
+	writeLE(1, 2);					// PCM
+	writeLE(1, 2);					// Channels
+	writeLE(sampleRate, 4);			// Sample rate
+	writeLE(sampleRate * 2, 4);		// Byte rate
+	writeLE(2, 2);					// Block align
+	writeLE(16, 2);					// Bits per sample
+
+	// Data chunk.
+	file.write("data", 4);
+	writeLE(dataSize, 4);
+	for (const auto sample : samples_)
+	{
+		writeLE(static_cast<u16>(sample), 2);
+	}
+
+	return file.good();
+}
+
+
+unsigned int Chip8AudioRecorder::GetSampleRate() const
+{
+	return synth_.GetSampleRate();
+}
\ No newline at end of file
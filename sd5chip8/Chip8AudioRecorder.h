@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Chip8Types.h"
+#include "Chip8Constants.h"
+#include "Chip8AudioBackend.h"
+#include "Chip8AudioSynth.h"
+
+#include <string>
+#include <vector>
+
+/**
+* An audio backend that never opens an audio device.
+* Renders the beep from emulated time (one timer tick's worth of samples per tick) so the output only depends on
+* the program being run. Keeps a running hash of the output and can optionally keep the samples to be saved as a WAV.
+*/
+class Chip8AudioRecorder : public Chip8AudioBackend
+{
+public:
+	/**
+	* Creates a recorder. If keepSamples is false, only the hash of the output is kept.
+	*/
+	Chip8AudioRecorder(
+		bool keepSamples = true,
+		unsigned int sampleRate = CHIP8_BEEPER_DEFAULT_SAMPLE_RATE,
+		unsigned int amplitude = CHIP8_BEEPER_DEFAULT_AMPLITUDE
+		);
+	~Chip8AudioRecorder();
+
+	bool PushEvent(const Chip8AudioEvent& event) override;
+	void OnTimerTick() override;
+
+	/**
+	* Discards everything recorded so far and resets the hash.
+	*/
+	void Clear();
+
+	/**
+	* Gets the recorded samples. Empty if the recorder isn't keeping samples.
+	*/
+	const std::vector<s16>& GetSamples() const;
+
+	/**
+	* Gets the total amount of samples rendered, whether kept or not.
+	*/
+	unsigned long long GetSampleCount() const;
+
+	/**
+	* Gets the 64-bit FNV-1a hash of all samples rendered so far.
+	*/
+	u64 GetHash() const;
+
+	/**
+	* Writes the recorded samples to a 16-bit mono PCM WAV file.
+	* Returns true on success, false on failure.
+	*/
+	bool WriteWAV(const std::string& fileName) const;
+
+	/**
+	* Gets the sample rate of the recording.
+	*/
+	unsigned int GetSampleRate() const;
+
+private:
+	const bool keepSamples_;
+
+	Chip8AudioSynth synth_;
+	std::vector<s16> samples_;
+	std::vector<s16> tickBuf_;
+	unsigned long long sampleCount_;
+	unsigned int tickRemainder_; // Carries the fractional samples per tick over to the next tick
+	u64 hash_;
+};
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "Chip8AudioSynth.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+Chip8AudioSynth::Chip8AudioSynth(unsigned int sampleRate, unsigned int amplitude) :
+sampleRate_(sampleRate),
+amplitude_(std::min(amplitude, 32767u)) // Keep within the range of a 16-bit sample.
+{
+	// Fade in and out over about 2 ms.
+	gainStep_ = 1.0f / std::max(1.0f, sampleRate_ * 0.002f);
+	Reset();
+}
+
+
+Chip8AudioSynth::~Chip8AudioSynth()
+{
+}
+
+
+void Chip8AudioSynth::Reset()
+{
+	isBeeping_ = false;
+	hasPattern_ = false;
+	std::fill(pattern_, pattern_ + 16, 0);
+	pitch_ = CHIP8_BEEPER_DEFAULT_PITCH;
+	phase_ = 0.0;
+	gain_ = 0.0f;
+	UpdatePhaseStep();
+}
+
+
+void Chip8AudioSynth::SetBeeping(bool val)
+{
+	isBeeping_ = val;
+}
+
+
+void Chip8AudioSynth::SetPitch(u8 pitch)
+{
+	pitch_ = pitch;
+	UpdatePhaseStep();
+}
+
+
+void Chip8AudioSynth::SetPattern(const u8* pattern)
+{
+	std::copy(pattern, pattern + 16, pattern_);
+	if (!hasPattern_)
+	{
+		// Start from the beginning of the pattern rather than somewhere in the tone's period.
+		hasPattern_ = true;
+		phase_ = 0.0;
+		UpdatePhaseStep();
+	}
+}
+
+
+void Chip8AudioSynth::UpdatePhaseStep()
+{
+	if (hasPattern_)
+	{
+		// XO-CHIP pattern playback rate in bits per second.
+		const auto bitRate = 4000.0 * std::pow(2.0, (pitch_ - 64) / 48.0);
+		phaseStep_ = bitRate / sampleRate_;
+	}
+	else
+	{
+		phaseStep_ = static_cast<double>(CHIP8_BEEPER_DEFAULT_FREQUENCY) / sampleRate_;
+	}
+}
+
+
+void Chip8AudioSynth::Generate(s16* out, size_t count)
+{
+	const auto phaseEnd = (hasPattern_ ? 128.0 : 1.0);
+	const auto targetGain = (isBeeping_ ? 1.0f : 0.0f);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		// Move the envelope towards the target level.
+		if (gain_ < targetGain)
+		{
+			gain_ = std::min(targetGain, gain_ + gainStep_);
+		}
+		else if (gain_ > targetGain)
+		{
+			gain_ = std::max(targetGain, gain_ - gainStep_);
+		}
+
+		if (gain_ <= 0.0f)
+		{
+			// Silent - no need to run the oscillator.
+			out[i] = 0;
+			continue;
+		}
+
+		bool isHigh;
+		if (hasPattern_)
+		{
+			const auto bit = static_cast<unsigned int>(phase_);
+			isHigh = ((pattern_[bit >> 3] & (128 >> (bit & 7))) != 0);
+		}
+		else
+		{
+			isHigh = (phase_ < 0.5);
+		}
+
+		out[i] = static_cast<s16>((isHigh ? 1.0f : -1.0f) * gain_ * amplitude_);
+
+		phase_ += phaseStep_;
+		if (phase_ >= phaseEnd)
+		{
+			phase_ -= phaseEnd;
+		}
+	}
+}
+
+
+bool Chip8AudioSynth::GetBeeping() const
+{
+	return isBeeping_;
+}
+
+
+u8 Chip8AudioSynth::GetPitch() const
+{
+	return pitch_;
+}
+
+
+unsigned int Chip8AudioSynth::GetSampleRate() const
+{
+	return sampleRate_;
+}
+
+
+unsigned int Chip8AudioSynth::GetAmplitude() const
+{
+	return amplitude_;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Chip8Types.h"
+#include "Chip8Constants.h"
+
+#include <cstddef>
+
+/**
+* Synthesizes the Chip-8 beep.
+* Plays a square wave tone by default, or an XO-CHIP 1-bit audio pattern at the current pitch once one is set.
+* Has no dependency on any audio device, so the same synthesis can be streamed or recorded.
+*/
+class Chip8AudioSynth
+{
+public:
+	Chip8AudioSynth(
+		unsigned int sampleRate = CHIP8_BEEPER_DEFAULT_SAMPLE_RATE,
+		unsigned int amplitude = CHIP8_BEEPER_DEFAULT_AMPLITUDE
+		);
+	~Chip8AudioSynth();
+
+	/**
+	* Stops beeping and goes back to the default tone and pitch.
+	*/
+	void Reset();
+
+	/**
+	* Turns beeping on or off. The output fades in and out over a few samples to avoid clicks.
+	*/
+	void SetBeeping(bool val);
+
+	/**
+	* Sets the XO-CHIP pitch, which controls the pattern playback rate: 4000 * 2 ^ ((pitch - 64) / 48) bits per second.
+	*/
+	void SetPitch(u8 pitch);
+
+	/**
+	* Sets the XO-CHIP 16-byte (128-bit) audio pattern. Each bit is played as a high or low sample level, MSB first.
+	*/
+	void SetPattern(const u8* pattern);
+
+	/**
+	* Writes the next count samples to out.
+	*/
+	void Generate(s16* out, size_t count);
+
+	/**
+	* Returns whether or not the synth is beeping.
+	*/
+	bool GetBeeping() const;
+
+	/**
+	* Returns whether or not the synth is silent - not beeping and fully faded out.
+	* Until that changes, Generate() only writes zeros and doesn't advance the tone or pattern.
+	*/
+	inline bool IsSilent() const { return (!isBeeping_ && gain_ <= 0.0f); }
+
+	/**
+	* Gets the XO-CHIP pitch.
+	*/
+	u8 GetPitch() const;
+
+	/**
+	* Gets the sample rate of the synth.
+	*/
+	unsigned int GetSampleRate() const;
+
+	/**
+	* Gets the amplitude of the synth.
+	*/
+	unsigned int GetAmplitude() const;
+
+private:
+	const unsigned int sampleRate_, amplitude_;
+
+	bool isBeeping_;
+	bool hasPattern_;
+	u8 pattern_[16];
+	u8 pitch_;
+
+	double phase_;		// Position within the tone period [0, 1) or within the pattern bits [0, 128)
+	double phaseStep_;	// How far the phase advances per sample
+	float gain_;		// Current envelope level [0, 1]
+	float gainStep_;	// How far the envelope moves per sample
+
+	/**
+	* Recalculates the phase step from the pitch and whether or not a pattern is playing.
+	*/
+	void UpdatePhaseStep();
+};
\ No newline at end of file
@@ -1,14 +1,21 @@
 #include "Chip8Beeper.h"
 
+#include <algorithm>
+#include <iostream>
 
-Chip8Beeper::Chip8Beeper(unsigned int samples, unsigned int sampleRate, unsigned int amplitude) :
-isBeeping_(false),
-samples_(samples),
-sampleRate_(sampleRate),
-amplitude_(amplitude)
+
+Chip8Beeper::Chip8Beeper(std::unique_ptr<Chip8AudioBackend> backend) :
+ownedBackend_(std::move(backend)),
+backend_(ownedBackend_.get()),
+isBeeping_(false)
+{
+}
+
+
+Chip8Beeper::Chip8Beeper(Chip8AudioBackend& backend) :
+backend_(&backend),
+isBeeping_(false)
 {
-	beep_.setLoop(true);
-	InitializeBeep();
 }
 
 
@@ -17,24 +24,23 @@ Chip8Beeper::~Chip8Beeper()
 }
 
 
-bool Chip8Beeper::InitializeBeep()
+void Chip8Beeper::PushEvent(const Chip8AudioEvent& event)
 {
-	// Construct the sine wave data to use for beeping.
-	auto soundData = std::unique_ptr<sf::Int16[]>(new sf::Int16[samples_]);
-	for (size_t i = 0; i < samples_; ++i)
+	if (!backend_->PushEvent(event))
 	{
-		soundData[i] = static_cast<sf::Int16>(amplitude_ * sinf((i * 0.01f) * 6.28f));
+		// The backend isn't keeping up.
+		std::cerr << "Audio event queue full - dropping beep state change!" << std::endl;
 	}
+}
 
-	// Store data in sound buffer.
-	if (!beepBuf_.loadFromSamples(soundData.get(), samples_, 1, sampleRate_))
-	{
-		// Failed to load sound!
-		return false;
-	}
 
-	beep_.setBuffer(beepBuf_);
-	return true;
+void Chip8Beeper::Reset()
+{
+	isBeeping_ = false;
+
+	Chip8AudioEvent event = {};
+	event.type = Chip8AudioEvent::Reset;
+	PushEvent(event);
 }
 
 
@@ -46,7 +52,11 @@ void Chip8Beeper::SetBeeping(bool val)
 	}
 
 	isBeeping_ = val;
-	(isBeeping_ ? beep_.play() : beep_.stop());
+
+	Chip8AudioEvent event = {};
+	event.type = Chip8AudioEvent::Beeping;
+	event.value = (isBeeping_ ? 1 : 0);
+	PushEvent(event);
 }
 
 
@@ -56,19 +66,37 @@ bool Chip8Beeper::GetBeeping() const
 }
 
 
-unsigned int Chip8Beeper::GetSampleAmount() const
+void Chip8Beeper::SetPitch(u8 pitch)
+{
+	Chip8AudioEvent event = {};
+	event.type = Chip8AudioEvent::Pitch;
+	event.value = pitch;
+	PushEvent(event);
+}
+
+
+void Chip8Beeper::SetPattern(const u8* pattern)
+{
+	Chip8AudioEvent event = {};
+	event.type = Chip8AudioEvent::Pattern;
+	std::copy(pattern, pattern + 16, event.pattern);
+	PushEvent(event);
+}
+
+
+void Chip8Beeper::OnTimerTick()
 {
-	return samples_;
+	backend_->OnTimerTick();
 }
 
 
-unsigned int Chip8Beeper::GetSampleRate() const
+unsigned long Chip8Beeper::GetUnderrunCount() const
 {
-	return sampleRate_;
+	return backend_->GetUnderrunCount();
 }
 
 
-unsigned int Chip8Beeper::GetAmplitude() const
+Chip8AudioBackend& Chip8Beeper::GetBackend()
 {
-	return amplitude_;
+	return *backend_;
 }
\ No newline at end of file
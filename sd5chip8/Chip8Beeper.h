@@ -2,25 +2,32 @@
 
 #include "Chip8Types.h"
 #include "Chip8Constants.h"
+#include "Chip8AudioBackend.h"
 
 #include <memory>
 
-#include <SFML\Audio\SoundBuffer.hpp>
-#include <SFML\Audio\Sound.hpp>
-
 /**
 * Handles the emulation of Chip-8 sounds.
 */
 class Chip8Beeper
 {
 public:
-	Chip8Beeper(
-		unsigned int samples = CHIP8_BEEPER_DEFAULT_SAMPLES, 
-		unsigned int sampleRate = CHIP8_BEEPER_DEFAULT_SAMPLE_RATE, 
-		unsigned int amplitude = CHIP8_BEEPER_DEFAULT_AMPLITUDE
-		);
+	/**
+	* Creates a beeper that sends the beep to a backend, such as the frontend's audio stream or a Chip8AudioRecorder.
+	*/
+	explicit Chip8Beeper(std::unique_ptr<Chip8AudioBackend> backend);
+
+	/**
+	* Creates a beeper that sends the beep to a backend owned by the caller, which must outlive the beeper.
+	*/
+	explicit Chip8Beeper(Chip8AudioBackend& backend);
 	~Chip8Beeper();
 
+	/**
+	* Stops beeping and goes back to the default tone and pitch.
+	*/
+	void Reset();
+
 	/**
 	* Turns beeping on or off.
 	*/
@@ -32,30 +39,37 @@ public:
 	bool GetBeeping() const;
 
 	/**
-	* Gets the amount of samples used in the beep.
+	* Sets the XO-CHIP pattern playback pitch.
 	*/
-	unsigned int GetSampleAmount() const;
+	void SetPitch(u8 pitch);
 
 	/**
-	* Gets the sample rate of the beep.
+	* Sets the XO-CHIP 16-byte audio pattern. Once set, the pattern is played instead of the default tone.
 	*/
-	unsigned int GetSampleRate() const;
+	void SetPattern(const u8* pattern);
 
 	/**
-	* Gets the amplitude of the beep.
+	* Advances the beep by one timer tick of emulated time. Called by the CPU whenever its timers tick.
 	*/
-	unsigned int GetAmplitude() const;
+	void OnTimerTick();
 
-private:
-	const unsigned int samples_, sampleRate_, amplitude_;
+	/**
+	* Gets the amount of times the audio backend has run out of samples to play.
+	*/
+	unsigned long GetUnderrunCount() const;
+
+	/**
+	* Gets the audio backend the beep is sent to.
+	*/
+	Chip8AudioBackend& GetBackend();
 
-	sf::SoundBuffer beepBuf_;
-	sf::Sound beep_;
+private:
+	std::unique_ptr<Chip8AudioBackend> ownedBackend_;
+	Chip8AudioBackend* backend_;
 	bool isBeeping_;
 
 	/**
-	* Initializes the beep sound.
+	* Passes a beep state change on to the backend.
 	*/
-	bool InitializeBeep();
-};
-
+	void PushEvent(const Chip8AudioEvent& event);
+};
\ No newline at end of file
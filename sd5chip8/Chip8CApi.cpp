@@ -0,0 +1,406 @@
+#include "Chip8CApi.h"
+
+#include "Chip8AudioBackend.h"
+#include "Chip8Beeper.h"
+#include "Chip8Constants.h"
+#include "Chip8CPU.h"
+#include "Chip8Display.h"
+#include "Chip8KeyState.h"
+#include "Chip8Memory.h"
+#include "Chip8Quirks.h"
+#include "Chip8Random.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <type_traits>
+
+
+namespace
+{
+	/**
+	* Keeps track of what the beeper is playing, for the host to read back.
+	*/
+	class CApiAudioBackend : public Chip8AudioBackend
+	{
+	public:
+		CApiAudioBackend()
+		{
+			Reset();
+		}
+
+		bool PushEvent(const Chip8AudioEvent& event) override
+		{
+			switch (event.type)
+			{
+			case Chip8AudioEvent::Reset:
+				Reset();
+				break;
+
+			case Chip8AudioEvent::Beeping:
+				state.is_beeping = (event.value != 0 ? 1 : 0);
+				break;
+
+			case Chip8AudioEvent::Pitch:
+				state.pitch = event.value;
+				break;
+
+			case Chip8AudioEvent::Pattern:
+				std::copy(event.pattern, event.pattern + 16, state.pattern);
+				state.has_pattern = 1;
+				break;
+			}
+
+			return true;
+		}
+
+		chip8_audio_state state;
+
+	private:
+		void Reset()
+		{
+			std::memset(&state, 0, sizeof(state));
+			state.pitch = CHIP8_BEEPER_DEFAULT_PITCH;
+		}
+	};
+
+
+	/**
+	* A snapshot - the machine state, plus what the C interface tracks on top of it.
+	* It holds no pointers, so it is saved and restored with a plain copy.
+	*/
+	struct CApiSnapshot
+	{
+		u32 magic;
+		u32 stepsIntoFrame;
+		chip8_audio_state audio;
+		Chip8MachineState machine;
+	};
+
+	static_assert(std::is_trivially_copyable<CApiSnapshot>::value, "Snapshots must be copyable as bytes.");
+
+	const u32 snapshotMagic = 0x32533843; // "C8S2"
+}
+
+
+/**
+* An emulator instance, with its RAM stored inline so that the whole machine lives in the caller's memory.
+* Keys come in as a mask, so it latches them itself rather than carrying a Chip8Keyboard and its event queue.
+*/
+struct chip8_instance
+{
+#ifndef CHIP8_MEMORY_INLINE_MASKED
+	u8 memory[CHIP8_MEMORY_SIZE];
+#endif
+
+	Chip8Memory ram;
+	Chip8Display display;
+	Chip8KeyState keys;
+	CApiAudioBackend audio;
+	Chip8Beeper beeper;
+	Chip8CPU cpu;
+
+	// The CPU's messages about ignored instructions and errors would otherwise go to the host's std::cout and
+	// std::cerr - the host learns of errors from the return values instead.
+	std::ostream log;
+
+	u32 stepsIntoFrame;
+	u16 heldKeys;		// Keys set by chip8_set_keys()
+	u16 pressedKeys;	// Keys that went down since the last frame started
+	bool isLoaded;
+
+	explicit chip8_instance(const chip8_config& config) :
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+	ram(config.is_eti660 ? CHIP8_MEMORY_ETI660_SIZE : CHIP8_MEMORY_SIZE), // The RAM is inline already
+#else
+	ram(memory, (config.is_eti660 ? CHIP8_MEMORY_ETI660_SIZE : CHIP8_MEMORY_SIZE)),
+#endif
+	beeper(audio),
+	cpu(ram, display, keys, &beeper, (config.is_eti660 != 0), config.quirks),
+	log(nullptr),
+	stepsIntoFrame(0),
+	heldKeys(0),
+	pressedKeys(0),
+	isLoaded(false)
+	{
+		cpu.SetLogStream(&log);
+		cpu.SetStepsPerFrame(config.steps_per_frame);
+		cpu.SetRealTimeTimers(false);
+		cpu.SetRandomEngine(static_cast<Chip8RandomEngine>(config.rng_engine));
+		cpu.SeedRandom(config.rng_seed);
+		cpu.Reset();
+	}
+};
+
+
+namespace
+{
+	/**
+	* Runs instructions, taking whole frames in one go where it can and ticking the timers at each frame's end.
+	*/
+	bool RunCycles(chip8_instance* instance, u64 cycles)
+	{
+		if (!instance->isLoaded)
+		{
+			return false;
+		}
+
+		const u32 stepsPerFrame = instance->cpu.GetStepsPerFrame();
+		while (cycles > 0)
+		{
+			if (instance->stepsIntoFrame == 0)
+			{
+				// Latch the key state for the frame. A key pressed and released since the last one is still down for it.
+				instance->keys.SetKeyState(instance->heldKeys | instance->pressedKeys);
+				instance->pressedKeys = 0;
+				if (cycles >= stepsPerFrame)
+				{
+					if (!instance->cpu.RunFrame())
+					{
+						return false;
+					}
+
+					cycles -= stepsPerFrame;
+					continue;
+				}
+			}
+
+			if (!instance->cpu.Step())
+			{
+				return false;
+			}
+
+			--cycles;
+			if (++instance->stepsIntoFrame == stepsPerFrame)
+			{
+				instance->cpu.EndFrame();
+				instance->stepsIntoFrame = 0;
+			}
+		}
+
+		return true;
+	}
+
+
+	size_t GetSnapshotSize(const chip8_instance*)
+	{
+		return sizeof(CApiSnapshot);
+	}
+}
+
+
+extern "C"
+{
+	uint32_t chip8_api_version(void)
+	{
+		return CHIP8_CAPI_VERSION;
+	}
+
+
+	void chip8_config_init(chip8_config* config)
+	{
+		config->is_eti660 = 0;
+		config->quirks = CHIP8_QUIRKS_DEFAULT;
+		config->steps_per_frame = CHIP8_CPU_STEPS_PER_FRAME;
+		config->rng_engine = static_cast<uint32_t>(Chip8RandomEngine::PCG);
+		config->rng_seed = 0;
+	}
+
+
+	size_t chip8_instance_size(void)
+	{
+		return sizeof(chip8_instance);
+	}
+
+
+	size_t chip8_instance_alignment(void)
+	{
+		return alignof(chip8_instance);
+	}
+
+
+	chip8_instance* chip8_create(void* memory, size_t size, const chip8_config* config)
+	{
+		chip8_config defaultConfig;
+		if (config == nullptr)
+		{
+			chip8_config_init(&defaultConfig);
+			config = &defaultConfig;
+		}
+
+		if (memory == nullptr || size < sizeof(chip8_instance) || reinterpret_cast<uintptr_t>(memory) % alignof(chip8_instance) != 0 ||
+			(config->quirks & ~CHIP8_QUIRKS_ALL) != 0 || config->steps_per_frame == 0 ||
+			config->rng_engine > static_cast<uint32_t>(Chip8RandomEngine::COSMAC))
+		{
+			return nullptr;
+		}
+
+		return new (memory) chip8_instance(*config);
+	}
+
+
+	void chip8_destroy(chip8_instance* instance)
+	{
+		if (instance != nullptr)
+		{
+			instance->~chip8_instance();
+		}
+	}
+
+
+	int chip8_load_program(chip8_instance* instance, const uint8_t* data, size_t size)
+	{
+		instance->isLoaded = false;
+		instance->ram.Reset();
+
+		const u16 programStart = (instance->cpu.IsETI660Mode() ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START);
+		if (size > static_cast<size_t>(instance->ram.GetAllocatedSize() - programStart) || !instance->ram.WriteBlock(programStart, data, static_cast<u16>(size)))
+		{
+			// Program too big.
+			return 0;
+		}
+
+		instance->cpu.Reset();
+		instance->stepsIntoFrame = 0;
+		instance->isLoaded = true;
+		return 1;
+	}
+
+
+	void chip8_reset(chip8_instance* instance)
+	{
+		instance->cpu.Reset();
+		instance->stepsIntoFrame = 0;
+	}
+
+
+	int chip8_run_frames(chip8_instance* instance, uint32_t frames)
+	{
+		if (frames == 0)
+		{
+			return (instance->isLoaded ? 1 : 0);
+		}
+
+		// A frame that was started by chip8_run_cycles() counts as the first.
+		const u64 stepsPerFrame = instance->cpu.GetStepsPerFrame();
+		return (RunCycles(instance, frames * stepsPerFrame - instance->stepsIntoFrame) ? 1 : 0);
+	}
+
+
+	int chip8_run_cycles(chip8_instance* instance, uint64_t cycles)
+	{
+		return (RunCycles(instance, cycles) ? 1 : 0);
+	}
+
+
+	void chip8_set_keys(chip8_instance* instance, uint16_t keys)
+	{
+		instance->pressedKeys |= (keys & ~instance->heldKeys);
+		instance->heldKeys = keys;
+	}
+
+
+	void chip8_get_display_size(const chip8_instance* instance, uint32_t* out_width, uint32_t* out_height)
+	{
+		*out_width = instance->display.GetWidth();
+		*out_height = instance->display.GetHeight();
+	}
+
+
+	int chip8_read_pixels(const chip8_instance* instance, uint8_t* out_pixels, size_t size)
+	{
+		if (size < instance->display.GetSize())
+		{
+			return 0;
+		}
+
+		instance->display.CopyPixels(out_pixels);
+		return 1;
+	}
+
+
+	int chip8_read_memory(const chip8_instance* instance, uint16_t address, uint8_t* out_data, size_t size)
+	{
+		// Check the range here, as the masked build of the memory wraps addresses instead of failing.
+		const u32 memorySize = instance->ram.GetAllocatedSize();
+		if (size > memorySize || address > memorySize - size)
+		{
+			return 0;
+		}
+
+		return (instance->ram.ReadBlock(address, out_data, static_cast<u16>(size)) ? 1 : 0);
+	}
+
+
+	void chip8_get_registers(const chip8_instance* instance, chip8_registers* out_registers)
+	{
+		const auto& reg = instance->cpu.GetRegisters();
+		out_registers->pc = reg.PC;
+		out_registers->i = reg.I;
+		out_registers->sp = reg.SP;
+		out_registers->dt = reg.DT;
+		out_registers->st = reg.ST;
+		std::copy(reg.V, reg.V + 16, out_registers->v);
+		std::copy(reg.stack, reg.stack + 16, out_registers->stack);
+	}
+
+
+	void chip8_get_audio_state(const chip8_instance* instance, chip8_audio_state* out_state)
+	{
+		*out_state = instance->audio.state;
+	}
+
+
+	size_t chip8_snapshot_size(const chip8_instance* instance)
+	{
+		return GetSnapshotSize(instance);
+	}
+
+
+	int chip8_save_snapshot(const chip8_instance* instance, void* out_buffer, size_t size)
+	{
+		if (size < GetSnapshotSize(instance))
+		{
+			return 0;
+		}
+
+		// The snapshot is put together on the stack, as the caller's buffer may not be aligned for one.
+		// Zeroing the padding and unused RAM too keeps snapshots of the same state byte for byte identical.
+		CApiSnapshot snapshot;
+		std::memset(static_cast<void*>(&snapshot), 0, sizeof(snapshot));
+		snapshot.magic = snapshotMagic;
+		snapshot.stepsIntoFrame = instance->stepsIntoFrame;
+		snapshot.audio = instance->audio.state;
+		instance->cpu.SaveState(&snapshot.machine);
+
+		std::memcpy(out_buffer, &snapshot, sizeof(snapshot));
+		return 1;
+	}
+
+
+	int chip8_restore_snapshot(chip8_instance* instance, const void* buffer, size_t size)
+	{
+		if (size < GetSnapshotSize(instance))
+		{
+			return 0;
+		}
+
+		CApiSnapshot snapshot;
+		std::memcpy(static_cast<void*>(&snapshot), buffer, sizeof(snapshot));
+		if (snapshot.magic != snapshotMagic || snapshot.stepsIntoFrame >= instance->cpu.GetStepsPerFrame() ||
+			(snapshot.audio.is_beeping != 0 && snapshot.audio.is_beeping != 1) ||
+			(snapshot.audio.has_pattern != 0 && snapshot.audio.has_pattern != 1) ||
+			!instance->cpu.RestoreState(snapshot.machine))
+		{
+			return 0;
+		}
+
+		// Bring the beeper in line first, so it doesn't skip the next change of the beep as already made.
+		instance->beeper.SetBeeping(snapshot.audio.is_beeping != 0);
+		instance->audio.state = snapshot.audio;
+		instance->stepsIntoFrame = snapshot.stepsIntoFrame;
+		instance->isLoaded = true;
+		return 1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#pragma once
+
+/**
+* A C interface to the emulator core, for hosting emulators in programs written in other languages.
+*
+* Instances live in memory supplied by the caller, so a host can pack any amount of them into one arena.
+* Only creating an instance does any work beyond emulating - running it, setting its keys, reading its state
+* and taking or restoring snapshots never allocate.
+* An instance must only be used from one thread at a time, but different instances can run on different threads.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+	#if defined(CHIP8_CAPI_BUILD)
+		#define CHIP8_CAPI __declspec(dllexport)
+	#elif defined(CHIP8_CAPI_STATIC)
+		#define CHIP8_CAPI
+	#else
+		#define CHIP8_CAPI __declspec(dllimport)
+	#endif
+#else
+	#define CHIP8_CAPI __attribute__((visibility("default")))
+#endif
+
+/* Bumped whenever the interface changes in a way that breaks existing hosts. */
+#define CHIP8_CAPI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* An emulator instance. Only ever handled through pointers.
+*/
+typedef struct chip8_instance chip8_instance;
+
+/**
+* How an instance is set up. Fill in with chip8_config_init() before changing any fields.
+*/
+typedef struct chip8_config
+{
+	int is_eti660;				/* Non-zero to emulate the ETI 660 (programs start at 0x600, 2 KB RAM) */
+	uint32_t quirks;			/* Quirk flags the CPU emulates (CHIP8_QUIRK_* in Chip8Quirks.h) */
+	uint32_t steps_per_frame;	/* Instructions run per frame */
+	uint32_t rng_engine;		/* Generator used by RND: 0 for PCG, 1 for xorshift, 2 for the COSMAC shift register */
+	uint64_t rng_seed;			/* Seed of the RND generator, so runs are reproducible */
+} chip8_config;
+
+/**
+* The CPU registers.
+*/
+typedef struct chip8_registers
+{
+	uint16_t pc;
+	uint16_t i;
+	uint8_t sp;
+	uint8_t dt;
+	uint8_t st;
+	uint8_t v[16];
+	uint16_t stack[16];
+} chip8_registers;
+
+/**
+* What the beeper is playing. Hosts synthesize the sound from this themselves.
+*/
+typedef struct chip8_audio_state
+{
+	int is_beeping;
+	int has_pattern;		/* Non-zero once an XO-CHIP program loaded a pattern to play instead of the default tone */
+	uint8_t pitch;			/* XO-CHIP pattern playback pitch */
+	uint8_t pattern[16];	/* XO-CHIP 1-bit audio pattern */
+} chip8_audio_state;
+
+/**
+* Gets the version of the interface the library implements (CHIP8_CAPI_VERSION when it was built).
+*/
+CHIP8_CAPI uint32_t chip8_api_version(void);
+
+/**
+* Fills in a config with the defaults: a Chip-8 program, with no quirks, at the default speed, with a seed of 0.
+*/
+CHIP8_CAPI void chip8_config_init(chip8_config* config);
+
+/**
+* Gets the amount of memory an instance needs.
+*/
+CHIP8_CAPI size_t chip8_instance_size(void);
+
+/**
+* Gets the alignment the memory of an instance needs.
+*/
+CHIP8_CAPI size_t chip8_instance_alignment(void);
+
+/**
+* Creates an instance in size bytes of caller-owned memory, which must stay valid until it is destroyed.
+* If config is null, the defaults are used.
+* Returns the instance on success, or null if the memory is too small or misaligned, or the config is invalid.
+*/
+CHIP8_CAPI chip8_instance* chip8_create(void* memory, size_t size, const chip8_config* config);
+
+/**
+* Destroys an instance. Its memory can then be reused or freed by the caller.
+*/
+CHIP8_CAPI void chip8_destroy(chip8_instance* instance);
+
+/**
+* Clears the RAM, loads a program into it from memory and resets the CPU to run it.
+* Returns non-zero on success, or 0 if the program doesn't fit into RAM.
+*/
+CHIP8_CAPI int chip8_load_program(chip8_instance* instance, const uint8_t* data, size_t size);
+
+/**
+* Resets the CPU, keeping the program that is loaded.
+*/
+CHIP8_CAPI void chip8_reset(chip8_instance* instance);
+
+/**
+* Runs whole frames: the steps of each, then one tick of the timers.
+* Returns non-zero on success, or 0 if no program is loaded or the program hit an error.
+*/
+CHIP8_CAPI int chip8_run_frames(chip8_instance* instance, uint32_t frames);
+
+/**
+* Runs a number of instructions. The timers tick every steps per frame instructions, as if whole frames were run,
+* so running n frames' worth of cycles gives the same result as running n frames.
+* Returns non-zero on success, or 0 if no program is loaded or the program hit an error.
+*/
+CHIP8_CAPI int chip8_run_cycles(chip8_instance* instance, uint64_t cycles);
+
+/**
+* Sets which keys are held down as a mask (bit n is set if key n is down). Takes effect from the next frame.
+*/
+CHIP8_CAPI void chip8_set_keys(chip8_instance* instance, uint16_t keys);
+
+/**
+* Gets the size of the display in pixels. It changes when a program switches to or from hires mode.
+*/
+CHIP8_CAPI void chip8_get_display_size(const chip8_instance* instance, uint32_t* out_width, uint32_t* out_height);
+
+/**
+* Copies the display into a buffer of width * height bytes, row by row, with each byte non-zero if its pixel is on.
+* Returns non-zero on success, or 0 if the buffer is too small.
+*/
+CHIP8_CAPI int chip8_read_pixels(const chip8_instance* instance, uint8_t* out_pixels, size_t size);
+
+/**
+* Copies size bytes of RAM starting at an address into a buffer.
+* Returns non-zero on success, or 0 if the range is outside of RAM.
+*/
+CHIP8_CAPI int chip8_read_memory(const chip8_instance* instance, uint16_t address, uint8_t* out_data, size_t size);
+
+/**
+* Gets the CPU registers.
+*/
+CHIP8_CAPI void chip8_get_registers(const chip8_instance* instance, chip8_registers* out_registers);
+
+/**
+* Gets what the beeper is playing.
+*/
+CHIP8_CAPI void chip8_get_audio_state(const chip8_instance* instance, chip8_audio_state* out_state);
+
+/**
+* Gets the size of the buffer a snapshot of the instance is saved to.
+*/
+CHIP8_CAPI size_t chip8_snapshot_size(const chip8_instance* instance);
+
+/**
+* Saves the state of the machine (CPU, RAM, display and beeper) to a buffer of chip8_snapshot_size() bytes.
+* Returns non-zero on success, or 0 if the buffer is too small.
+*/
+CHIP8_CAPI int chip8_save_snapshot(const chip8_instance* instance, void* out_buffer, size_t size);
+
+/**
+* Restores the state of the machine from a snapshot saved from an instance created with the same config.
+* Returns non-zero on success, or 0 if the buffer doesn't hold a snapshot that fits the instance.
+*/
+CHIP8_CAPI int chip8_restore_snapshot(chip8_instance* instance, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -1,22 +1,54 @@
 #include "Chip8CPU.h"
 
 #include "Chip8Beeper.h"
-#include "Chip8Keyboard.h"
+#include "Chip8Coverage.h"
+#include "Chip8Debugger.h"
 #include "Chip8Helper.h"
+#include "Chip8KeyState.h"
+#include "Chip8Opcodes.h"
+#include "Chip8Tracer.h"
 
-#include <cassert>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 
-Chip8CPU::Chip8CPU(Chip8Memory& ram, Chip8Display& display, Chip8Beeper* beeper, bool isETI660) :
+namespace
+{
+	// Template argument for the variant of the CPU that checks the quirk flags at run time.
+	const u32 runtimeQuirks = 0x80000000;
+
+	/**
+	* Returns whether or not a bool holds true or false, for ones copied in as raw bytes.
+	* Reading one that holds anything else is undefined.
+	*/
+	inline bool IsValidBool(const bool& value)
+	{
+		u8 byte;
+		std::memcpy(&byte, &value, sizeof(byte));
+		return byte <= 1;
+	}
+}
+
+
+Chip8CPU::Chip8CPU(Chip8Memory& ram, Chip8Display& display, const Chip8KeyState& keyboard, Chip8Beeper* beeper, bool isETI660, u32 quirks) :
 ram_(ram),
+keyboard_(keyboard),
 beeper_(beeper),
 defaultSpritesAddr_(0),
 display_(display),
 isETI660_(isETI660),
-rndDist_(0, 255)
+isUsingRealTimeTimers_(true),
+stepsPerFrame_(CHIP8_CPU_STEPS_PER_FRAME),
+stepsIntoFrame_(0),
+debugger_(nullptr),
+tracer_(nullptr),
+coverage_(nullptr),
+log_(nullptr),
+rndSeed_(0),
+isRndSeeded_(false)
 {
+	SetQuirks(quirks);
 	Reset();
 }
 
@@ -35,21 +67,26 @@ void Chip8CPU::Reset()
 	InitializeRegisters();
 	lastStepTime_ = now;
 	ResetTimerDecrement();
-	assert(InitializeDefaultSprites());
+	if (!InitializeDefaultSprites())
+	{
+		// Not in an assert - it would be compiled out of release builds, along with the sprites.
+		GetErrorLog() << "Failed to write the default sprites into memory!" << std::endl;
+	}
 
-	// Seed the CPU random number generator with current time.
-	rnd_ = std::mt19937(static_cast<unsigned int>(now.count()));
+	// Seed the CPU random number generator with current time, unless it was given a seed.
+	rnd_.Seed(isRndSeeded_ ? rndSeed_ : static_cast<u64>(now.count()));
 
 	display_.Reset(CHIP8_DISPLAY_WIDTH, CHIP8_DISPLAY_HEIGHT);
 	isInHiresMode_ = false;
 	if (beeper_ != nullptr)
 	{
-		// Make sure the beeper isn't already beeping.
-		beeper_->SetBeeping(false);
+		// Make sure the beeper isn't already beeping and forget any XO-CHIP audio pattern.
+		beeper_->Reset();
 	}
 
 	isWaitingForInput_ = false;
 	lastOp_ = 0;
+	stepsIntoFrame_ = 0;
 }
 
 
@@ -60,8 +97,8 @@ void Chip8CPU::InitializeRegisters()
 
 	// Zero out the registers and stack.
 	reg_.I = reg_.SP = reg_.DT = reg_.ST = 0;
-	reg_.V[16] = {};
-	reg_.stack[16] = {};
+	std::memset(reg_.V, 0, sizeof(reg_.V));
+	std::memset(reg_.stack, 0, sizeof(reg_.stack));
 }
 
 
@@ -90,16 +127,7 @@ bool Chip8CPU::InitializeDefaultSprites(u16 writeAddr)
 	};
 
 	// Write the default font sprite data into reserved memory, size: 80 (5 * 16).
-	for (u16 i = 0; i < 80; ++i)
-	{
-		if (!ram_.WriteValue(i, fontSpriteData[i]))
-		{
-			// Failed to place default sprites into memory.
-			return false;
-		}
-	}
-
-	return true;
+	return ram_.WriteBlock(writeAddr, fontSpriteData, sizeof(fontSpriteData));
 }
 
 
@@ -107,7 +135,7 @@ bool Chip8CPU::ExecuteOpSYS(u16 op)
 {
 	// This opcode is unused on modern interpreters as this opcode was used to call
 	// old system functions on Chip-8 computers (such as RCA emulation mode).
-	std::cout << "Ignoring SYS instruction: 0x" << std::hex << op << " (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
+	GetInfoLog() << "Ignoring SYS instruction: 0x" << std::hex << op << " (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
 	SetPCNext();
 	return true;
 }
@@ -123,10 +151,10 @@ bool Chip8CPU::ExecuteOpCLS()
 
 bool Chip8CPU::ExecuteOpRET()
 {
-	if (reg_.SP > 16)
+	if (reg_.SP == 0 || reg_.SP > 15)
 	{
-		// Invalid SP - cannot decrement SP for RET because < 0 underflow or bad SP.
-		std::cerr << "Invalid SP for RET instruction! (PC: 0x" << std::hex << reg_.PC << ", SP: 0x" << std::hex << +reg_.SP << ")" << std::endl;
+		// Invalid SP - cannot decrement SP for RET because the stack is empty or SP is bad.
+		GetErrorLog() << "Invalid SP for RET instruction! (PC: 0x" << std::hex << reg_.PC << ", SP: 0x" << std::hex << +reg_.SP << ")" << std::endl;
 		return false;
 	}
 
@@ -141,7 +169,7 @@ bool Chip8CPU::ExecuteOpJPAddr(u16 op)
 	// Check if this is a Hires program - these usually start at 0x200 and immediately JP to 0x260.
 	if (reg_.PC == CHIP8_PROGRAM_START && (op & 0x0FFF) == 0x260)
 	{
-		std::cout << "Program is initializing Hi-res mode." << std::endl;
+		GetInfoLog() << "Program is initializing Hi-res mode." << std::endl;
 
 		isInHiresMode_ = true;
 		display_.Reset(CHIP8_HIRES_DISPLAY_WIDTH, CHIP8_HIRES_DISPLAY_HEIGHT);
@@ -157,10 +185,10 @@ bool Chip8CPU::ExecuteOpJPAddr(u16 op)
 
 bool Chip8CPU::ExecuteOpCALL(u16 op)
 {
-	if (reg_.SP > 15)
+	if (reg_.SP >= 15)
 	{
-		// Invalid SP - cannot increment SP for CALL because no room on stack.
-		std::cerr << "Invalid SP for CALL 0x" << std::hex << (op & 0x0FFF) << " instruction! (PC: 0x" << std::hex << reg_.PC << ", SP: 0x" << std::hex << +reg_.SP << ")" << std::endl;
+		// Invalid SP - cannot increment SP for CALL because no room on stack (stack[0] is never used).
+		GetErrorLog() << "Invalid SP for CALL 0x" << std::hex << (op & 0x0FFF) << " instruction! (PC: 0x" << std::hex << reg_.PC << ", SP: 0x" << std::hex << +reg_.SP << ")" << std::endl;
 		return false;
 	}
 
@@ -221,28 +249,46 @@ bool Chip8CPU::ExecuteOpLDVxVy(u16 op)
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpOR(u16 op)
 {
 	// bitwise OR Vx and Vy and store in Vx.
 	reg_.V[GetXArg(op)] |= reg_.V[GetYArg(op)];
+	if (HasQuirk<Quirks>(CHIP8_QUIRK_LOGIC_RESETS_VF))
+	{
+		reg_.V[0xF] = 0;
+	}
+
 	SetPCNext();
 	return true;
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpAND(u16 op)
 {
 	// bitwise AND Vx and Vy and store in Vx.
 	reg_.V[GetXArg(op)] &= reg_.V[GetYArg(op)];
+	if (HasQuirk<Quirks>(CHIP8_QUIRK_LOGIC_RESETS_VF))
+	{
+		reg_.V[0xF] = 0;
+	}
+
 	SetPCNext();
 	return true;
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpXOR(u16 op)
 {
 	// bitwise XOR Vx and Vy and store in Vx.
 	reg_.V[GetXArg(op)] ^= reg_.V[GetYArg(op)];
+	if (HasQuirk<Quirks>(CHIP8_QUIRK_LOGIC_RESETS_VF))
+	{
+		reg_.V[0xF] = 0;
+	}
+
 	SetPCNext();
 	return true;
 }
@@ -286,8 +332,14 @@ bool Chip8CPU::ExecuteOpSUB(u16 op)
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpSHR(u16 op)
 {
+	if (HasQuirk<Quirks>(CHIP8_QUIRK_SHIFT_USES_VY))
+	{
+		reg_.V[GetXArg(op)] = reg_.V[GetYArg(op)];
+	}
+
 	// If value of least-significant bit at Vx is 1, set VF to 1, otherwise 0.
 	// Then perform integer DIV by 2.
 	reg_.V[0xF] = (reg_.V[GetXArg(op)] & 1);
@@ -316,8 +368,14 @@ bool Chip8CPU::ExecuteOpSUBN(u16 op)
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpSHL(u16 op)
 {
+	if (HasQuirk<Quirks>(CHIP8_QUIRK_SHIFT_USES_VY))
+	{
+		reg_.V[GetXArg(op)] = reg_.V[GetYArg(op)];
+	}
+
 	// If value of most-significant bit at Vx is 1, set VF to 1, otherwise 0.
 	// Then perform multiplication by 2.
 	reg_.V[0xF] = (reg_.V[GetXArg(op)] & 128) >> 7;
@@ -344,21 +402,23 @@ bool Chip8CPU::ExecuteOpLDIAddr(u16 op)
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpJPV0Addr(u16 op)
 {
-	reg_.PC = (op & 0x0FFF) + reg_.V[0];
+	reg_.PC = (op & 0x0FFF) + reg_.V[HasQuirk<Quirks>(CHIP8_QUIRK_JUMP_USES_VX) ? GetXArg(op) : 0];
 	return true;
 }
 
 
 bool Chip8CPU::ExecuteOpRND(u16 op)
 {
-	reg_.V[GetXArg(op)] = (static_cast<u8>(rndDist_(rnd_)) & (op & 0x00FF));
+	reg_.V[GetXArg(op)] = (rnd_.NextByte() & (op & 0x00FF));
 	SetPCNext();
 	return true;
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpDRW(u16 op)
 {
 	// NOTE: Each pixel of a sprite is stored as one bit, not a byte.
@@ -367,38 +427,36 @@ bool Chip8CPU::ExecuteOpDRW(u16 op)
 	const auto Vx = reg_.V[GetXArg(op)];
 	const auto Vy = reg_.V[GetYArg(op)];
 
+	// Fetch the whole sprite from memory at once.
+	const u8 spriteLines = (op & 0x000F);
+	u8 sprite[15];
+	if (!ram_.ReadBlock(reg_.I, sprite, spriteLines))
+	{
+		// Failure reading sprite from memory
+		GetErrorLog() << "Could not read sprite for DRW V[0x" << std::hex << +GetXArg(op) << "], V[0x" << std::hex << +GetYArg(op) << "], " << +spriteLines
+			<< " instruction! (PC: 0x" << std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ", Vx: " << +Vx << ", Vy: " << +Vy << ")" << std::endl;
+		return false;
+	}
+
 	// Assume no pixels have been toggled off AKA no collision...
 	reg_.V[0xF] = 0;
 
-	const u8 spriteLines = (op & 0x000F);	
-	for (u8 y = 0; y < spriteLines; ++y)
+	// When clipping, the sprite's position still wraps, but the parts of it that go off screen aren't drawn.
+	const auto isClipping = HasQuirk<Quirks>(CHIP8_QUIRK_CLIP_SPRITES);
+	const u8 startX = (isClipping ? Vx % display_.GetWidth() : Vx);
+	const u8 startY = (isClipping ? Vy % display_.GetHeight() : Vy);
+	const u8 drawWidth = (isClipping && startX + 8 > display_.GetWidth() ? display_.GetWidth() - startX : 8);
+	const u8 drawHeight = (isClipping && startY + spriteLines > display_.GetHeight() ? display_.GetHeight() - startY : spriteLines);
+
+	// Mask off the columns that are clipped, so nothing wraps around to the other side.
+	const u8 lineMask = static_cast<u8>(0xFF00 >> drawWidth);
+	for (u8 y = 0; y < drawHeight; ++y)
 	{
-		u8 pixLine;
-		if (!ram_.ReadValue(reg_.I + y, &pixLine))
+		// Every sprite is 8 px in width - a whole line is drawn at once.
+		if (display_.DrawSpriteLine(startX, startY + y, sprite[y] & lineMask))
 		{
-			// Failure reading sprite from memory
-			std::cerr << "Could not read sprite for DRW V[0x" << std::hex << +GetXArg(op) << "], V[0x" << std::hex << +GetYArg(op) << "], " << +spriteLines
-				<< " instruction! (PC: 0x" << std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ", Vx: " << +Vx << ", Vy: " << +Vy << ")" << std::endl;
-			return false;
-		}
-
-		// Every sprite is 8 px in width.
-		for (u8 x = 0; x < 8; ++x)
-		{
-			// Check that this pixel in the sprite isn't in an "off" state.
-			if ((pixLine & (128 >> x)) == 0)
-			{
-				continue;
-			}
-
-			if (display_.GetPixelState(Vx + x, Vy + y) != 0)
-			{
-				// Pixel is already "on" - collision.
-				reg_.V[0xF] = 1;
-			}
-
-			// Draw the pixel.
-			display_.Plot(Vx + x, Vy + y);
+			// A pixel that was already "on" got turned off - collision.
+			reg_.V[0xF] = 1;
 		}
 	}
 
@@ -410,7 +468,7 @@ bool Chip8CPU::ExecuteOpDRW(u16 op)
 bool Chip8CPU::ExecuteOpSKP(u16 op)
 {
 	// Skip next instruction if key with code at Vx is down.
-	((Chip8Keyboard::isKeyDown(reg_.V[GetXArg(op)])) ? SetPCSkip() : SetPCNext());
+	((keyboard_.IsKeyDown(reg_.V[GetXArg(op)])) ? SetPCSkip() : SetPCNext());
 	return true;
 }
 
@@ -418,7 +476,7 @@ bool Chip8CPU::ExecuteOpSKP(u16 op)
 bool Chip8CPU::ExecuteOpSKNP(u16 op)
 {
 	// Skip next instruction if key with code at Vx is NOT down (key is up).
-	((!Chip8Keyboard::isKeyDown(reg_.V[GetXArg(op)])) ? SetPCSkip() : SetPCNext());
+	((!keyboard_.IsKeyDown(reg_.V[GetXArg(op)])) ? SetPCSkip() : SetPCNext());
 	return true;
 }
 
@@ -434,7 +492,7 @@ bool Chip8CPU::ExecuteOpLDVxDT(u16 op)
 bool Chip8CPU::ExecuteOpLDVxKey(u16 op)
 {
 	u8 key;
-	if (!Chip8Keyboard::getCurrentPressedKey(&key))
+	if (!keyboard_.GetCurrentPressedKey(&key))
 	{
 		// Wait until key press.
 		isWaitingForInput_ = true;
@@ -483,12 +541,11 @@ bool Chip8CPU::ExecuteOpLDFVx(u16 op)
 bool Chip8CPU::ExecuteOpLDBVx(u16 op)
 {
 	const auto Vx = reg_.V[GetXArg(op)];
-	if (!(ram_.WriteValue(reg_.I, Vx / 100) &&
-		ram_.WriteValue(reg_.I + 1, (Vx % 100) / 10) &&
-		ram_.WriteValue(reg_.I + 2, (Vx % 100) % 10)))
+	const u8 bcd[3] = { static_cast<u8>(Vx / 100), static_cast<u8>((Vx % 100) / 10), static_cast<u8>((Vx % 100) % 10) };
+	if (!ram_.WriteBlock(reg_.I, bcd, 3))
 	{
 		// Failed to write to memory.
-		std::cerr << "Could not write BCD for LD B, V[0x" << std::hex << +GetXArg(op) << "] instruction! (PC: 0x"
+		GetErrorLog() << "Could not write BCD for LD B, V[0x" << std::hex << +GetXArg(op) << "] instruction! (PC: 0x"
 			<< std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ", Vx: " << +Vx << ")" << std::endl;
 		return false;
 	}
@@ -498,161 +555,151 @@ bool Chip8CPU::ExecuteOpLDBVx(u16 op)
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpLDIaddrVx(u16 op)
 {
-	// Loop through V0 through Vx
-	for (u8 i = 0; i <= GetXArg(op); ++i)
+	// Write V0 through Vx to I onwards.
+	if (!ram_.WriteBlock(reg_.I, reg_.V, GetXArg(op) + 1))
 	{
-		// Try to write to I + i.
-		if (!ram_.WriteValue(reg_.I + i, reg_.V[i]))
-		{
-			// Failure writing to memory.
-			std::cerr << "Could not write values of V for LD [I], V[0x" << std::hex << +GetXArg(op) << "] instruction! (PC: 0x"
-				<< std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
-			return false;
-		}
+		// Failure writing to memory.
+		GetErrorLog() << "Could not write values of V for LD [I], V[0x" << std::hex << +GetXArg(op) << "] instruction! (PC: 0x"
+			<< std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
+		return false;
 	}
 
+	IncrementIAfterLoadStore<Quirks>(op);
 	SetPCNext();
 	return true;
 }
 
 
+template <u32 Quirks>
 bool Chip8CPU::ExecuteOpLDVxIaddr(u16 op)
 {
-	// Loop through V0 through Vx
-	for (u8 i = 0; i <= GetXArg(op); ++i)
+	// Read V0 through Vx from I onwards.
+	if (!ram_.ReadBlock(reg_.I, reg_.V, GetXArg(op) + 1))
 	{
-		// Try to read to Vx.
-		if (!ram_.ReadValue(reg_.I + i, &reg_.V[i]))
-		{
-			// Failure reading from memory.
-			std::cerr << "Could not read memory to V for LD V[0x" << std::hex << +GetXArg(op) << "], [I] instruction! (PC: 0x"
-				<< std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
-			return false;
-		}
+		// Failure reading from memory.
+		GetErrorLog() << "Could not read memory to V for LD V[0x" << std::hex << +GetXArg(op) << "], [I] instruction! (PC: 0x"
+			<< std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
+		return false;
 	}
 
+	IncrementIAfterLoadStore<Quirks>(op);
 	SetPCNext();
 	return true;
 }
 
 
-bool Chip8CPU::ExecuteOpcode(u16 op)
+bool Chip8CPU::ExecuteOpAUDIO()
 {
-	//std::cout << "Op 0x" << std::hex << op << " (PC: 0x" << std::hex << reg_.PC << ", SP: 0x" << std::hex << +reg_.SP << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
+	u8 pattern[16];
+	if (!ram_.ReadBlock(reg_.I, pattern, 16))
+	{
+		// Failure reading from memory.
+		GetErrorLog() << "Could not read audio pattern for AUDIO instruction! (PC: 0x"
+			<< std::hex << reg_.PC << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
+		return false;
+	}
 
-	switch (op & 0xF000)
+	if (beeper_ != nullptr)
 	{
-	case 0x0000:
-		switch (op & 0x00FF)
-		{
-		case 0x00E0:
-			return ExecuteOpCLS();
-		case 0x00EE:
-			return ExecuteOpRET();
-		default:
-			return ExecuteOpSYS(op);
-		}
+		beeper_->SetPattern(pattern);
+	}
 
-	case 0x1000:
-		return ExecuteOpJPAddr(op);
-	case 0x2000:
-		return ExecuteOpCALL(op);
-	case 0x3000:
-		return ExecuteOpSEVxByte(op);
-	case 0x4000:
-		return ExecuteOpSNEVxByte(op);
-	case 0x5000:
-		return ExecuteOpSEVxVy(op);
-	case 0x6000:
-		return ExecuteOpLDVxByte(op);
-	case 0x7000:
-		return ExecuteOpADDVxByte(op);
-
-	case 0x8000:
-		switch (op & 0x000F)
-		{
-		case 0x0000:
-			return ExecuteOpLDVxVy(op);
-		case 0x0001:
-			return ExecuteOpOR(op);
-		case 0x0002:
-			return ExecuteOpAND(op);
-		case 0x0003:
-			return ExecuteOpXOR(op);
-		case 0x0004:
-			return ExecuteOpADDVxVy(op);
-		case 0x0005:
-			return ExecuteOpSUB(op);
-		case 0x0006:
-			return ExecuteOpSHR(op);
-		case 0x0007:
-			return ExecuteOpSUBN(op);
-		case 0x000E:
-			return ExecuteOpSHL(op);
-		default:
-			std::cerr << "Unknown opcode in 0x8000 group: 0x" << std::hex << op << "! (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
-			return false;
-		}
+	SetPCNext();
+	return true;
+}
 
-	case 0x9000:
-		return ExecuteOpSNEVxVy(op);
-	case 0xA000:
-		return ExecuteOpLDIAddr(op);
-	case 0xB000:
-		return ExecuteOpJPV0Addr(op);
-	case 0xC000:
-		return ExecuteOpRND(op);
-	case 0xD000:
-		return ExecuteOpDRW(op);
-
-	case 0xE000:
-		switch (op & 0x00FF)
-		{
-		case 0x009E:
-			return ExecuteOpSKP(op);
-		case 0x00A1:
-			return ExecuteOpSKNP(op);
-		default:
-			std::cerr << "Unknown opcode in 0xE000 group: 0x" << std::hex << op << "! (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
-			return false;
-		}
 
-	case 0xF000:
-		switch (op & 0x00FF)
-		{
-		case 0x0007:
-			return ExecuteOpLDVxDT(op);
-		case 0x000A:
-			return ExecuteOpLDVxKey(op);
-		case 0x0015:
-			return ExecuteOpLDDTVx(op);
-		case 0x0018:
-			return ExecuteOpLDSTVx(op);
-		case 0x001E:
-			return ExecuteOpADDIVx(op);
-		case 0x0029:
-			return ExecuteOpLDFVx(op);
-		case 0x0033:
-			return ExecuteOpLDBVx(op);
-		case 0x0055:
-			return ExecuteOpLDIaddrVx(op);
-		case 0x0065:
-			return ExecuteOpLDVxIaddr(op);
-		default:
-			std::cerr << "Unknown opcode in 0xF000 group: 0x" << std::hex << op << "! (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
-			return false;
-		}
+bool Chip8CPU::ExecuteOpPITCH(u16 op)
+{
+	if (beeper_ != nullptr)
+	{
+		beeper_->SetPitch(reg_.V[GetXArg(op)]);
+	}
+
+	SetPCNext();
+	return true;
+}
+
+
+template <u32 Quirks>
+bool Chip8CPU::HasQuirk(u32 quirk) const
+{
+	// Quirks is a compile-time constant, so this folds down to a constant unless quirks are checked at run time.
+	return (((Quirks & runtimeQuirks) != 0 ? quirks_ : Quirks) & quirk) != 0;
+}
+
+
+template <u32 Quirks>
+void Chip8CPU::IncrementIAfterLoadStore(u16 op)
+{
+	if (HasQuirk<Quirks>(CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I))
+	{
+		reg_.I += GetXArg(op) + 1;
+	}
+	else if (HasQuirk<Quirks>(CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I_BY_X))
+	{
+		reg_.I += GetXArg(op);
+	}
+}
+
+
+template <u32 Quirks>
+bool Chip8CPU::ExecuteOpcode(u16 op)
+{
+	//std::cout << "Op 0x" << std::hex << op << " (PC: 0x" << std::hex << reg_.PC << ", SP: 0x" << std::hex << +reg_.SP << ", I: 0x" << std::hex << reg_.I << ")" << std::endl;
+
+	switch (Chip8Opcodes::Decode(op))
+	{
+	case Chip8OpType::SYS: return ExecuteOpSYS(op);
+	case Chip8OpType::CLS: return ExecuteOpCLS();
+	case Chip8OpType::RET: return ExecuteOpRET();
+	case Chip8OpType::JPAddr: return ExecuteOpJPAddr(op);
+	case Chip8OpType::CALL: return ExecuteOpCALL(op);
+	case Chip8OpType::SEVxByte: return ExecuteOpSEVxByte(op);
+	case Chip8OpType::SNEVxByte: return ExecuteOpSNEVxByte(op);
+	case Chip8OpType::SEVxVy: return ExecuteOpSEVxVy(op);
+	case Chip8OpType::LDVxByte: return ExecuteOpLDVxByte(op);
+	case Chip8OpType::ADDVxByte: return ExecuteOpADDVxByte(op);
+	case Chip8OpType::LDVxVy: return ExecuteOpLDVxVy(op);
+	case Chip8OpType::OR: return ExecuteOpOR<Quirks>(op);
+	case Chip8OpType::AND: return ExecuteOpAND<Quirks>(op);
+	case Chip8OpType::XOR: return ExecuteOpXOR<Quirks>(op);
+	case Chip8OpType::ADDVxVy: return ExecuteOpADDVxVy(op);
+	case Chip8OpType::SUB: return ExecuteOpSUB(op);
+	case Chip8OpType::SHR: return ExecuteOpSHR<Quirks>(op);
+	case Chip8OpType::SUBN: return ExecuteOpSUBN(op);
+	case Chip8OpType::SHL: return ExecuteOpSHL<Quirks>(op);
+	case Chip8OpType::SNEVxVy: return ExecuteOpSNEVxVy(op);
+	case Chip8OpType::LDIAddr: return ExecuteOpLDIAddr(op);
+	case Chip8OpType::JPV0Addr: return ExecuteOpJPV0Addr<Quirks>(op);
+	case Chip8OpType::RND: return ExecuteOpRND(op);
+	case Chip8OpType::DRW: return ExecuteOpDRW<Quirks>(op);
+	case Chip8OpType::SKP: return ExecuteOpSKP(op);
+	case Chip8OpType::SKNP: return ExecuteOpSKNP(op);
+	case Chip8OpType::LDVxDT: return ExecuteOpLDVxDT(op);
+	case Chip8OpType::LDVxKey: return ExecuteOpLDVxKey(op);
+	case Chip8OpType::LDDTVx: return ExecuteOpLDDTVx(op);
+	case Chip8OpType::LDSTVx: return ExecuteOpLDSTVx(op);
+	case Chip8OpType::ADDIVx: return ExecuteOpADDIVx(op);
+	case Chip8OpType::LDFVx: return ExecuteOpLDFVx(op);
+	case Chip8OpType::LDBVx: return ExecuteOpLDBVx(op);
+	case Chip8OpType::LDIaddrVx: return ExecuteOpLDIaddrVx<Quirks>(op);
+	case Chip8OpType::LDVxIaddr: return ExecuteOpLDVxIaddr<Quirks>(op);
+	case Chip8OpType::AUDIO: return ExecuteOpAUDIO();
+	case Chip8OpType::PITCH: return ExecuteOpPITCH(op);
 
 	default:
-		std::cerr << "Unknown opcode: 0x" << std::hex << op << "! (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
+		GetErrorLog() << "Unknown opcode: 0x" << std::hex << op << "! (PC: 0x" << std::hex << reg_.PC << ")" << std::endl;
 		return false;
 	}
 }
 
 
-bool Chip8CPU::Step()
+template <u32 Quirks>
+bool Chip8CPU::StepWithQuirks()
 {
 	// Get the next opcode
 	u16 op;
@@ -665,13 +712,13 @@ bool Chip8CPU::Step()
 	lastOp_ = op;
 
 	// Execute opcode
-	if (!ExecuteOpcode(op))
+	if (!ExecuteOpcode<Quirks>(op))
 	{
 		return false;
 	}
 
-	// Only update DT and ST if not waiting for input.
-	if (!isWaitingForInput_)
+	// Only update DT and ST if not waiting for input and they follow real time.
+	if (!isWaitingForInput_ && isUsingRealTimeTimers_)
 	{
 		// Update DT and ST if needed.
 		UpdateTimers();
@@ -681,46 +728,125 @@ bool Chip8CPU::Step()
 }
 
 
-bool Chip8CPU::RunFrame()
+template <u32 Quirks>
+bool Chip8CPU::RunFrameWithQuirks()
 {
-	for (int i = 0; i < CHIP8_CPU_STEPS_PER_FRAME; ++i)
+	for (u32 i = 0; i < stepsPerFrame_; ++i)
 	{
-		if (!Step())
+		if (!StepWithQuirks<Quirks>())
 		{
 			return false;
 		}
 	}
 
+	EndFrame();
 	return true;
 }
 
 
-void Chip8CPU::UpdateTimers()
+bool Chip8CPU::Step()
 {
-	// Get current time.
-	const auto now = Chip8Helper::GetNowDuration();
+	const auto pc = reg_.PC;
+	if (!(this->*step_)())
+	{
+		return false;
+	}
 
-	// If it's time for a timer update...
-	if (nextTimerDecrementCounter_.count() <= 0)
+	if (tracer_ != nullptr)
 	{
-		// Update delay timer if it's active
-		if (reg_.DT > 0)
+		tracer_->Record(pc, lastOp_, reg_);
+	}
+
+	if (coverage_ != nullptr)
+	{
+		coverage_->Record(pc, lastOp_, reg_.PC);
+	}
+
+	return true;
+}
+
+
+void Chip8CPU::EndFrame()
+{
+	// Timers following emulated time tick exactly once per frame.
+	if (!isWaitingForInput_ && !isUsingRealTimeTimers_)
+	{
+		TickTimers();
+	}
+}
+
+
+bool Chip8CPU::RunFrameInstrumented()
+{
+	const auto isDebugging = (debugger_ != nullptr && debugger_->IsActive());
+	for (; stepsIntoFrame_ < stepsPerFrame_; ++stepsIntoFrame_)
+	{
+		const auto pc = reg_.PC;
+		if (isDebugging)
+		{
+			u16 op;
+			if (!FetchOpcode(&op))
+			{
+				return false;
+			}
+
+			// The rest of the frame, timers included, waits for execution to resume - stepsIntoFrame_ keeps
+			// count of the steps already run, so the next call only runs what is left of it.
+			if (debugger_->CheckBeforeStep(reg_, op))
+			{
+				return true;
+			}
+		}
+
+		if (!(this->*step_)())
+		{
+			return false;
+		}
+
+		if (tracer_ != nullptr)
 		{
-			--reg_.DT;
+			tracer_->Record(pc, lastOp_, reg_);
 		}
 
-		// Update the sound timer if it's active and play a continous noise
-		if (reg_.ST > 0)
+		if (coverage_ != nullptr)
 		{
-			--reg_.ST;
+			coverage_->Record(pc, lastOp_, reg_.PC);
 		}
 
-		// Beep if ST > 0.
-		if (beeper_ != nullptr)
+		if (isDebugging)
 		{
-			beeper_->SetBeeping((reg_.ST > 0));
+			debugger_->OnAfterStep(reg_);
 		}
+	}
+
+	stepsIntoFrame_ = 0;
+	EndFrame();
+	return true;
+}
+
+
+bool Chip8CPU::RunFrame()
+{
+	// Checked once per frame, so the normal loop has no debugger, tracer or coverage checks between steps.
+	// A frame the debugger broke into is finished on the instrumented loop too, even if it has since gone.
+	if (tracer_ != nullptr || coverage_ != nullptr || (debugger_ != nullptr && debugger_->IsActive()) || stepsIntoFrame_ != 0)
+	{
+		return RunFrameInstrumented();
+	}
+
+	return (this->*runFrame_)();
+}
+
 
+void Chip8CPU::UpdateTimers()
+{
+	// Get current time.
+	const auto now = Chip8Helper::GetNowDuration();
+
+	// If it's time for a timer update...
+	if (nextTimerDecrementCounter_.count() <= 0)
+	{
+		TickTimers();
 		ResetTimerDecrement();
 	}
 
@@ -729,6 +855,29 @@ void Chip8CPU::UpdateTimers()
 }
 
 
+void Chip8CPU::TickTimers()
+{
+	// Update delay timer if it's active
+	if (reg_.DT > 0)
+	{
+		--reg_.DT;
+	}
+
+	// Update the sound timer if it's active and play a continous noise
+	if (reg_.ST > 0)
+	{
+		--reg_.ST;
+	}
+
+	// Beep if ST > 0.
+	if (beeper_ != nullptr)
+	{
+		beeper_->SetBeeping((reg_.ST > 0));
+		beeper_->OnTimerTick();
+	}
+}
+
+
 void Chip8CPU::ResetTimerDecrement()
 {
 	nextTimerDecrementCounter_ = std::chrono::microseconds(CHIP8_CPU_TIMER_DECREMENT_DELAY_MICROSECONDS);
@@ -738,8 +887,7 @@ void Chip8CPU::ResetTimerDecrement()
 bool Chip8CPU::FetchOpcode(u16* outOp) const
 {
 	u8 opBytes[2];
-	const auto success = (ram_.ReadValue(reg_.PC, &opBytes[0]) && ram_.ReadValue(reg_.PC + 1, &opBytes[1]));
-	if (!success)
+	if (!ram_.ReadBlock(reg_.PC, opBytes, 2))
 	{
 		return false;
 	}
@@ -752,14 +900,50 @@ bool Chip8CPU::FetchOpcode(u16* outOp) const
 }
 
 
-void Chip8CPU::RenderCPUDebug(sf::RenderTarget& target, const sf::Font& font) const
+void Chip8CPU::SetDebugger(Chip8Debugger* debugger)
+{
+	debugger_ = debugger;
+}
+
+
+Chip8Debugger* Chip8CPU::GetDebugger() const
+{
+	return debugger_;
+}
+
+
+void Chip8CPU::SetTracer(Chip8Tracer* tracer)
 {
-	sf::Text debugText;
-	debugText.setPosition(sf::Vector2f(0.0f, 0.0f));
-	debugText.setCharacterSize(14);
-	debugText.setFont(font);
-	debugText.setColor(sf::Color(255, 0, 0));
+	tracer_ = tracer;
+}
+
 
+void Chip8CPU::SetCoverage(Chip8Coverage* coverage)
+{
+	coverage_ = coverage;
+}
+
+
+void Chip8CPU::SetLogStream(std::ostream* stream)
+{
+	log_ = stream;
+}
+
+
+std::ostream& Chip8CPU::GetInfoLog() const
+{
+	return (log_ != nullptr ? *log_ : std::cout);
+}
+
+
+std::ostream& Chip8CPU::GetErrorLog() const
+{
+	return (log_ != nullptr ? *log_ : std::cerr);
+}
+
+
+std::string Chip8CPU::GetDebugText() const
+{
 	std::ostringstream oss;
 	oss << "Op: 0x" << std::hex << lastOp_ << ", PC: 0x" << std::hex << reg_.PC << (isWaitingForInput_ ? " - WAITING FOR INPUT" : "") << std::endl
 		<< "SP: 0x" << std::hex << +reg_.SP << ", I: 0x" << std::hex << reg_.I << std::endl
@@ -774,8 +958,7 @@ void Chip8CPU::RenderCPUDebug(sf::RenderTarget& target, const sf::Font& font) co
 		}
 	}
 
-	debugText.setString(oss.str());
-	target.draw(debugText);
+	return oss.str();
 }
 
 
@@ -797,7 +980,150 @@ bool Chip8CPU::IsWaitingForInput() const
 }
 
 
+void Chip8CPU::SetRealTimeTimers(bool val)
+{
+	isUsingRealTimeTimers_ = val;
+}
+
+
+bool Chip8CPU::IsUsingRealTimeTimers() const
+{
+	return isUsingRealTimeTimers_;
+}
+
+
+void Chip8CPU::SetStepsPerFrame(u32 steps)
+{
+	stepsPerFrame_ = steps;
+}
+
+
+u32 Chip8CPU::GetStepsPerFrame() const
+{
+	return stepsPerFrame_;
+}
+
+
+void Chip8CPU::SetQuirks(u32 quirks)
+{
+	quirks_ = quirks;
+
+	// Use the variant compiled for these quirks if there is one.
+	switch (quirks)
+	{
+	case CHIP8_QUIRKS_DEFAULT:
+		step_ = &Chip8CPU::StepWithQuirks<CHIP8_QUIRKS_DEFAULT>;
+		runFrame_ = &Chip8CPU::RunFrameWithQuirks<CHIP8_QUIRKS_DEFAULT>;
+		break;
+	case CHIP8_QUIRKS_COSMAC_VIP:
+		step_ = &Chip8CPU::StepWithQuirks<CHIP8_QUIRKS_COSMAC_VIP>;
+		runFrame_ = &Chip8CPU::RunFrameWithQuirks<CHIP8_QUIRKS_COSMAC_VIP>;
+		break;
+	case CHIP8_QUIRKS_CHIP48:
+		step_ = &Chip8CPU::StepWithQuirks<CHIP8_QUIRKS_CHIP48>;
+		runFrame_ = &Chip8CPU::RunFrameWithQuirks<CHIP8_QUIRKS_CHIP48>;
+		break;
+	case CHIP8_QUIRKS_SCHIP:
+		step_ = &Chip8CPU::StepWithQuirks<CHIP8_QUIRKS_SCHIP>;
+		runFrame_ = &Chip8CPU::RunFrameWithQuirks<CHIP8_QUIRKS_SCHIP>;
+		break;
+	case CHIP8_QUIRKS_XOCHIP:
+		step_ = &Chip8CPU::StepWithQuirks<CHIP8_QUIRKS_XOCHIP>;
+		runFrame_ = &Chip8CPU::RunFrameWithQuirks<CHIP8_QUIRKS_XOCHIP>;
+		break;
+	default:
+		step_ = &Chip8CPU::StepWithQuirks<runtimeQuirks>;
+		runFrame_ = &Chip8CPU::RunFrameWithQuirks<runtimeQuirks>;
+		break;
+	}
+}
+
+
+u32 Chip8CPU::GetQuirks() const
+{
+	return quirks_;
+}
+
+
+void Chip8CPU::SeedRandom(u64 seed)
+{
+	rndSeed_ = seed;
+	isRndSeeded_ = true;
+	rnd_.Seed(seed);
+}
+
+
+void Chip8CPU::SetRandomEngine(Chip8RandomEngine engine)
+{
+	rnd_ = Chip8Random(engine, (isRndSeeded_ ? rndSeed_ : static_cast<u64>(Chip8Helper::GetNowDuration().count())));
+}
+
+
+Chip8RandomEngine Chip8CPU::GetRandomEngine() const
+{
+	return rnd_.GetEngine();
+}
+
+
 u16 Chip8CPU::GetLastOpcode() const
 {
 	return lastOp_;
+}
+
+
+const Chip8CPURegisters& Chip8CPU::GetRegisters() const
+{
+	return reg_;
+}
+
+
+void Chip8CPU::SetRegisters(const Chip8CPURegisters& reg)
+{
+	reg_ = reg;
+}
+
+
+void Chip8CPU::SaveState(Chip8MachineState* outState) const
+{
+	outState->registers = reg_;
+	outState->isInHiresMode = isInHiresMode_;
+	outState->isWaitingForInput = isWaitingForInput_;
+	outState->lastOp = lastOp_;
+	outState->rnd = rnd_;
+
+	outState->displayWidth = display_.GetWidth();
+	outState->displayHeight = display_.GetHeight();
+	std::copy(display_.GetRows(), display_.GetRows() + CHIP8_DISPLAY_MAX_HEIGHT, outState->displayRows);
+
+	outState->memorySize = ram_.GetAllocatedSize();
+	ram_.ReadBlock(0, outState->memory, outState->memorySize);
+}
+
+
+bool Chip8CPU::RestoreState(const Chip8MachineState& state)
+{
+	if (state.memorySize != ram_.GetAllocatedSize() ||
+		!IsValidBool(state.isInHiresMode) || !IsValidBool(state.isWaitingForInput) ||
+		state.rnd.GetEngine() > Chip8RandomEngine::COSMAC ||
+		state.displayWidth == 0 || state.displayWidth > CHIP8_DISPLAY_MAX_WIDTH ||
+		state.displayHeight == 0 || state.displayHeight > CHIP8_DISPLAY_MAX_HEIGHT)
+	{
+		return false;
+	}
+
+	reg_ = state.registers;
+	isInHiresMode_ = state.isInHiresMode;
+	isWaitingForInput_ = state.isWaitingForInput;
+	lastOp_ = state.lastOp;
+	rnd_ = state.rnd;
+	stepsIntoFrame_ = 0; // A restored state starts a new frame.
+
+	// Only resize the display if the state was saved in the other resolution.
+	if (display_.GetWidth() != state.displayWidth || display_.GetHeight() != state.displayHeight)
+	{
+		display_.Reset(state.displayWidth, state.displayHeight);
+	}
+
+	display_.SetRows(state.displayRows);
+	return ram_.WriteBlock(0, state.memory, state.memorySize);
 }
\ No newline at end of file
@@ -3,12 +3,13 @@
 #include "Chip8Types.h"
 #include "Chip8Memory.h"
 #include "Chip8Display.h"
+#include "Chip8Quirks.h"
+#include "Chip8Random.h"
 
-#include <random>
 #include <chrono>
-
-#include <SFML\Graphics\Font.hpp>
-#include <SFML\Graphics\Text.hpp>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
 
 /**
 * POD struct that contains the registers used by the Chip-8 CPU.
@@ -34,15 +35,48 @@ struct Chip8CPURegisters
 };
 
 
+/**
+* The whole state of a machine - its CPU, display and memory - saved by Chip8CPU::SaveState().
+* It is one flat, fixed-size block with no pointers, so cloning a machine or taking a snapshot of it is a plain copy,
+* and it can be written out and read back as raw bytes by builds of the same version.
+* Restoring one is much cheaper than reloading and resetting the machine, which is what makes
+* re-running a program from the same point many times (as the fuzzer does) fast.
+* The beeper and the real-time timer counters are not included.
+*/
+struct Chip8MachineState
+{
+	Chip8CPURegisters registers;
+	u16 lastOp;
+	bool isInHiresMode;
+	bool isWaitingForInput;
+	Chip8Random rnd;
+
+	u8 displayWidth, displayHeight;
+	u16 memorySize; // Only the first memorySize bytes of memory are used.
+	u64 displayRows[CHIP8_DISPLAY_MAX_HEIGHT]; // Packed as Chip8Display::GetRows() returns them.
+	u8 memory[CHIP8_MEMORY_SIZE];
+};
+
+static_assert(std::is_trivially_copyable<Chip8MachineState>::value, "Chip8MachineState must be copyable as raw bytes");
+
+
 class Chip8Beeper;
+class Chip8Coverage;
+class Chip8Debugger;
+class Chip8KeyState;
+class Chip8Tracer;
 
 /**
 * Contains the implementation of the Chip-8 CPU.
+*
+* Instructions whose behaviour depends on quirk flags are compiled once per quirk profile, with the
+* quirks known at compile time, so the checks compile away. Setting the quirks picks the matching
+* compiled variant - only flags that don't match a profile fall back to checking them at run time.
 */
 class Chip8CPU
 {
 public:
-	Chip8CPU(Chip8Memory& ram, Chip8Display& display, Chip8Beeper* beeper, bool isETI660 = false);
+	Chip8CPU(Chip8Memory& ram, Chip8Display& display, const Chip8KeyState& keyboard, Chip8Beeper* beeper, bool isETI660 = false, u32 quirks = CHIP8_QUIRKS_DEFAULT);
 	~Chip8CPU();
 
 	/**
@@ -52,15 +86,24 @@ public:
 
 	/**
 	* Executes one frame's worth of steps.
+	* While a tracer, coverage or an active debugger is attached, the steps run on an instrumented loop that
+	* records each one and checks with the debugger before it. If the debugger breaks in, the next call runs
+	* only the rest of that frame.
 	*/
 	bool RunFrame();
 
 	/**
-	* Executes the next program opcode in RAM.
+	* Executes the next program opcode in RAM, recording it to any attached tracer and coverage.
 	* Returns true if successful, false if there was an error.
 	*/
 	bool Step();
 
+	/**
+	* Finishes a frame whose steps were run one at a time with Step(), ticking the timers as RunFrame() does
+	* if they follow emulated time.
+	*/
+	void EndFrame();
+
 	/**
 	* Returns whether or not the CPU is emulating the ETI 660 computer.
 	*/
@@ -78,32 +121,148 @@ public:
 	bool IsWaitingForInput() const;
 
 	/**
-	* Renders CPU debug information onto a target.
+	* Sets whether DT and ST tick at 60 Hz of real time (the default), or exactly once per frame (after RunFrame's steps).
+	* Ticking once per frame makes the timers, and so the beep, follow emulated time for deterministic runs.
+	*/
+	void SetRealTimeTimers(bool val);
+
+	/**
+	* Returns whether or not DT and ST tick at 60 Hz of real time.
+	*/
+	bool IsUsingRealTimeTimers() const;
+
+	/**
+	* Sets the amount of steps RunFrame executes.
+	*/
+	void SetStepsPerFrame(u32 steps);
+
+	/**
+	* Gets the amount of steps RunFrame executes.
+	*/
+	u32 GetStepsPerFrame() const;
+
+	/**
+	* Sets the quirk flags (CHIP8_QUIRK_*) that the CPU emulates.
+	*/
+	void SetQuirks(u32 quirks);
+
+	/**
+	* Gets the quirk flags that the CPU emulates.
+	*/
+	u32 GetQuirks() const;
+
+	/**
+	* Seeds the random number generator used by the RND instruction.
+	* Until this is called, Reset() seeds it from the current time - afterwards, every reset restarts it from this seed.
+	*/
+	void SeedRandom(u64 seed);
+
+	/**
+	* Sets the random number generator used by the RND instruction, restarting it from the seed.
+	*/
+	void SetRandomEngine(Chip8RandomEngine engine);
+
+	/**
+	* Gets the random number generator used by the RND instruction.
+	*/
+	Chip8RandomEngine GetRandomEngine() const;
+
+	/**
+	* Attaches a debugger to the CPU, or detaches it if null.
+	*/
+	void SetDebugger(Chip8Debugger* debugger);
+
+	/**
+	* Gets the attached debugger, or null if there isn't one.
+	*/
+	Chip8Debugger* GetDebugger() const;
+
+	/**
+	* Attaches a tracer to record executed instructions to, or detaches it if null.
+	*/
+	void SetTracer(Chip8Tracer* tracer);
+
+	/**
+	* Attaches coverage to record executed instructions to, or detaches it if null.
 	*/
-	void RenderCPUDebug(sf::RenderTarget& target, const sf::Font& font) const;
+	void SetCoverage(Chip8Coverage* coverage);
+
+	/**
+	* Sends the messages about ignored instructions and CPU errors to a stream, or to std::cout and std::cerr if null.
+	*/
+	void SetLogStream(std::ostream* stream);
+
+	/**
+	* Gets CPU debug information (the last executed opcode and the registers) as text.
+	*/
+	std::string GetDebugText() const;
 
 	/**
 	* Returns the last executed opcode.
 	*/
 	u16 GetLastOpcode() const;
 
+	/**
+	* Gets the CPU registers.
+	*/
+	const Chip8CPURegisters& GetRegisters() const;
+
+	/**
+	* Overwrites the CPU registers.
+	*/
+	void SetRegisters(const Chip8CPURegisters& reg);
+
+	/**
+	* Copies the state of the CPU, display and memory into a machine state.
+	*/
+	void SaveState(Chip8MachineState* outState) const;
+
+	/**
+	* Restores the state of the CPU, display and memory from a machine state saved from this machine.
+	* Returns true on success, false if the state doesn't fit the memory or the display, or holds invalid flags.
+	*/
+	bool RestoreState(const Chip8MachineState& state);
+
 private:
 	Chip8CPURegisters reg_;
 	Chip8Memory& ram_;
 	Chip8Display& display_;
+	const Chip8KeyState& keyboard_;
 	Chip8Beeper* beeper_;
 	u16 defaultSpritesAddr_;
 
 	const bool isETI660_;
 	bool isInHiresMode_;
 	bool isWaitingForInput_;
+	bool isUsingRealTimeTimers_;
 	u16 lastOp_;
 
-	std::mt19937 rnd_;
-	std::uniform_int_distribution<short> rndDist_;
+	u32 quirks_;
+	u32 stepsPerFrame_;
+	u32 stepsIntoFrame_; // Steps already run of a frame the debugger broke into
+	bool (Chip8CPU::*step_)();
+	bool (Chip8CPU::*runFrame_)();
+	Chip8Debugger* debugger_;
+	Chip8Tracer* tracer_;
+	Chip8Coverage* coverage_;
+	std::ostream* log_;
+
+	Chip8Random rnd_;
+	u64 rndSeed_;
+	bool isRndSeeded_;
 	std::chrono::high_resolution_clock::duration lastStepTime_;
 	std::chrono::high_resolution_clock::duration nextTimerDecrementCounter_;
 
+	/**
+	* Gets the stream to write informational messages to.
+	*/
+	std::ostream& GetInfoLog() const;
+
+	/**
+	* Gets the stream to write error messages to.
+	*/
+	std::ostream& GetErrorLog() const;
+
 	/**
 	* Initializes registers. Sets PC to value depending on if CPU is ETI 660 or not.
 	*/
@@ -120,10 +279,45 @@ private:
 	void ResetTimerDecrement();
 
 	/**
-	* Updates the DT and ST timers.
+	* Updates the DT and ST timers if enough real time has passed.
 	*/
 	void UpdateTimers();
 
+	/**
+	* Decrements DT and ST and updates the beeper.
+	*/
+	void TickTimers();
+
+	/**
+	* Returns whether or not a quirk is emulated by the variant of the CPU compiled for Quirks.
+	*/
+	template <u32 Quirks>
+	bool HasQuirk(u32 quirk) const;
+
+	/**
+	* Leaves I after the registers LD [I], Vx or LD Vx, [I] loaded or stored, if the quirks say so.
+	*/
+	template <u32 Quirks>
+	void IncrementIAfterLoadStore(u16 op);
+
+	/**
+	* Step() for the variant of the CPU compiled for Quirks.
+	*/
+	template <u32 Quirks>
+	bool StepWithQuirks();
+
+	/**
+	* RunFrame() for the variant of the CPU compiled for Quirks.
+	*/
+	template <u32 Quirks>
+	bool RunFrameWithQuirks();
+
+	/**
+	* RunFrame() that checks with the debugger before each step and records each step to the tracer and coverage.
+	* A frame the debugger breaks into is picked up where it stopped on the next call, rather than started again.
+	*/
+	bool RunFrameInstrumented();
+
 	/**
 	* Fetches the next opcode in program memory.
 	* Writes to outOp if it is not null.
@@ -155,6 +349,7 @@ private:
 	* Executes the specified opcode.
 	* Returns true on success, false on failure.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpcode(u16 op);
 
 	/**
@@ -214,17 +409,23 @@ private:
 
 	/**
 	* Executes the OR opcode - performs bitwise OR on Vx and Vy - stores result in Vx.
+	* Sets VF to 0 with CHIP8_QUIRK_LOGIC_RESETS_VF.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpOR(u16 op);
 
 	/**
 	* Executes the AND opcode - performs a bitwise AND on Vx and Vy - stores result in Vx.
+	* Sets VF to 0 with CHIP8_QUIRK_LOGIC_RESETS_VF.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpAND(u16 op);
 
 	/**
 	* Executes the XOR opcode - performs a bitwise XOR on Vx and Vy - stores result in Vx.
+	* Sets VF to 0 with CHIP8_QUIRK_LOGIC_RESETS_VF.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpXOR(u16 op);
 
 	/**
@@ -239,7 +440,9 @@ private:
 
 	/**
 	* Executes the SHR opcode - sets VF to 1 if the least-significant bit of Vx is 1, otherwise 0. Then divides Vx by 2.
+	* Vx is set to Vy first with CHIP8_QUIRK_SHIFT_USES_VY.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpSHR(u16 op);
 
 	/**
@@ -249,7 +452,9 @@ private:
 
 	/**
 	* Executes the SHL opcode - sets VF to 1 if the most-significant bit of Vx is 1, otherwise 0. Then multiplies Vx by 2.
+	* Vx is set to Vy first with CHIP8_QUIRK_SHIFT_USES_VY.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpSHL(u16 op);
 
 	/**
@@ -264,7 +469,9 @@ private:
 
 	/**
 	* Executes the JP V0, addr opcode - jumps to an address in memory + V0.
+	* Uses Vx instead of V0 with CHIP8_QUIRK_JUMP_USES_VX.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpJPV0Addr(u16 op);
 
 	/**
@@ -275,7 +482,9 @@ private:
 	/**
 	* Executes the DRW opcode - displays sprite starting at address I to (I + n) at co-ords (Vx, Vy).
 	* VF is set to 1 if it causes any pixels that are already on to be toggled off, otherwise 0.
+	* Sprites wrap around the edges of the display, unless CHIP8_QUIRK_CLIP_SPRITES is set.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpDRW(u16 op);
 
 	/**
@@ -325,12 +534,25 @@ private:
 
 	/**
 	* Executes the LD [I], Vx opcode - stores registers V0 through Vx in memory at location I.
+	* I is left unchanged, unless CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I(_BY_X) is set.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpLDIaddrVx(u16 op);
 
 	/**
 	* Executes the LD Vx, [I] opcode - reads registers V0 through Vx from memory starting at location I.
+	* I is left unchanged, unless CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I(_BY_X) is set.
 	*/
+	template <u32 Quirks>
 	bool ExecuteOpLDVxIaddr(u16 op);
-};
 
+	/**
+	* Executes the XO-CHIP AUDIO opcode (F002) - loads the 16-byte audio pattern starting at location I into the beeper.
+	*/
+	bool ExecuteOpAUDIO();
+
+	/**
+	* Executes the XO-CHIP PITCH opcode (Fx3A) - sets the audio pattern playback pitch to Vx.
+	*/
+	bool ExecuteOpPITCH(u16 op);
+};
\ No newline at end of file
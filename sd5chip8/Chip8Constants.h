@@ -11,19 +11,48 @@
 #define CHIP8_HIRES_DISPLAY_WIDTH 64
 #define CHIP8_HIRES_DISPLAY_HEIGHT 64
 
-#define CHIP8_BEEPER_DEFAULT_SAMPLES 44100
+#define CHIP8_DISPLAY_MAX_WIDTH 64 // Each row of the display is packed into a u64
+#define CHIP8_DISPLAY_MAX_HEIGHT 64
+
+#define CHIP8_BEEPER_DEFAULT_BUFFER_SAMPLES 1024 // Around 23 ms at the default sample rate
 #define CHIP8_BEEPER_DEFAULT_SAMPLE_RATE 44100
-#define CHIP8_BEEPER_DEFAULT_AMPLITUDE 35000
+#define CHIP8_BEEPER_DEFAULT_AMPLITUDE 8000 // A square wave is much louder than a sine of the same amplitude
+#define CHIP8_BEEPER_DEFAULT_FREQUENCY 441
+#define CHIP8_BEEPER_DEFAULT_PITCH 64 // XO-CHIP pitch for 4000 bits per second pattern playback
 
 #define CHIP8_MEMORY_SIZE 4096
 #define CHIP8_MEMORY_ETI660_SIZE 2048
 
 #define CHIP8_CPU_STEPS_PER_FRAME 8
+#define CHIP8_CPU_SCHIP_STEPS_PER_FRAME 30
+#define CHIP8_CPU_XOCHIP_STEPS_PER_FRAME 1000
 #define CHIP8_CPU_TIMER_DECREMENT_DELAY_MICROSECONDS 16667 // Rate of around 60 Hz
+#define CHIP8_CPU_TIMER_RATE 60 // Timer ticks per second of emulated time
 
 #define CHIP8_FRAME_SLEEP_MICROSECONDS 16667 // Rate of around 60 Hz
+#define CHIP8_FRAME_PACER_SPIN_MICROSECONDS 2000
+#define CHIP8_FRAME_PACER_STATS_SAMPLES 600 // Around 10 seconds worth of frames
+#define CHIP8_IDLE_WAIT_MILLISECONDS 50 // Upper bound on how late window events are noticed while idle
+#define CHIP8_FRAME_STATS_CSV_FILENAME "frame_stats.csv"
+#define CHIP8_FRAME_SAMPLES_CSV_FILENAME "frame_samples.csv"
+
+#define CHIP8_ROM_PACK_EXTENSION ".c8pk"
+#define CHIP8_ROM_MAX_SIZE (CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_START) // The largest program any platform can load
+#define CHIP8_ROM_CACHE_MAX_IMAGES 256 // Least recently used images are evicted past this
+
+#define CHIP8_COVERAGE_EXTENSION ".c8cv"
+#define CHIP8_COVERAGE_EDGE_MAP_SIZE 4096 // Edge hit counters kept by coverage - must be a power of 2
+
+#define CHIP8_FUZZ_INPUT_EXTENSION ".c8fz"
+
+#define CHIP8_TRACE_EXTENSION ".c8tr"
+#define CHIP8_TRACE_BUFFER_SIZE (1 << 20) // Bytes of records handed to the trace writer thread at a time
+
+#define CHIP8_GDB_DEFAULT_PORT 1234
+#define CHIP8_GDB_POLL_MILLISECONDS 10 // How often the server thread checks its sockets and the mailbox
+#define CHIP8_GDB_MAX_PACKET_SIZE 0x4000
 
 #define CHIP8_PROGRAM_START 0x200
 #define CHIP8_PROGRAM_ETI660_START 0x600
 #define CHIP8_PROGRAM_HIRES_START 0x2C0
-#define CHIP8_PROGRAM_DEFAULT_SPRITES_START 0x000
+#define CHIP8_PROGRAM_DEFAULT_SPRITES_START 0x000
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include "Chip8Coverage.h"
+
+#include "Chip8Disassembler.h"
+#include "Chip8Opcodes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+
+namespace
+{
+	const u8 coverageMagic[4] = { 'C', '8', 'C', 'V' };
+	const u8 coverageVersion = 1;
+	const size_t headerSize = 8;
+	const size_t bitmapWords = CHIP8_MEMORY_SIZE / 64;
+	const size_t fileSize = headerSize + bitmapWords * 8 + CHIP8_MEMORY_SIZE * 4 * 2;
+
+	inline void Write32(std::vector<u8>& out, u32 val)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			out.push_back(static_cast<u8>(val >> (i * 8)));
+		}
+	}
+
+	inline u32 Read32(const u8* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<u32>(p[3]) << 24); }
+
+	inline u32 AddSaturated(u32 a, u32 b) { return (a > 0xFFFFFFFF - b ? 0xFFFFFFFF : a + b); }
+
+
+	/**
+	* An instruction of a program, as listed in coverage reports.
+	*/
+	struct ListedInstruction
+	{
+		u16 address;
+		u16 op;
+		bool isSkip;
+		bool isSubroutine; // The start of the program or of a subroutine.
+	};
+
+
+	/**
+	* Lists the instructions of a program found by following its control flow from its start and from
+	* every executed address, so code only reached through JP V0, addr is listed too.
+	* Returns true on success, false if the program couldn't be disassembled.
+	*/
+	bool ListInstructions(const Chip8Coverage& coverage, const u8* data, size_t size, u16 loadAddress,
+		std::vector<ListedInstruction>* outInstructions)
+	{
+		const auto endAddress = std::min<size_t>(static_cast<size_t>(loadAddress) + size, CHIP8_MEMORY_SIZE);
+		std::vector<u16> entryAddresses(1, loadAddress);
+		for (size_t addr = loadAddress; addr + 1 < endAddress; ++addr)
+		{
+			if (coverage.IsExecuted(static_cast<u16>(addr)))
+			{
+				entryAddresses.push_back(static_cast<u16>(addr));
+			}
+		}
+
+		Chip8ControlFlowGraph cfg;
+		if (!cfg.Build(data, size, loadAddress, entryAddresses))
+		{
+			return false;
+		}
+
+		outInstructions->clear();
+		for (size_t addr = loadAddress; addr < endAddress;)
+		{
+			u16 op;
+			if (!cfg.IsInstructionStart(static_cast<u16>(addr)) || !cfg.GetOpcode(static_cast<u16>(addr), &op))
+			{
+				++addr;
+				continue;
+			}
+
+			const auto block = cfg.FindBlock(static_cast<u16>(addr));
+			ListedInstruction instruction;
+			instruction.address = static_cast<u16>(addr);
+			instruction.op = op;
+			instruction.isSkip = ((Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(op)).flow & CHIP8_OP_FLOW_SKIP) != 0);
+			instruction.isSubroutine = (block != nullptr && block->start == addr && (block->isCallTarget || addr == loadAddress));
+			outInstructions->push_back(instruction);
+			addr += 2;
+		}
+
+		return true;
+	}
+
+
+	std::string EscapeJSON(const std::string& str)
+	{
+		std::string escaped;
+		for (const auto c : str)
+		{
+			if (c == '"' || c == '\\')
+			{
+				escaped += '\\';
+				escaped += c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				escaped += buffer;
+			}
+			else
+			{
+				escaped += c;
+			}
+		}
+
+		return escaped;
+	}
+
+
+	std::string FormatHex(u32 val, int digits)
+	{
+		char buffer[16];
+		std::snprintf(buffer, sizeof(buffer), "0x%0*X", digits, val);
+		return buffer;
+	}
+}
+
+
+Chip8Coverage::Chip8Coverage()
+{
+	Clear();
+}
+
+
+Chip8Coverage::~Chip8Coverage()
+{
+}
+
+
+void Chip8Coverage::Clear()
+{
+	std::memset(executed_, 0, sizeof(executed_));
+	std::memset(skipTaken_, 0, sizeof(skipTaken_));
+	std::memset(skipNotTaken_, 0, sizeof(skipNotTaken_));
+	std::memset(edges_, 0, sizeof(edges_));
+}
+
+
+void Chip8Coverage::Merge(const Chip8Coverage& other)
+{
+	for (size_t i = 0; i < bitmapWords; ++i)
+	{
+		executed_[i] |= other.executed_[i];
+	}
+
+	for (size_t i = 0; i < CHIP8_MEMORY_SIZE; ++i)
+	{
+		skipTaken_[i] = AddSaturated(skipTaken_[i], other.skipTaken_[i]);
+		skipNotTaken_[i] = AddSaturated(skipNotTaken_[i], other.skipNotTaken_[i]);
+	}
+
+	for (size_t i = 0; i < CHIP8_COVERAGE_EDGE_MAP_SIZE; ++i)
+	{
+		edges_[i] = static_cast<u8>(std::min(edges_[i] + other.edges_[i], 0xFF));
+	}
+}
+
+
+bool Chip8Coverage::IsExecuted(u16 address) const
+{
+	address &= (CHIP8_MEMORY_SIZE - 1);
+	return ((executed_[address >> 6] >> (address & 63)) & 1) != 0;
+}
+
+
+u32 Chip8Coverage::GetSkipTakenCount(u16 address) const
+{
+	return skipTaken_[address & (CHIP8_MEMORY_SIZE - 1)];
+}
+
+
+u32 Chip8Coverage::GetSkipNotTakenCount(u16 address) const
+{
+	return skipNotTaken_[address & (CHIP8_MEMORY_SIZE - 1)];
+}
+
+
+size_t Chip8Coverage::GetExecutedCount() const
+{
+	size_t count = 0;
+	for (size_t i = 0; i < bitmapWords; ++i)
+	{
+		for (auto word = executed_[i]; word != 0; word &= word - 1)
+		{
+			++count;
+		}
+	}
+
+	return count;
+}
+
+
+bool Chip8Coverage::Save(const std::string& fileName) const
+{
+	std::vector<u8> out(coverageMagic, coverageMagic + sizeof(coverageMagic));
+	out.push_back(coverageVersion);
+	out.insert(out.end(), 3, 0);
+	out.reserve(fileSize);
+
+	for (size_t i = 0; i < bitmapWords; ++i)
+	{
+		Write32(out, static_cast<u32>(executed_[i]));
+		Write32(out, static_cast<u32>(executed_[i] >> 32));
+	}
+
+	for (const auto count : skipTaken_)
+	{
+		Write32(out, count);
+	}
+
+	for (const auto count : skipNotTaken_)
+	{
+		Write32(out, count);
+	}
+
+	auto file = std::ofstream(fileName, std::ios_base::binary | std::ios_base::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	return file.good();
+}
+
+
+bool Chip8Coverage::Load(const std::string& fileName)
+{
+	auto file = std::ifstream(fileName, std::ios_base::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const std::vector<u8> in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (in.size() != fileSize || std::memcmp(in.data(), coverageMagic, sizeof(coverageMagic)) != 0 || in[4] != coverageVersion)
+	{
+		return false;
+	}
+
+	auto p = in.data() + headerSize;
+	for (size_t i = 0; i < bitmapWords; ++i, p += 8)
+	{
+		executed_[i] = Read32(p) | (static_cast<u64>(Read32(p + 4)) << 32);
+	}
+
+	for (size_t i = 0; i < CHIP8_MEMORY_SIZE; ++i, p += 4)
+	{
+		skipTaken_[i] = Read32(p);
+	}
+
+	for (size_t i = 0; i < CHIP8_MEMORY_SIZE; ++i, p += 4)
+	{
+		skipNotTaken_[i] = Read32(p);
+	}
+
+	std::memset(edges_, 0, sizeof(edges_));
+	return true;
+}
+
+
+bool Chip8Coverage::WriteJSON(const std::string& fileName, const std::string& programName, const u8* data, size_t size, u16 loadAddress) const
+{
+	std::vector<ListedInstruction> instructions;
+	if (!ListInstructions(*this, data, size, loadAddress, &instructions))
+	{
+		return false;
+	}
+
+	size_t executedCount = 0, skipCount = 0, skipBothWaysCount = 0;
+	for (const auto& instruction : instructions)
+	{
+		executedCount += (IsExecuted(instruction.address) ? 1 : 0);
+		if (instruction.isSkip)
+		{
+			++skipCount;
+			skipBothWaysCount += (GetSkipTakenCount(instruction.address) != 0 && GetSkipNotTakenCount(instruction.address) != 0 ? 1 : 0);
+		}
+	}
+
+	auto file = std::ofstream(fileName, std::ios_base::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "{" << std::endl
+		<< "  \"program\": \"" << EscapeJSON(programName) << "\"," << std::endl
+		<< "  \"loadAddress\": \"" << FormatHex(loadAddress, 3) << "\"," << std::endl
+		<< "  \"instructions\": " << instructions.size() << "," << std::endl
+		<< "  \"executed\": " << executedCount << "," << std::endl
+		<< "  \"skips\": " << skipCount << "," << std::endl
+		<< "  \"skipsBothWays\": " << skipBothWaysCount << "," << std::endl
+		<< "  \"listing\": [";
+
+	for (size_t i = 0; i < instructions.size(); ++i)
+	{
+		const auto& instruction = instructions[i];
+		file << (i == 0 ? "" : ",") << std::endl
+			<< "    { \"address\": \"" << FormatHex(instruction.address, 3) << "\""
+			<< ", \"opcode\": \"" << FormatHex(instruction.op, 4) << "\""
+			<< ", \"text\": \"" << EscapeJSON(Chip8Disassembler::FormatInstruction(instruction.op)) << "\""
+			<< ", \"executed\": " << (IsExecuted(instruction.address) ? "true" : "false");
+
+		if (instruction.isSubroutine)
+		{
+			file << ", \"subroutine\": true";
+		}
+
+		if (instruction.isSkip)
+		{
+			file << ", \"skipTaken\": " << GetSkipTakenCount(instruction.address)
+				<< ", \"skipNotTaken\": " << GetSkipNotTakenCount(instruction.address);
+		}
+
+		file << " }";
+	}
+
+	file << std::endl << "  ]" << std::endl << "}" << std::endl;
+	return file.good();
+}
+
+
+bool Chip8Coverage::WriteLcov(const std::string& fileName, const std::string& programName, const u8* data, size_t size, u16 loadAddress) const
+{
+	std::vector<ListedInstruction> instructions;
+	if (!ListInstructions(*this, data, size, loadAddress, &instructions))
+	{
+		return false;
+	}
+
+	auto file = std::ofstream(fileName, std::ios_base::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "TN:" << std::endl << "SF:" << programName << std::endl;
+
+	// Subroutines, named after their address and first instruction.
+	size_t functionCount = 0, functionHitCount = 0;
+	for (const auto& instruction : instructions)
+	{
+		if (instruction.isSubroutine)
+		{
+			file << "FN:" << instruction.address << "," << FormatHex(instruction.address, 3) << " "
+				<< Chip8Disassembler::FormatInstruction(instruction.op) << std::endl;
+		}
+	}
+
+	for (const auto& instruction : instructions)
+	{
+		if (instruction.isSubroutine)
+		{
+			const auto isExecuted = IsExecuted(instruction.address);
+			file << "FNDA:" << (isExecuted ? 1 : 0) << "," << FormatHex(instruction.address, 3) << " "
+				<< Chip8Disassembler::FormatInstruction(instruction.op) << std::endl;
+			++functionCount;
+			functionHitCount += (isExecuted ? 1 : 0);
+		}
+	}
+
+	file << "FNF:" << functionCount << std::endl << "FNH:" << functionHitCount << std::endl;
+
+	// Skips as two-way branches - the first is skipping, the second is not.
+	size_t branchCount = 0, branchHitCount = 0;
+	for (const auto& instruction : instructions)
+	{
+		if (!instruction.isSkip)
+		{
+			continue;
+		}
+
+		const u32 counts[2] = { GetSkipTakenCount(instruction.address), GetSkipNotTakenCount(instruction.address) };
+		for (int branch = 0; branch < 2; ++branch)
+		{
+			file << "BRDA:" << instruction.address << ",0," << branch << ",";
+			if (IsExecuted(instruction.address))
+			{
+				file << counts[branch];
+			}
+			else
+			{
+				file << "-";
+			}
+			file << std::endl;
+
+			++branchCount;
+			branchHitCount += (counts[branch] != 0 ? 1 : 0);
+		}
+	}
+
+	file << "BRF:" << branchCount << std::endl << "BRH:" << branchHitCount << std::endl;
+
+	size_t lineHitCount = 0;
+	for (const auto& instruction : instructions)
+	{
+		const auto isExecuted = IsExecuted(instruction.address);
+		file << "DA:" << instruction.address << "," << (isExecuted ? 1 : 0) << std::endl;
+		lineHitCount += (isExecuted ? 1 : 0);
+	}
+
+	file << "LF:" << instructions.size() << std::endl << "LH:" << lineHitCount << std::endl
+		<< "end_of_record" << std::endl;
+	return file.good();
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8Types.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+* Records which instructions of a program were executed, and how often each skip instruction
+* (SE, SNE, SKP and SKNP) skipped or didn't.
+*
+* Executed addresses are kept in a 512-byte bitmap, and skip counters are only touched by skips,
+* so recording stays cheap enough to leave on while fuzzing. Jumps, calls, returns and taken skips are
+* also counted by edge (a hash of the address they left and the PC they left behind) in a small hit map,
+* as feedback for the fuzzer - the edge map is not saved. Coverage from separate runs can be
+* saved, loaded and merged, then reported as JSON or as an lcov tracefile annotated with disassembly.
+*
+* The saved layout (all values little-endian) is the magic "C8CV", a u8 version and 3 reserved bytes,
+* the bitmap as u64 words, then the u32 skip taken counts and u32 skip not taken counts for each address.
+*/
+class Chip8Coverage
+{
+public:
+	Chip8Coverage();
+	~Chip8Coverage();
+
+	/**
+	* Records an instruction executed at address, and the PC it left behind.
+	*/
+	inline void Record(u16 address, u16 op, u16 nextPC)
+	{
+		address &= (CHIP8_MEMORY_SIZE - 1);
+		executed_[address >> 6] |= (1ULL << (address & 63));
+
+		// The skip instructions are all of 3xkk, 4xkk, 5xy0, 9xy0 and Ex9E / ExA1.
+		if (((0x4238 >> (op >> 12)) & 1) != 0)
+		{
+			auto& count = (nextPC == static_cast<u16>(address + 4) ? skipTaken_[address] : skipNotTaken_[address]);
+			count += (count != 0xFFFFFFFF ? 1 : 0);
+		}
+
+		// Only count edges that leave the straight line - falling through to the next instruction is implied.
+		if (nextPC != static_cast<u16>(address + 2))
+		{
+			auto& count = edges_[((address * 31u) ^ nextPC) & (CHIP8_COVERAGE_EDGE_MAP_SIZE - 1)];
+			count += (count != 0xFF ? 1 : 0);
+		}
+	}
+
+	/**
+	* Forgets all recorded coverage.
+	*/
+	void Clear();
+
+	/**
+	* Adds the coverage recorded by another run.
+	*/
+	void Merge(const Chip8Coverage& other);
+
+	/**
+	* Returns whether or not the instruction at an address was executed.
+	*/
+	bool IsExecuted(u16 address) const;
+
+	/**
+	* Gets the amount of times the skip instruction at an address skipped.
+	*/
+	u32 GetSkipTakenCount(u16 address) const;
+
+	/**
+	* Gets the amount of times the skip instruction at an address didn't skip.
+	*/
+	u32 GetSkipNotTakenCount(u16 address) const;
+
+	/**
+	* Gets the edge hit map - CHIP8_COVERAGE_EDGE_MAP_SIZE saturating hit counts, indexed by edge hash.
+	*/
+	inline const u8* GetEdgeCounts() const { return edges_; }
+
+	/**
+	* Gets the executed address bitmap, as CHIP8_MEMORY_SIZE / 64 words.
+	*/
+	inline const u64* GetExecutedBitmap() const { return executed_; }
+
+	/**
+	* Gets the amount of executed addresses.
+	*/
+	size_t GetExecutedCount() const;
+
+	/**
+	* Saves the coverage to a file, for merging later.
+	* Returns true on success, false on failure.
+	*/
+	bool Save(const std::string& fileName) const;
+
+	/**
+	* Loads coverage saved by Save(), replacing the recorded coverage.
+	* Returns true on success, false on failure.
+	*/
+	bool Load(const std::string& fileName);
+
+	/**
+	* Writes a JSON report of the coverage of a program loaded at loadAddress, listing every instruction
+	* found by following its control flow (or executed) with its disassembly.
+	* Returns true on success, false on failure.
+	*/
+	bool WriteJSON(const std::string& fileName, const std::string& programName, const u8* data, size_t size, u16 loadAddress) const;
+
+	/**
+	* Writes an lcov tracefile of the coverage of a program loaded at loadAddress. Line numbers are the
+	* addresses of the instructions, subroutines are reported as functions, and skips as branches.
+	* Returns true on success, false on failure.
+	*/
+	bool WriteLcov(const std::string& fileName, const std::string& programName, const u8* data, size_t size, u16 loadAddress) const;
+
+private:
+	u64 executed_[CHIP8_MEMORY_SIZE / 64];
+	u32 skipTaken_[CHIP8_MEMORY_SIZE];
+	u32 skipNotTaken_[CHIP8_MEMORY_SIZE];
+	u8 edges_[CHIP8_COVERAGE_EDGE_MAP_SIZE];
+};
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "Chip8Debugger.h"
+
+#include "Chip8CPU.h"
+#include "Chip8Opcodes.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+
+namespace
+{
+	u16 GetRegisterValue(const Chip8CPURegisters& reg, Chip8BreakRegister breakReg)
+	{
+		switch (breakReg)
+		{
+		case Chip8BreakRegister::I: return reg.I;
+		case Chip8BreakRegister::DT: return reg.DT;
+		case Chip8BreakRegister::ST: return reg.ST;
+		case Chip8BreakRegister::SP: return reg.SP;
+		default: return reg.V[static_cast<u8>(breakReg) & 0xF];
+		}
+	}
+
+
+	bool IsConditionTrue(const Chip8BreakCondition& condition, const Chip8CPURegisters& reg)
+	{
+		const auto val = GetRegisterValue(reg, condition.reg);
+		switch (condition.compare)
+		{
+		case Chip8BreakCompare::Equal: return (val == condition.value);
+		case Chip8BreakCompare::NotEqual: return (val != condition.value);
+		case Chip8BreakCompare::Less: return (val < condition.value);
+		case Chip8BreakCompare::Greater: return (val > condition.value);
+		default: return false;
+		}
+	}
+}
+
+
+Chip8Debugger::Chip8Debugger() :
+hasWatches_(false),
+isPaused_(false),
+isPauseRequested_(false),
+isResuming_(false),
+stepMode_(StepMode::None),
+hasStepped_(false),
+stepStartSP_(0)
+{
+}
+
+
+Chip8Debugger::~Chip8Debugger()
+{
+}
+
+
+void Chip8Debugger::AddBreakpoint(u16 address)
+{
+	breakpoints_.set(address % CHIP8_MEMORY_SIZE);
+}
+
+
+void Chip8Debugger::RemoveBreakpoint(u16 address)
+{
+	breakpoints_.reset(address % CHIP8_MEMORY_SIZE);
+}
+
+
+bool Chip8Debugger::ToggleBreakpoint(u16 address)
+{
+	breakpoints_.flip(address % CHIP8_MEMORY_SIZE);
+	return breakpoints_.test(address % CHIP8_MEMORY_SIZE);
+}
+
+
+bool Chip8Debugger::HasBreakpoint(u16 address) const
+{
+	return breakpoints_.test(address % CHIP8_MEMORY_SIZE);
+}
+
+
+void Chip8Debugger::AddWatchpoint(u16 address, u16 size, u8 access)
+{
+	for (u32 addr = address; addr < static_cast<u32>(address) + size && addr < CHIP8_MEMORY_SIZE; ++addr)
+	{
+		if ((access & CHIP8_OP_MEMORY_READ) != 0)
+		{
+			readWatches_.set(addr);
+		}
+
+		if ((access & CHIP8_OP_MEMORY_WRITE) != 0)
+		{
+			writeWatches_.set(addr);
+		}
+	}
+
+	hasWatches_ = (readWatches_.any() || writeWatches_.any());
+}
+
+
+void Chip8Debugger::RemoveWatchpoint(u16 address, u16 size, u8 access)
+{
+	for (u32 addr = address; addr < static_cast<u32>(address) + size && addr < CHIP8_MEMORY_SIZE; ++addr)
+	{
+		if ((access & CHIP8_OP_MEMORY_READ) != 0)
+		{
+			readWatches_.reset(addr);
+		}
+
+		if ((access & CHIP8_OP_MEMORY_WRITE) != 0)
+		{
+			writeWatches_.reset(addr);
+		}
+	}
+
+	hasWatches_ = (readWatches_.any() || writeWatches_.any());
+}
+
+
+u8 Chip8Debugger::GetWatchpointAccess(u16 address) const
+{
+	if (address >= CHIP8_MEMORY_SIZE)
+	{
+		return 0;
+	}
+
+	return (readWatches_.test(address) ? CHIP8_OP_MEMORY_READ : 0) | (writeWatches_.test(address) ? CHIP8_OP_MEMORY_WRITE : 0);
+}
+
+
+void Chip8Debugger::AddCondition(const Chip8BreakCondition& condition)
+{
+	conditions_.push_back(condition);
+	conditionStates_.push_back(false);
+}
+
+
+void Chip8Debugger::ClearAll()
+{
+	breakpoints_.reset();
+	readWatches_.reset();
+	writeWatches_.reset();
+	hasWatches_ = false;
+	conditions_.clear();
+	conditionStates_.clear();
+}
+
+
+void Chip8Debugger::Pause()
+{
+	if (!isPaused_)
+	{
+		isPauseRequested_ = true;
+	}
+}
+
+
+void Chip8Debugger::Continue()
+{
+	Resume(StepMode::None);
+}
+
+
+void Chip8Debugger::StepInto()
+{
+	Resume(StepMode::Into);
+}
+
+
+void Chip8Debugger::StepOver()
+{
+	Resume(StepMode::Over);
+}
+
+
+void Chip8Debugger::StepOut()
+{
+	Resume(StepMode::Out);
+}
+
+
+bool Chip8Debugger::IsPaused() const
+{
+	return isPaused_;
+}
+
+
+const std::string& Chip8Debugger::GetBreakReason() const
+{
+	return breakReason_;
+}
+
+
+bool Chip8Debugger::IsActive() const
+{
+	return (isPaused_ || isPauseRequested_ || stepMode_ != StepMode::None
+		|| hasWatches_ || !conditions_.empty() || breakpoints_.any());
+}
+
+
+bool Chip8Debugger::CheckBeforeStep(const Chip8CPURegisters& reg, u16 op)
+{
+	if (isPaused_)
+	{
+		return true;
+	}
+
+	if (isPauseRequested_)
+	{
+		Break("Paused");
+		return true;
+	}
+
+	// Conditions break as they become true, so keep their states up to date even when not breaking on them.
+	auto isConditionMet = false;
+	for (size_t i = 0; i < conditions_.size(); ++i)
+	{
+		const auto isTrue = IsConditionTrue(conditions_[i], reg);
+		isConditionMet = isConditionMet || (isTrue && !conditionStates_[i]);
+		conditionStates_[i] = isTrue;
+	}
+
+	if (stepMode_ != StepMode::None && !hasStepped_)
+	{
+		stepStartSP_ = reg.SP;
+	}
+
+	// Always run the instruction execution resumed on, otherwise it would just break again.
+	if (isResuming_)
+	{
+		return false;
+	}
+
+	std::ostringstream oss;
+	oss << std::hex;
+
+	if (stepMode_ != StepMode::None && hasStepped_)
+	{
+		// SP is deeper while inside a subroutine called by the instruction stepped over.
+		if (stepMode_ == StepMode::Into
+			|| (stepMode_ == StepMode::Over && reg.SP <= stepStartSP_)
+			|| (stepMode_ == StepMode::Out && reg.SP < stepStartSP_))
+		{
+			oss << "Step to 0x" << reg.PC;
+			Break(oss.str());
+			return true;
+		}
+	}
+
+	if (breakpoints_.test(reg.PC % CHIP8_MEMORY_SIZE))
+	{
+		oss << "Breakpoint at 0x" << reg.PC;
+		Break(oss.str());
+		return true;
+	}
+
+	if (hasWatches_)
+	{
+		const auto access = Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(op)).memoryAccess;
+		if (access != CHIP8_OP_MEMORY_NONE)
+		{
+			const auto size = Chip8Opcodes::GetMemoryAccessSize(op);
+			for (u32 addr = reg.I; addr < static_cast<u32>(reg.I) + size && addr < CHIP8_MEMORY_SIZE; ++addr)
+			{
+				if (((access & CHIP8_OP_MEMORY_READ) != 0 && readWatches_.test(addr))
+					|| ((access & CHIP8_OP_MEMORY_WRITE) != 0 && writeWatches_.test(addr)))
+				{
+					oss << "Watchpoint on 0x" << addr << " hit by 0x" << op << " at 0x" << reg.PC;
+					Break(oss.str());
+					return true;
+				}
+			}
+		}
+	}
+
+	if (isConditionMet)
+	{
+		oss << "Condition met at 0x" << reg.PC;
+		Break(oss.str());
+		return true;
+	}
+
+	return false;
+}
+
+
+void Chip8Debugger::OnAfterStep(const Chip8CPURegisters&)
+{
+	isResuming_ = false;
+	hasStepped_ = true;
+}
+
+
+void Chip8Debugger::Break(const std::string& reason)
+{
+	isPaused_ = true;
+	isPauseRequested_ = false;
+	stepMode_ = StepMode::None;
+	breakReason_ = reason;
+}
+
+
+void Chip8Debugger::Resume(StepMode mode)
+{
+	isResuming_ = isPaused_;
+	isPaused_ = false;
+	isPauseRequested_ = false;
+	stepMode_ = mode;
+	hasStepped_ = false;
+}
+
+
+
+bool Chip8Debugger::ParseCondition(const std::string& str, Chip8BreakCondition* outCondition)
+{
+	static const struct
+	{
+		const char* text;
+		Chip8BreakCompare compare;
+	} compares[] = {
+		{ "==", Chip8BreakCompare::Equal },
+		{ "!=", Chip8BreakCompare::NotEqual },
+		{ "<", Chip8BreakCompare::Less },
+		{ ">", Chip8BreakCompare::Greater }
+	};
+
+	for (const auto& compare : compares)
+	{
+		const auto pos = str.find(compare.text);
+		if (pos == std::string::npos)
+		{
+			continue;
+		}
+
+		Chip8BreakCondition condition;
+		condition.compare = compare.compare;
+
+		const auto regName = str.substr(0, pos);
+		if (regName == "I") condition.reg = Chip8BreakRegister::I;
+		else if (regName == "DT") condition.reg = Chip8BreakRegister::DT;
+		else if (regName == "ST") condition.reg = Chip8BreakRegister::ST;
+		else if (regName == "SP") condition.reg = Chip8BreakRegister::SP;
+		else if (regName.size() == 2 && (regName[0] == 'V' || regName[0] == 'v') && std::isxdigit(static_cast<unsigned char>(regName[1])))
+		{
+			condition.reg = static_cast<Chip8BreakRegister>(std::strtoul(regName.c_str() + 1, nullptr, 16));
+		}
+		else
+		{
+			return false;
+		}
+
+		const auto valueStr = str.substr(pos + std::strlen(compare.text));
+		char* valueEnd;
+		const auto value = std::strtoul(valueStr.c_str(), &valueEnd, 0);
+		if (valueStr.empty() || *valueEnd != '\0' || value > 0xFFFF)
+		{
+			return false;
+		}
+
+		condition.value = static_cast<u16>(value);
+		if (outCondition != nullptr)
+		{
+			*outCondition = condition;
+		}
+		return true;
+	}
+
+	return false;
+}
\ No newline at end of file
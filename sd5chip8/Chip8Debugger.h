@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8Types.h"
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+struct Chip8CPURegisters;
+
+/**
+* The registers a break condition can test.
+*/
+enum class Chip8BreakRegister : u8
+{
+	V0 = 0, V1, V2, V3, V4, V5, V6, V7, V8, V9, VA, VB, VC, VD, VE, VF,
+	I,
+	DT,
+	ST,
+	SP
+};
+
+
+/**
+* How a break condition compares its register.
+*/
+enum class Chip8BreakCompare : u8
+{
+	Equal,
+	NotEqual,
+	Less,
+	Greater
+};
+
+
+/**
+* Breaks when a register comparison becomes true.
+*/
+struct Chip8BreakCondition
+{
+	Chip8BreakRegister reg;
+	Chip8BreakCompare compare;
+	u16 value;
+};
+
+
+/**
+* Breakpoints, watchpoints, break conditions and stepping for a Chip8CPU.
+*
+* The CPU only runs its instrumented loop, which checks before every instruction, while the debugger is
+* active - with nothing to break on and nothing to step, frames run on the normal loop without any checks.
+* Watchpoints are checked against the memory each instruction is about to read or write at I, as decoded
+* from the instruction, so memory accesses themselves aren't slowed down either.
+*/
+class Chip8Debugger
+{
+public:
+	Chip8Debugger();
+	~Chip8Debugger();
+
+	/**
+	* Sets a breakpoint on the instruction at the specified address.
+	*/
+	void AddBreakpoint(u16 address);
+
+	/**
+	* Removes the breakpoint at the specified address.
+	*/
+	void RemoveBreakpoint(u16 address);
+
+	/**
+	* Sets or removes the breakpoint at the specified address.
+	* Returns true if a breakpoint was set, false if one was removed.
+	*/
+	bool ToggleBreakpoint(u16 address);
+
+	/**
+	* Returns whether or not there is a breakpoint at the specified address.
+	*/
+	bool HasBreakpoint(u16 address) const;
+
+	/**
+	* Watches size bytes of memory from the specified address for reads and/or writes (CHIP8_OP_MEMORY_READ / WRITE).
+	*/
+	void AddWatchpoint(u16 address, u16 size, u8 access);
+
+	/**
+	* Stops watching size bytes of memory from the specified address for reads and/or writes (CHIP8_OP_MEMORY_READ / WRITE).
+	*/
+	void RemoveWatchpoint(u16 address, u16 size, u8 access);
+
+	/**
+	* Gets which accesses (CHIP8_OP_MEMORY_READ / WRITE) to the byte at the specified address are watched.
+	*/
+	u8 GetWatchpointAccess(u16 address) const;
+
+	/**
+	* Adds a condition to break on when it becomes true.
+	*/
+	void AddCondition(const Chip8BreakCondition& condition);
+
+	/**
+	* Removes all breakpoints, watchpoints and break conditions.
+	*/
+	void ClearAll();
+
+	/**
+	* Pauses before the next instruction.
+	*/
+	void Pause();
+
+	/**
+	* Carries on running until something is hit.
+	*/
+	void Continue();
+
+	/**
+	* Runs one instruction.
+	*/
+	void StepInto();
+
+	/**
+	* Runs one instruction, or a whole subroutine if the instruction is a CALL.
+	*/
+	void StepOver();
+
+	/**
+	* Runs until the current subroutine returns.
+	*/
+	void StepOut();
+
+	/**
+	* Returns whether or not execution is paused.
+	*/
+	bool IsPaused() const;
+
+	/**
+	* Gets why execution last paused.
+	*/
+	const std::string& GetBreakReason() const;
+
+	/**
+	* Returns whether or not the CPU has to check with the debugger before each instruction.
+	*/
+	bool IsActive() const;
+
+	/**
+	* Called by the CPU before it executes an instruction.
+	* Returns true if execution should pause before it, false otherwise.
+	*/
+	bool CheckBeforeStep(const Chip8CPURegisters& reg, u16 op);
+
+	/**
+	* Called by the CPU after it has executed an instruction.
+	*/
+	void OnAfterStep(const Chip8CPURegisters& reg);
+
+	/**
+	* Parses a break condition such as "V3==0x10", "I>0x400" or "DT!=0" (registers V0-VF, I, DT, ST or SP; ==, !=, < or >).
+	* Returns true on success, false if the string isn't a valid condition.
+	*/
+	static bool ParseCondition(const std::string& str, Chip8BreakCondition* outCondition);
+
+private:
+	enum class StepMode : u8
+	{
+		None,
+		Into,
+		Over,
+		Out
+	};
+
+	std::bitset<CHIP8_MEMORY_SIZE> breakpoints_, readWatches_, writeWatches_;
+	bool hasWatches_;
+	std::vector<Chip8BreakCondition> conditions_;
+	std::vector<bool> conditionStates_;
+
+	bool isPaused_;
+	bool isPauseRequested_;
+	bool isResuming_;
+	StepMode stepMode_;
+	bool hasStepped_;
+	u8 stepStartSP_;
+	std::string breakReason_;
+
+	/**
+	* Pauses execution for a reason.
+	*/
+	void Break(const std::string& reason);
+
+	/**
+	* Starts running again, without breaking on the instruction execution paused before.
+	*/
+	void Resume(StepMode mode);
+};
\ No newline at end of file
@@ -0,0 +1,433 @@
+#include "Chip8Disassembler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+
+namespace
+{
+	// Data bytes listed per line.
+	const size_t dataBytesPerLine = 8;
+
+	/**
+	* Returns the name of an edge type.
+	*/
+	const char* GetEdgeTypeName(Chip8EdgeType type)
+	{
+		switch (type)
+		{
+		case Chip8EdgeType::Fallthrough: return "fallthrough";
+		case Chip8EdgeType::Jump: return "jump";
+		case Chip8EdgeType::Skip: return "skip";
+		case Chip8EdgeType::Call: return "call";
+		default: return "?";
+		}
+	}
+
+	/**
+	* Returns an address formatted as it is in listings.
+	*/
+	std::string FormatAddress(u16 address)
+	{
+		std::ostringstream oss;
+		oss << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(3) << address;
+		return oss.str();
+	}
+}
+
+
+std::string Chip8Disassembler::FormatInstruction(u16 op)
+{
+	const auto& info = Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(op));
+
+	std::ostringstream oss;
+	oss << std::hex << std::uppercase << info.mnemonic;
+	if (info.operandFormat[0] != '\0')
+	{
+		oss << ' ';
+	}
+
+	for (auto p = info.operandFormat; *p != '\0'; ++p)
+	{
+		if (*p != '%' || p[1] == '\0')
+		{
+			oss << *p;
+			continue;
+		}
+
+		switch (*++p)
+		{
+		case 'x': oss << 'V' << ((op & 0x0F00) >> 8); break;
+		case 'y': oss << 'V' << ((op & 0x00F0) >> 4); break;
+		case 'n': oss << std::dec << (op & 0x000F) << std::hex; break;
+		case 'b': oss << "0x" << std::setfill('0') << std::setw(2) << (op & 0x00FF); break;
+		case 'a': oss << FormatAddress(op & 0x0FFF); break;
+		default: oss << '%' << *p; break;
+		}
+	}
+
+	if (info.flow == CHIP8_OP_FLOW_STOP)
+	{
+		oss << " (0x" << std::setfill('0') << std::setw(4) << op << ')';
+	}
+
+	return oss.str();
+}
+
+
+u16 Chip8Disassembler::GetJumpTarget(u16 address, u16 op)
+{
+	// Matches the hires check in the CPU.
+	if (address == CHIP8_PROGRAM_START && (op & 0x0FFF) == 0x260)
+	{
+		return CHIP8_PROGRAM_HIRES_START;
+	}
+
+	return (op & 0x0FFF);
+}
+
+
+Chip8ControlFlowGraph::Chip8ControlFlowGraph() :
+loadAddress_(0)
+{
+}
+
+
+Chip8ControlFlowGraph::~Chip8ControlFlowGraph()
+{
+}
+
+
+bool Chip8ControlFlowGraph::Build(const u8* data, size_t size, u16 loadAddress, const std::vector<u16>& entryAddresses)
+{
+	Clear();
+	if (loadAddress > CHIP8_MEMORY_SIZE || size > static_cast<size_t>(CHIP8_MEMORY_SIZE - loadAddress))
+	{
+		return false;
+	}
+
+	image_.assign(data, data + size);
+	loadAddress_ = loadAddress;
+
+	for (const auto entryAddress : entryAddresses)
+	{
+		if (!IsInProgram(entryAddress))
+		{
+			Clear();
+			return false;
+		}
+
+		isEntry_[entryAddress] = true;
+		isLeader_[entryAddress] = true;
+	}
+
+	for (const auto entryAddress : entryAddresses)
+	{
+		Trace(entryAddress);
+	}
+
+	BuildBlocks();
+	return true;
+}
+
+
+void Chip8ControlFlowGraph::Clear()
+{
+	image_.clear();
+	loadAddress_ = 0;
+	blocks_.clear();
+	isInstructionStart_.reset();
+	isCode_.reset();
+	isLeader_.reset();
+	isEntry_.reset();
+	isCallTarget_.reset();
+}
+
+
+bool Chip8ControlFlowGraph::IsInProgram(u16 address) const
+{
+	return address >= loadAddress_ && static_cast<size_t>(address - loadAddress_) + 2 <= image_.size();
+}
+
+
+void Chip8ControlFlowGraph::Trace(u16 entryAddress)
+{
+	std::vector<u16> pending(1, entryAddress);
+	while (!pending.empty())
+	{
+		auto addr = pending.back();
+		pending.pop_back();
+
+		// Follow the code until it leaves by a branch, or runs into code that's already traced or into data.
+		while (IsInProgram(addr) && !isInstructionStart_[addr] && !isCode_[addr] && !isCode_[addr + 1])
+		{
+			u16 op;
+			GetOpcode(addr, &op);
+			const auto& info = Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(op));
+			if (info.flow == CHIP8_OP_FLOW_STOP)
+			{
+				break;
+			}
+
+			isInstructionStart_[addr] = true;
+			isCode_[addr] = isCode_[addr + 1] = true;
+
+			const u16 next = addr + 2;
+			if (info.flow == CHIP8_OP_FLOW_JUMP || info.flow == CHIP8_OP_FLOW_CALL)
+			{
+				const auto target = Chip8Disassembler::GetJumpTarget(addr, op);
+				if (IsInProgram(target))
+				{
+					isLeader_[target] = true;
+					isCallTarget_[target] = isCallTarget_[target] || (info.flow == CHIP8_OP_FLOW_CALL);
+					pending.push_back(target);
+				}
+
+				if (info.flow == CHIP8_OP_FLOW_JUMP)
+				{
+					break;
+				}
+
+				// Execution carries on at the return site in a new block.
+				if (IsInProgram(next))
+				{
+					isLeader_[next] = true;
+				}
+			}
+			else if (info.flow == CHIP8_OP_FLOW_SKIP)
+			{
+				if (IsInProgram(next))
+				{
+					isLeader_[next] = true;
+				}
+
+				const u16 skipped = addr + 4;
+				if (IsInProgram(skipped))
+				{
+					isLeader_[skipped] = true;
+					pending.push_back(skipped);
+				}
+			}
+			else if (info.flow != CHIP8_OP_FLOW_NEXT)
+			{
+				// Return or an indirect jump - nowhere to follow.
+				break;
+			}
+
+			addr = next;
+		}
+	}
+}
+
+
+void Chip8ControlFlowGraph::BuildBlocks()
+{
+	const auto programEnd = loadAddress_ + image_.size();
+	Chip8BasicBlock* block = nullptr;
+	for (u16 addr = loadAddress_; addr < programEnd; ++addr)
+	{
+		if (!isInstructionStart_[addr])
+		{
+			continue;
+		}
+
+		// Start a new block at leaders, and wherever the last one was cut off.
+		if (block == nullptr || isLeader_[addr] || block->end != addr)
+		{
+			blocks_.push_back(Chip8BasicBlock{ addr, addr, 0, isEntry_[addr], isCallTarget_[addr], {} });
+			block = &blocks_.back();
+		}
+
+		GetOpcode(addr, &block->lastOp);
+		block->end = addr + 2;
+
+		if (Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(block->lastOp)).flow != CHIP8_OP_FLOW_NEXT)
+		{
+			block = nullptr;
+		}
+	}
+
+	// Link the blocks up by how their last instruction leaves them.
+	for (auto& b : blocks_)
+	{
+		const auto lastAddress = static_cast<u16>(b.end - 2);
+		const auto flow = Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(b.lastOp)).flow;
+		const auto addEdge = [this, &b](u16 target, Chip8EdgeType type) {
+			if (IsInProgram(target) && isInstructionStart_[target])
+			{
+				b.successors.push_back(Chip8BlockEdge{ target, type });
+			}
+		};
+
+		switch (flow)
+		{
+		case CHIP8_OP_FLOW_NEXT:
+			addEdge(b.end, Chip8EdgeType::Fallthrough);
+			break;
+		case CHIP8_OP_FLOW_JUMP:
+			addEdge(Chip8Disassembler::GetJumpTarget(lastAddress, b.lastOp), Chip8EdgeType::Jump);
+			break;
+		case CHIP8_OP_FLOW_CALL:
+			addEdge(Chip8Disassembler::GetJumpTarget(lastAddress, b.lastOp), Chip8EdgeType::Call);
+			addEdge(b.end, Chip8EdgeType::Fallthrough);
+			break;
+		case CHIP8_OP_FLOW_SKIP:
+			addEdge(b.end, Chip8EdgeType::Fallthrough);
+			addEdge(b.end + 2, Chip8EdgeType::Skip);
+			break;
+		}
+	}
+}
+
+
+const std::vector<Chip8BasicBlock>& Chip8ControlFlowGraph::GetBlocks() const
+{
+	return blocks_;
+}
+
+
+const Chip8BasicBlock* Chip8ControlFlowGraph::FindBlock(u16 address) const
+{
+	// Find the last block starting at or before the address.
+	const auto it = std::upper_bound(blocks_.begin(), blocks_.end(), address,
+		[](u16 addr, const Chip8BasicBlock& b) { return addr < b.start; });
+	if (it == blocks_.begin())
+	{
+		return nullptr;
+	}
+
+	const auto& b = *(it - 1);
+	return (address < b.end && IsInstructionStart(address) ? &b : nullptr);
+}
+
+
+bool Chip8ControlFlowGraph::IsInstructionStart(u16 address) const
+{
+	return address < CHIP8_MEMORY_SIZE && isInstructionStart_[address];
+}
+
+
+bool Chip8ControlFlowGraph::IsCode(u16 address) const
+{
+	return address < CHIP8_MEMORY_SIZE && isCode_[address];
+}
+
+
+bool Chip8ControlFlowGraph::GetOpcode(u16 address, u16* outOp) const
+{
+	if (!IsInProgram(address))
+	{
+		return false;
+	}
+
+	const auto offset = address - loadAddress_;
+	*outOp = (image_[offset] << 8) | image_[offset + 1];
+	return true;
+}
+
+
+size_t Chip8ControlFlowGraph::GetCodeSize() const
+{
+	return isCode_.count();
+}
+
+
+void Chip8ControlFlowGraph::WriteText(std::ostream& out) const
+{
+	out << "; " << blocks_.size() << " blocks, " << GetCodeSize() << " bytes of code, "
+		<< image_.size() - GetCodeSize() << " bytes of data" << std::endl;
+
+	const auto programEnd = loadAddress_ + image_.size();
+	auto blockIt = blocks_.begin();
+	u16 addr = loadAddress_;
+	while (addr < programEnd)
+	{
+		if (isInstructionStart_[addr])
+		{
+			// Blocks are listed whole, with a label and their successors.
+			const auto& b = *blockIt++;
+			out << std::endl << "block_" << FormatAddress(b.start) << ':';
+			if (b.isEntry || b.isCallTarget)
+			{
+				out << "\t\t; " << (b.isEntry ? "entry" : "") << (b.isEntry && b.isCallTarget ? ", " : "") << (b.isCallTarget ? "subroutine" : "");
+			}
+			out << std::endl;
+
+			for (; addr < b.end; addr += 2)
+			{
+				u16 op = 0;
+				if (!GetOpcode(addr, &op))
+				{
+					break;
+				}
+				out << "  " << FormatAddress(addr) << ": " << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << op << std::dec
+					<< "    " << Chip8Disassembler::FormatInstruction(op) << std::endl;
+			}
+
+			if (!b.successors.empty())
+			{
+				out << "  ; ->";
+				for (const auto& edge : b.successors)
+				{
+					out << ' ' << FormatAddress(edge.target) << " (" << GetEdgeTypeName(edge.type) << ')';
+				}
+				out << std::endl;
+			}
+			continue;
+		}
+
+		// List the data up to the next instruction.
+		out << std::endl;
+		while (addr < programEnd && !isInstructionStart_[addr])
+		{
+			out << "  " << FormatAddress(addr) << ": db";
+			for (size_t i = 0; i < dataBytesPerLine && addr < programEnd && !isInstructionStart_[addr]; ++i, ++addr)
+			{
+				out << (i == 0 ? " " : ", ") << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(2) << +image_[addr - loadAddress_] << std::dec;
+			}
+			out << std::endl;
+		}
+	}
+}
+
+
+void Chip8ControlFlowGraph::WriteDOT(std::ostream& out, const std::string& graphName) const
+{
+	out << "digraph \"" << graphName << "\" {" << std::endl
+		<< "\tnode [shape=box, fontname=\"monospace\"];" << std::endl;
+
+	for (const auto& b : blocks_)
+	{
+		out << "\t\"" << FormatAddress(b.start) << "\" [label=\"" << FormatAddress(b.start)
+			<< (b.isEntry ? " (entry)" : "") << (b.isCallTarget ? " (subroutine)" : "") << "\\l";
+		for (auto addr = b.start; addr < b.end; addr += 2)
+		{
+			u16 op = 0;
+			if (!GetOpcode(addr, &op))
+			{
+				break;
+			}
+			out << FormatAddress(addr) << ": " << Chip8Disassembler::FormatInstruction(op) << "\\l";
+		}
+		out << "\"" << (b.isEntry ? ", penwidth=2" : "") << "];" << std::endl;
+	}
+
+	for (const auto& b : blocks_)
+	{
+		for (const auto& edge : b.successors)
+		{
+			out << "\t\"" << FormatAddress(b.start) << "\" -> \"" << FormatAddress(edge.target) << "\"";
+			switch (edge.type)
+			{
+			case Chip8EdgeType::Call: out << " [style=dashed, label=\"call\"]"; break;
+			case Chip8EdgeType::Skip: out << " [label=\"skip\"]"; break;
+			case Chip8EdgeType::Jump: out << " [style=bold]"; break;
+			default: break;
+			}
+			out << ";" << std::endl;
+		}
+	}
+
+	out << "}" << std::endl;
+}
\ No newline at end of file
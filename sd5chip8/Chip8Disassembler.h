@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8Opcodes.h"
+#include "Chip8Types.h"
+
+#include <bitset>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+* How control gets from one basic block to another.
+*/
+enum class Chip8EdgeType : u8
+{
+	Fallthrough,	// Into the next block without a branch.
+	Jump,			// JP addr.
+	Skip,			// A skip instruction's condition was met.
+	Call			// CALL addr. The calling block also falls through to the return site.
+};
+
+
+/**
+* An edge in the control flow graph.
+*/
+struct Chip8BlockEdge
+{
+	u16 target;
+	Chip8EdgeType type;
+};
+
+
+/**
+* A run of instructions that is only ever entered at its first instruction and left after its last one.
+*/
+struct Chip8BasicBlock
+{
+	u16 start;	// Address of the first instruction.
+	u16 end;	// Address just after the last instruction.
+	u16 lastOp;
+	bool isEntry;
+	bool isCallTarget;
+	std::vector<Chip8BlockEdge> successors;
+
+	/**
+	* Gets the amount of instructions in the block.
+	*/
+	inline u16 GetInstructionCount() const { return (end - start) / 2; }
+};
+
+
+/**
+* The control flow graph of a program, found by recursive descent from its entry points.
+*
+* Only bytes reached as instructions along some path from an entry point are code - everything else is data.
+* Jumps through JP V0, addr can't be followed statically, so code only reached that way is seen as data
+* unless its address is given as another entry point.
+*
+* The block boundaries are the points a pre-decode cache or recompiler has to split at, so this is meant to be
+* used by those as well as for listings.
+*/
+class Chip8ControlFlowGraph
+{
+public:
+	Chip8ControlFlowGraph();
+	~Chip8ControlFlowGraph();
+
+	/**
+	* Builds the graph of a program loaded at loadAddress, following the code from each of the entry points.
+	* Returns true on success, false if the program doesn't fit in memory or an entry point is outside of it.
+	*/
+	bool Build(const u8* data, size_t size, u16 loadAddress, const std::vector<u16>& entryAddresses);
+
+	/**
+	* Empties the graph.
+	*/
+	void Clear();
+
+	/**
+	* Gets the basic blocks, sorted by address.
+	*/
+	const std::vector<Chip8BasicBlock>& GetBlocks() const;
+
+	/**
+	* Gets the block containing the instruction at the specified address, or null if there isn't one.
+	*/
+	const Chip8BasicBlock* FindBlock(u16 address) const;
+
+	/**
+	* Returns whether or not an instruction starts at the specified address.
+	*/
+	bool IsInstructionStart(u16 address) const;
+
+	/**
+	* Returns whether or not the byte at the specified address is part of an instruction.
+	*/
+	bool IsCode(u16 address) const;
+
+	/**
+	* Gets the opcode at the specified address of the program.
+	* Returns true on success, false if the address isn't in the program.
+	*/
+	bool GetOpcode(u16 address, u16* outOp) const;
+
+	/**
+	* Gets the amount of bytes of the program that are code.
+	*/
+	size_t GetCodeSize() const;
+
+	/**
+	* Writes a listing of the program - each block with its instructions and successors, and the data between them.
+	*/
+	void WriteText(std::ostream& out) const;
+
+	/**
+	* Writes the graph in the Graphviz DOT language.
+	*/
+	void WriteDOT(std::ostream& out, const std::string& graphName) const;
+
+private:
+	std::vector<u8> image_;
+	u16 loadAddress_;
+	std::vector<Chip8BasicBlock> blocks_;
+	std::bitset<CHIP8_MEMORY_SIZE> isInstructionStart_, isCode_, isLeader_, isEntry_, isCallTarget_;
+
+	/**
+	* Returns whether or not a whole instruction at the specified address is inside the program.
+	*/
+	bool IsInProgram(u16 address) const;
+
+	/**
+	* Follows the code from an entry point, marking instructions and the addresses that start blocks.
+	*/
+	void Trace(u16 entryAddress);
+
+	/**
+	* Groups the marked instructions into blocks and links them up.
+	*/
+	void BuildBlocks();
+};
+
+
+namespace Chip8Disassembler
+{
+	/**
+	* Formats an opcode as assembly, such as "LD V1, 0x05".
+	*/
+	std::string FormatInstruction(u16 op);
+
+	/**
+	* Gets the address an instruction at the specified address really jumps to.
+	* The CPU starts hires programs at 0x2C0 when they jump to 0x260 from 0x200.
+	*/
+	u16 GetJumpTarget(u16 address, u16 op);
+}
\ No newline at end of file
@@ -1,13 +1,34 @@
 #include "Chip8Display.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
-#include <SFML\Graphics\RectangleShape.hpp>
 
+namespace
+{
+	/**
+	* The byte per pixel form of every 8 pixels a row can hold, so CopyPixels() unpacks 8 at a time.
+	*/
+	struct Chip8PixelExpansionTable
+	{
+		u8 pixels[256][8];
+
+		Chip8PixelExpansionTable()
+		{
+			for (u16 bits = 0; bits < 256; ++bits)
+			{
+				for (u8 i = 0; i < 8; ++i)
+				{
+					pixels[bits][i] = ((bits >> (7 - i)) & 1);
+				}
+			}
+		}
+	};
+}
 
-Chip8Display::Chip8Display(const sf::Color& displayColor, const sf::Color& backColor, u8 w, u8 h) :
-displayColor_(displayColor),
-backColor_(backColor)
+
+Chip8Display::Chip8Display(u8 w, u8 h)
 {
 	Reset(w, h);
 }
@@ -20,89 +41,88 @@ Chip8Display::~Chip8Display()
 
 void Chip8Display::Reset(u8 w, u8 h)
 {
+	assert(w > 0 && w <= CHIP8_DISPLAY_MAX_WIDTH && h > 0 && h <= CHIP8_DISPLAY_MAX_HEIGHT);
+
 	// Initialize and clear the display
 	w_ = w;
 	h_ = h;
-	pix_ = std::unique_ptr<u8[]>(new u8[GetSize()]);
-	Clear();
+	// Shifting a u64 by 64 is undefined, so the full width is special cased.
+	rowMask_ = (w_ == CHIP8_DISPLAY_MAX_WIDTH ? ~0ULL : ~(~0ULL >> w_));
+
+	std::fill(rows_, rows_ + CHIP8_DISPLAY_MAX_HEIGHT, 0);
 }
 
 
 void Chip8Display::Clear()
 {
-	for (u16 i = 0; i < GetSize(); ++i)
-	{
-		pix_[i] = 0;
-	}
+	std::fill(rows_, rows_ + h_, 0);
 }
 
 
 void Chip8Display::Plot(u16 x, u16 y)
 {
-	// Toggle the pixel's on/off state by XORing against 1.
-	// % operator handles pixels wrapping around to the other end of the screen if off screen.
-	pix_[GetPos(x % w_, y % h_)] ^= 1;
-}
-
-
-u8 Chip8Display::GetPixelState(u16 x, u16 y)
-{
+	// Toggle the pixel's on/off state by XORing its bit.
 	// % operator handles pixels wrapping around to the other end of the screen if off screen.
-	return pix_[GetPos(x % w_, y % h_)];
+	rows_[y % h_] ^= GetColumnBit(x % w_);
 }
 
 
-void Chip8Display::Render(sf::RenderTarget& target)
+bool Chip8Display::DrawSpriteLine(u16 x, u16 y, u8 line)
 {
-	// Clear the screen to black.
-	target.clear(backColor_);
-	
-	// Calculate individual pixel size from size of target view
-	const auto pixWidth = target.getView().getSize().x / static_cast<float>(w_);
-	const auto pixHeight = target.getView().getSize().y / static_cast<float>(h_);
-
-	// Set the pixel color and size
-	sf::RectangleShape pixRect;
-	pixRect.setFillColor(displayColor_);
-	pixRect.setSize(sf::Vector2f(pixWidth, pixHeight));
-
-	// Draw active pixels.
-	for (u8 x = 0; x < w_; ++x)
+	x %= w_;
+	y %= h_;
+
+	// Line up the sprite's pixels with columns x to x + 7. Any of them that are past the right edge
+	// are shifted out of the row (or masked off for narrower displays), and shifted back in from the left.
+	const u64 spriteBits = (static_cast<u64>(line) << 56);
+	u64 bits = (spriteBits >> x) & rowMask_;
+	if (x + 8 > w_)
 	{
-		for (u8 y = 0; y < h_; ++y)
-		{
-			// If this pixel is on at this loc, draw it.
-			if (pix_[GetPos(x, y)] != 0)
-			{
-				pixRect.setPosition(sf::Vector2f(x * pixWidth, y * pixHeight));
-				target.draw(pixRect);
-			}
-		}
+		bits |= (spriteBits << (w_ - x));
 	}
+
+	const bool isColliding = ((rows_[y] & bits) != 0);
+	rows_[y] ^= bits;
+	return isColliding;
 }
 
 
-void Chip8Display::SetDisplayColor(const sf::Color& color) 
-{ 
-	displayColor_ = color; 
+u8 Chip8Display::GetPixelState(u16 x, u16 y) const
+{
+	// % operator handles pixels wrapping around to the other end of the screen if off screen.
+	return ((rows_[y % h_] & GetColumnBit(x % w_)) != 0 ? 1 : 0);
 }
 
 
-sf::Color Chip8Display::GetDisplayColor() const 
-{ 
-	return displayColor_; 
+void Chip8Display::SetRows(const u64* rows)
+{
+	for (u8 y = 0; y < CHIP8_DISPLAY_MAX_HEIGHT; ++y)
+	{
+		rows_[y] = (y < h_ ? rows[y] & rowMask_ : 0);
+	}
 }
 
 
-void Chip8Display::SetBackgroundColor(const sf::Color& color) 
-{ 
-	backColor_ = color; 
-}
+void Chip8Display::CopyPixels(u8* outPixels) const
+{
+	static const Chip8PixelExpansionTable expansion;
 
+	for (u8 y = 0; y < h_; ++y)
+	{
+		const auto row = rows_[y];
+		u8 x = 0;
+		for (; x + 8 <= w_; x += 8)
+		{
+			std::memcpy(outPixels, expansion.pixels[(row >> (56 - x)) & 0xFF], 8);
+			outPixels += 8;
+		}
 
-sf::Color Chip8Display::GetBackgroundColor() const 
-{ 
-	return backColor_; 
+		// Displays whose width isn't a multiple of 8 finish their rows a pixel at a time.
+		for (; x < w_; ++x)
+		{
+			*outPixels++ = ((row & GetColumnBit(x)) != 0 ? 1 : 0);
+		}
+	}
 }
 
 
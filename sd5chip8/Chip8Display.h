@@ -3,27 +3,22 @@
 #include "Chip8Constants.h"
 #include "Chip8Types.h"
 
-#include <SFML\Graphics\RenderTarget.hpp>
-#include <SFML\Graphics\Color.hpp>
-
-#include <memory>
-
 /**
 * Represents the screen in use by a Chip-8 program.
+* It only holds the state of the pixels - drawing them is left to a Chip8VideoBackend.
+*
+* Each row is packed into the bits of a u64, with the leftmost pixel in the most significant bit,
+* so a sprite line is drawn with a shift and an XOR and the whole display fits in a handful of cache lines.
 */
 class Chip8Display
 {
 public:
-	Chip8Display(
-		const sf::Color& displayColor = sf::Color(255, 255, 255),
-		const sf::Color& backColor = sf::Color(0, 0, 0),
-		u8 w = CHIP8_DISPLAY_WIDTH,
-		u8 h = CHIP8_DISPLAY_HEIGHT
-		);
+	Chip8Display(u8 w = CHIP8_DISPLAY_WIDTH, u8 h = CHIP8_DISPLAY_HEIGHT);
 	~Chip8Display();
 
 	/**
 	*  Changes the size of the display and clears it.
+	*  The display can be at most CHIP8_DISPLAY_MAX_WIDTH by CHIP8_DISPLAY_MAX_HEIGHT pixels.
 	*/
 	void Reset(u8 w, u8 h);
 
@@ -40,34 +35,36 @@ public:
 	void Plot(u16 x, u16 y);
 
 	/**
-	* Returns the state of the pixel at co-ords (x, y)
+	* XORs an 8 pixel wide sprite line (leftmost pixel in the most significant bit) onto the display at co-ords (x, y).
+	* Like Plot(), pixels off the right or bottom of the screen are drawn on the opposite side of it.
+	* Returns true if any pixel that was on got turned off (a collision).
 	*/
-	u8 GetPixelState(u16 x, u16 y);
+	bool DrawSpriteLine(u16 x, u16 y, u8 line);
 
 	/**
-	* Renders the display to a render target.
+	* Returns the state of the pixel at co-ords (x, y)
 	*/
-	void Render(sf::RenderTarget& target);
+	u8 GetPixelState(u16 x, u16 y) const;
 
 	/**
-	* Set the color of the display foreground.
+	* Gets row y of the display, packed as described above. Bits past the width of the display are always 0.
 	*/
-	void SetDisplayColor(const sf::Color& color);
+	inline u64 GetRow(u8 y) const { return rows_[y]; }
 
 	/**
-	* Gets the current color of the display foreground.
+	* Gets every row of the display (CHIP8_DISPLAY_MAX_HEIGHT of them, the ones past the height are always 0).
 	*/
-	sf::Color GetDisplayColor() const;
+	inline const u64* GetRows() const { return rows_; }
 
 	/**
-	* Set the color of the display background.
+	* Overwrites every row of the display with CHIP8_DISPLAY_MAX_HEIGHT rows laid out as GetRows() returns them.
 	*/
-	void SetBackgroundColor(const sf::Color& color);
+	void SetRows(const u64* rows);
 
 	/**
-	* Get the current color of the display background.
+	* Copies the state of every pixel into GetSize() bytes, row by row, with each byte 1 if its pixel is on or 0 if not.
 	*/
-	sf::Color GetBackgroundColor() const;
+	void CopyPixels(u8* outPixels) const;
 
 	/**
 	* Get the width of the display in pixels.
@@ -86,13 +83,11 @@ public:
 
 private:
 	u8 w_, h_;
-	std::unique_ptr<u8[]> pix_;
-
-	sf::Color displayColor_, backColor_;
+	u64 rowMask_; // Bits of a row that are within the width of the display.
+	u64 rows_[CHIP8_DISPLAY_MAX_HEIGHT];
 
 	/**
-	* Gets index from pixel co-ords.
+	* Gets the bit of a row that holds the pixel in column x.
 	*/
-	inline u16 GetPos(u8 x, u8 y) const { return (x + (y * w_)); }
-};
-
+	static inline u64 GetColumnBit(u8 x) { return (1ULL << (63 - x)); }
+};
\ No newline at end of file
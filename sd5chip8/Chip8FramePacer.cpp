@@ -0,0 +1,177 @@
+#include "Chip8FramePacer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+
+Chip8FramePacer::Chip8FramePacer(std::chrono::microseconds framePeriod, std::chrono::microseconds spinThreshold, size_t maxSamples) :
+period_(framePeriod),
+spinThreshold_(spinThreshold),
+maxSamples_(std::max<size_t>(maxSamples, 1))
+{
+	samples_.reserve(maxSamples_);
+	Reset();
+}
+
+
+Chip8FramePacer::~Chip8FramePacer()
+{
+}
+
+
+void Chip8FramePacer::Reset()
+{
+	isScheduleStarted_ = false;
+	samples_.clear();
+	nextSampleIdx_ = 0;
+}
+
+
+void Chip8FramePacer::Resync()
+{
+	isScheduleStarted_ = false;
+}
+
+
+void Chip8FramePacer::WaitForNextFrame()
+{
+	if (!isScheduleStarted_)
+	{
+		// First frame - start the schedule from now.
+		lastFrameTime_ = Clock::now();
+		nextDeadline_ = lastFrameTime_ + period_;
+		isScheduleStarted_ = true;
+		return;
+	}
+
+	// Sleep for the bulk of the wait, leaving a margin for the OS scheduler to wake us up late.
+	auto now = Clock::now();
+	if (nextDeadline_ - now > spinThreshold_)
+	{
+		std::this_thread::sleep_until(nextDeadline_ - spinThreshold_);
+	}
+
+	// Yield for the final stretch until the deadline.
+	while ((now = Clock::now()) < nextDeadline_)
+	{
+		std::this_thread::yield();
+	}
+
+	RecordSample(now - lastFrameTime_, now - nextDeadline_);
+	lastFrameTime_ = now;
+
+	// Advance the deadline by exactly one period so that lateness in one frame doesn't drift the schedule.
+	// If we're already past the next deadline too (a long stall), resync instead of running frames back-to-back.
+	nextDeadline_ += period_;
+	if (nextDeadline_ <= now)
+	{
+		nextDeadline_ = now + period_;
+	}
+}
+
+
+void Chip8FramePacer::RecordSample(Clock::duration frameTime, Clock::duration overshoot)
+{
+	typedef std::chrono::duration<float, std::micro> FloatMicroseconds;
+
+	Sample sample;
+	sample.frameTime = std::chrono::duration_cast<FloatMicroseconds>(frameTime).count();
+	sample.overshoot = std::chrono::duration_cast<FloatMicroseconds>(overshoot).count();
+
+	if (samples_.size() < maxSamples_)
+	{
+		samples_.push_back(sample);
+	}
+	else
+	{
+		samples_[nextSampleIdx_] = sample;
+	}
+
+	nextSampleIdx_ = (nextSampleIdx_ + 1) % maxSamples_;
+}
+
+
+Chip8FrameStats Chip8FramePacer::GetStats() const
+{
+	Chip8FrameStats stats = {};
+	stats.sampleCount = samples_.size();
+	if (samples_.empty())
+	{
+		return stats;
+	}
+
+	std::vector<float> frameTimes, overshoots;
+	frameTimes.reserve(samples_.size());
+	overshoots.reserve(samples_.size());
+	for (const auto& sample : samples_)
+	{
+		frameTimes.push_back(sample.frameTime);
+		overshoots.push_back(sample.overshoot);
+	}
+
+	// Calculates the min, average and 99th percentile of a set of values.
+	const auto calcStats = [](std::vector<float>& vals, double* outMin, double* outAvg, double* outP99)
+	{
+		double sum = 0.0;
+		for (const auto val : vals)
+		{
+			sum += val;
+		}
+
+		*outMin = *std::min_element(vals.begin(), vals.end());
+		*outAvg = sum / vals.size();
+
+		const auto p99Idx = ((vals.size() - 1) * 99) / 100;
+		std::nth_element(vals.begin(), vals.begin() + p99Idx, vals.end());
+		*outP99 = vals[p99Idx];
+	};
+
+	calcStats(frameTimes, &stats.minFrameTime, &stats.avgFrameTime, &stats.p99FrameTime);
+	calcStats(overshoots, &stats.minOvershoot, &stats.avgOvershoot, &stats.p99Overshoot);
+	return stats;
+}
+
+
+bool Chip8FramePacer::WriteStatsCSV(const std::string& fileName) const
+{
+	auto file = std::ofstream(fileName);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const auto stats = GetStats();
+	file << "metric,samples,min_us,avg_us,p99_us" << std::endl
+		<< "frame_time," << stats.sampleCount << "," << stats.minFrameTime << "," << stats.avgFrameTime << "," << stats.p99FrameTime << std::endl
+		<< "overshoot," << stats.sampleCount << "," << stats.minOvershoot << "," << stats.avgOvershoot << "," << stats.p99Overshoot << std::endl;
+	return file.good();
+}
+
+
+bool Chip8FramePacer::WriteSamplesCSV(const std::string& fileName) const
+{
+	auto file = std::ofstream(fileName);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file << "frame,frame_time_us,overshoot_us" << std::endl;
+
+	// Once the buffer is full the oldest sample is the one about to be overwritten next.
+	const auto firstIdx = (samples_.size() < maxSamples_ ? 0 : nextSampleIdx_);
+	for (size_t i = 0; i < samples_.size(); ++i)
+	{
+		const auto& sample = samples_[(firstIdx + i) % samples_.size()];
+		file << i << "," << sample.frameTime << "," << sample.overshoot << std::endl;
+	}
+
+	return file.good();
+}
+
+
+std::chrono::microseconds Chip8FramePacer::GetFramePeriod() const
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(period_);
+}
\ No newline at end of file
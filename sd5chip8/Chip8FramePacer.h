@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Chip8Constants.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+* POD struct that contains a summary of the frame timing samples recorded by a Chip8FramePacer.
+* All times are in microseconds.
+*/
+struct Chip8FrameStats
+{
+	size_t sampleCount; // The amount of frames that the stats were calculated from
+
+	/* Time between the starts of two consecutive frames */
+	double minFrameTime;
+	double avgFrameTime;
+	double p99FrameTime;
+
+	/* How late the pacer woke up compared to the frame's scheduled deadline */
+	double minOvershoot;
+	double avgOvershoot;
+	double p99Overshoot;
+};
+
+
+/**
+* Paces frames against an absolute schedule.
+* Sleeps coarsely until shortly before each deadline and then yields for the final stretch, as sleeping
+* alone can overshoot the deadline by up to a millisecond on some platforms.
+*/
+class Chip8FramePacer
+{
+public:
+	Chip8FramePacer(
+		std::chrono::microseconds framePeriod = std::chrono::microseconds(CHIP8_FRAME_SLEEP_MICROSECONDS),
+		std::chrono::microseconds spinThreshold = std::chrono::microseconds(CHIP8_FRAME_PACER_SPIN_MICROSECONDS),
+		size_t maxSamples = CHIP8_FRAME_PACER_STATS_SAMPLES
+		);
+	~Chip8FramePacer();
+
+	/**
+	* Restarts the schedule from the next call to WaitForNextFrame and discards all recorded samples.
+	*/
+	void Reset();
+
+	/**
+	* Restarts the schedule from the next call to WaitForNextFrame, keeping the recorded samples.
+	* Should be used after deliberately not running frames for a while, so the gap isn't recorded as a stall.
+	*/
+	void Resync();
+
+	/**
+	* Blocks until the next frame is due and records its timing.
+	* If the schedule has fallen more than a frame behind, it is moved forward rather than rushing to catch up.
+	*/
+	void WaitForNextFrame();
+
+	/**
+	* Calculates the stats from the most recently recorded frames.
+	*/
+	Chip8FrameStats GetStats() const;
+
+	/**
+	* Writes the stats to a CSV file.
+	* Returns true on success, false on failure.
+	*/
+	bool WriteStatsCSV(const std::string& fileName) const;
+
+	/**
+	* Writes every recorded frame's timing to a CSV file, oldest first.
+	* Returns true on success, false on failure.
+	*/
+	bool WriteSamplesCSV(const std::string& fileName) const;
+
+	/**
+	* Gets the time between each frame.
+	*/
+	std::chrono::microseconds GetFramePeriod() const;
+
+private:
+	// Use a monotonic clock, the system clock may jump around.
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	* The timing of a single frame in microseconds.
+	*/
+	struct Sample
+	{
+		float frameTime;
+		float overshoot;
+	};
+
+	const Clock::duration period_, spinThreshold_;
+	const size_t maxSamples_;
+
+	bool isScheduleStarted_;
+	Clock::time_point nextDeadline_;
+	Clock::time_point lastFrameTime_;
+
+	std::vector<Sample> samples_;
+	size_t nextSampleIdx_;
+
+	/**
+	* Records a sample, overwriting the oldest one if full.
+	*/
+	void RecordSample(Clock::duration frameTime, Clock::duration overshoot);
+};
\ No newline at end of file
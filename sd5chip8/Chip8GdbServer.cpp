@@ -0,0 +1,919 @@
+#include "Chip8GdbServer.h"
+
+#include "Chip8Debugger.h"
+#include "Chip8Opcodes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+#ifdef _WIN32
+	typedef SOCKET NativeSocket;
+#else
+	typedef int NativeSocket;
+#endif
+
+	const intptr_t invalidSocket = -1;
+
+	// Register numbers, in the order of the g packet and target.xml.
+	const unsigned int registerI = 16;
+	const unsigned int registerPC = 17;
+	const unsigned int registerSP = 18;
+	const unsigned int registerDT = 19;
+	const unsigned int registerST = 20;
+	const unsigned int registerCount = 21;
+
+	const char targetXml[] =
+		"<?xml version=\"1.0\"?>"
+		"<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+		"<target version=\"1.0\">"
+		"<feature name=\"org.sd5chip8.cpu\">"
+		"<reg name=\"v0\" bitsize=\"8\" type=\"uint8\"/><reg name=\"v1\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"v2\" bitsize=\"8\" type=\"uint8\"/><reg name=\"v3\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"v4\" bitsize=\"8\" type=\"uint8\"/><reg name=\"v5\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"v6\" bitsize=\"8\" type=\"uint8\"/><reg name=\"v7\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"v8\" bitsize=\"8\" type=\"uint8\"/><reg name=\"v9\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"va\" bitsize=\"8\" type=\"uint8\"/><reg name=\"vb\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"vc\" bitsize=\"8\" type=\"uint8\"/><reg name=\"vd\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"ve\" bitsize=\"8\" type=\"uint8\"/><reg name=\"vf\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"i\" bitsize=\"16\" type=\"data_ptr\"/>"
+		"<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+		"<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"dt\" bitsize=\"8\" type=\"uint8\"/>"
+		"<reg name=\"st\" bitsize=\"8\" type=\"uint8\"/>"
+		"</feature>"
+		"</target>";
+
+
+	void AppendHex(std::string& str, u32 val, unsigned int bytes)
+	{
+		// Little-endian, as GDB expects register values.
+		static const char digits[] = "0123456789abcdef";
+		for (unsigned int i = 0; i < bytes; ++i)
+		{
+			const u8 byte = (val >> (i * 8)) & 0xFF;
+			str += digits[byte >> 4];
+			str += digits[byte & 0xF];
+		}
+	}
+
+
+	int HexDigitValue(char c)
+	{
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+
+	/**
+	* Parses little-endian hex bytes from str at pos, advancing pos.
+	* Returns true on success, false if there weren't enough valid digits.
+	*/
+	bool ParseHex(const std::string& str, size_t& pos, unsigned int bytes, u32* outVal)
+	{
+		if (pos + bytes * 2 > str.size())
+		{
+			return false;
+		}
+
+		u32 val = 0;
+		for (unsigned int i = 0; i < bytes; ++i)
+		{
+			const auto hi = HexDigitValue(str[pos + i * 2]);
+			const auto lo = HexDigitValue(str[pos + i * 2 + 1]);
+			if (hi < 0 || lo < 0)
+			{
+				return false;
+			}
+
+			val |= static_cast<u32>((hi << 4) | lo) << (i * 8);
+		}
+
+		pos += bytes * 2;
+		*outVal = val;
+		return true;
+	}
+
+
+	unsigned int GetRegisterSize(unsigned int reg)
+	{
+		return (reg == registerI || reg == registerPC ? 2 : 1);
+	}
+
+
+	u32 GetRegister(const Chip8CPURegisters& regs, unsigned int reg)
+	{
+		switch (reg)
+		{
+		case registerI: return regs.I;
+		case registerPC: return regs.PC;
+		case registerSP: return regs.SP;
+		case registerDT: return regs.DT;
+		case registerST: return regs.ST;
+		default: return regs.V[reg & 0xF];
+		}
+	}
+
+
+	void SetRegister(Chip8CPURegisters& regs, unsigned int reg, u32 val)
+	{
+		switch (reg)
+		{
+		case registerI: regs.I = static_cast<u16>(val); break;
+		case registerPC: regs.PC = static_cast<u16>(val); break;
+		case registerSP: regs.SP = static_cast<u8>(val); break;
+		case registerDT: regs.DT = static_cast<u8>(val); break;
+		case registerST: regs.ST = static_cast<u8>(val); break;
+		default: regs.V[reg & 0xF] = static_cast<u8>(val); break;
+		}
+	}
+
+
+	/**
+	* Parses "addr,len" (hex) from the packet at pos, advancing pos past it.
+	*/
+	bool ParseAddressLength(const std::string& packet, size_t& pos, u32* outAddress, u32* outLength)
+	{
+		char* end;
+		*outAddress = std::strtoul(packet.c_str() + pos, &end, 16);
+		if (*end != ',')
+		{
+			return false;
+		}
+
+		const auto lengthStart = end + 1;
+		*outLength = std::strtoul(lengthStart, &end, 16);
+		if (end == lengthStart)
+		{
+			return false;
+		}
+
+		pos = end - packet.c_str();
+		return true;
+	}
+
+
+	bool WaitUntilReadable(intptr_t socket)
+	{
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		FD_SET(static_cast<NativeSocket>(socket), &readSet);
+
+		timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = CHIP8_GDB_POLL_MILLISECONDS * 1000;
+		return (select(static_cast<int>(socket + 1), &readSet, nullptr, nullptr, &timeout) > 0);
+	}
+}
+
+
+Chip8GdbServer::Chip8GdbServer() :
+isRunning_(false),
+isStopping_(false),
+isClientAttached_(false),
+listenSocket_(invalidSocket),
+clientSocket_(invalidSocket),
+mailboxState_(MailboxEmpty),
+hasStopped_(false),
+isTargetRunning_(false),
+isNoAckMode_(false)
+{
+}
+
+
+Chip8GdbServer::~Chip8GdbServer()
+{
+	Stop();
+}
+
+
+bool Chip8GdbServer::Start(u16 port)
+{
+	Stop();
+
+#ifdef _WIN32
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		std::cerr << "Failed to start the GDB server - could not initialize Winsock." << std::endl;
+		return false;
+	}
+#endif
+
+	const auto listenSocket = static_cast<intptr_t>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+	if (listenSocket == invalidSocket)
+	{
+		std::cerr << "Failed to start the GDB server - could not create a socket." << std::endl;
+		return false;
+	}
+
+	const int reuseAddress = 1;
+	setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuseAddress), sizeof(reuseAddress));
+
+	// Only accept local clients.
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	if (bind(listenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listenSocket, 1) != 0)
+	{
+		std::cerr << "Failed to start the GDB server - could not listen on port " << port << "." << std::endl;
+		CloseSocket(listenSocket);
+		return false;
+	}
+
+	listenSocket_ = listenSocket;
+	isStopping_ = false;
+	isRunning_ = true;
+	thread_ = std::thread(&Chip8GdbServer::Run, this);
+
+	std::cout << "GDB server listening on localhost:" << port << "." << std::endl;
+	return true;
+}
+
+
+void Chip8GdbServer::Stop()
+{
+	if (!isRunning_)
+	{
+		return;
+	}
+
+	isStopping_ = true;
+	thread_.join();
+
+	// The emulation thread is here rather than polling, so any of the client's session that couldn't be undone
+	// is left for Poll() to finish - and any command that was waiting for it is dropped.
+	detachRequests_ = std::move(clientPoints_);
+	clientPoints_.clear();
+	mailboxState_ = MailboxEmpty;
+
+	CloseSocket(listenSocket_);
+	listenSocket_ = invalidSocket;
+	isRunning_ = false;
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+
+bool Chip8GdbServer::IsRunning() const
+{
+	return isRunning_;
+}
+
+
+bool Chip8GdbServer::IsClientAttached() const
+{
+	return isClientAttached_;
+}
+
+
+void Chip8GdbServer::Poll(Chip8CPU& cpu, Chip8Memory& ram)
+{
+	const auto debugger = cpu.GetDebugger();
+	if (debugger == nullptr)
+	{
+		return;
+	}
+
+	// Finish undoing a client's session cut short by Stop(), in the order DetachClient() would have.
+	while (!detachRequests_.empty())
+	{
+		HandleRequest(detachRequests_.back(), cpu, ram);
+		detachRequests_.pop_back();
+	}
+
+	// Report the target stopping to a client waiting for it.
+	if (isTargetRunning_ && debugger->IsPaused())
+	{
+		TakeSnapshot(cpu, ram);
+		isTargetRunning_ = false;
+		hasStopped_.store(true, std::memory_order_release);
+	}
+
+	if (mailboxState_.load(std::memory_order_acquire) == MailboxRequest)
+	{
+		HandleRequest(request_, cpu, ram);
+		mailboxState_.store(MailboxReply, std::memory_order_release);
+	}
+}
+
+
+void Chip8GdbServer::HandleRequest(Request& request, Chip8CPU& cpu, Chip8Memory& ram)
+{
+	auto& debugger = *cpu.GetDebugger();
+	request.isOK = true;
+
+	switch (request.command)
+	{
+	// Each of these is followed by exactly one stop, reported by Poll().
+	case Command::Halt:
+	case Command::Continue:
+	case Command::Step:
+		hasStopped_.store(false, std::memory_order_relaxed);
+		isTargetRunning_ = true;
+
+		if (request.command == Command::Halt)
+		{
+			debugger.Pause();
+		}
+		else if (request.command == Command::Continue)
+		{
+			debugger.Continue();
+		}
+		else
+		{
+			debugger.StepInto();
+		}
+		break;
+
+	// Points note what they add, so that removing them leaves alone any that were set from elsewhere first.
+	case Command::SetBreakpoint:
+		request.data.assign(1, debugger.HasBreakpoint(request.address) ? 0 : 1);
+		debugger.AddBreakpoint(request.address);
+		break;
+
+	case Command::RemoveBreakpoint:
+		if (!request.data.empty() && request.data[0] != 0)
+		{
+			debugger.RemoveBreakpoint(request.address);
+		}
+		break;
+
+	case Command::SetWatchpoint:
+		request.data.clear();
+		for (u32 addr = request.address; addr < static_cast<u32>(request.address) + request.size && addr < CHIP8_MEMORY_SIZE; ++addr)
+		{
+			request.data.push_back(request.access & ~debugger.GetWatchpointAccess(static_cast<u16>(addr)));
+		}
+		debugger.AddWatchpoint(request.address, request.size, request.access);
+		break;
+
+	case Command::RemoveWatchpoint:
+		for (size_t i = 0; i < request.data.size(); ++i)
+		{
+			debugger.RemoveWatchpoint(static_cast<u16>(request.address + i), 1, request.data[i]);
+		}
+		break;
+
+	case Command::WriteRegisters:
+		cpu.SetRegisters(request.registers);
+		break;
+
+	case Command::WriteMemory:
+		request.isOK = ram.WriteBlock(request.address, request.data.data(), request.size);
+		break;
+	}
+
+	// Keep the snapshot reads are answered from up to date.
+	if (!isTargetRunning_)
+	{
+		TakeSnapshot(cpu, ram);
+	}
+}
+
+
+void Chip8GdbServer::TakeSnapshot(const Chip8CPU& cpu, const Chip8Memory& ram)
+{
+	stopRegisters_ = cpu.GetRegisters();
+	stopMemory_.resize(ram.GetAllocatedSize());
+	ram.ReadBlock(0, stopMemory_.data(), static_cast<u16>(stopMemory_.size()));
+}
+
+
+void Chip8GdbServer::Run()
+{
+	while (!isStopping_)
+	{
+		if (!WaitUntilReadable(listenSocket_))
+		{
+			continue;
+		}
+
+		const auto clientSocket = static_cast<intptr_t>(accept(listenSocket_, nullptr, nullptr));
+		if (clientSocket == invalidSocket)
+		{
+			continue;
+		}
+
+		// Packets are small and answered one at a time, so don't let them wait to be coalesced.
+		const int noDelay = 1;
+		setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+		clientSocket_ = clientSocket;
+		isClientAttached_ = true;
+		std::cout << "GDB client attached." << std::endl;
+
+		ServeClient();
+		DetachClient();
+
+		CloseSocket(clientSocket_);
+		clientSocket_ = invalidSocket;
+		isClientAttached_ = false;
+		std::cout << "GDB client detached." << std::endl;
+	}
+}
+
+
+void Chip8GdbServer::ServeClient()
+{
+	receiveBuffer_.clear();
+	isNoAckMode_ = false;
+
+	// The client expects the target to be stopped once attached.
+	if (!SendCommand(Command::Halt) || !WaitForStop())
+	{
+		return;
+	}
+
+	while (!isStopping_)
+	{
+		std::string packet;
+		while (TakePacket(&packet))
+		{
+			if (!HandlePacket(packet))
+			{
+				return;
+			}
+		}
+
+		if (!ReceiveData())
+		{
+			return;
+		}
+	}
+}
+
+
+bool Chip8GdbServer::HandlePacket(const std::string& packet)
+{
+	if (packet.empty())
+	{
+		return SendPacket("");
+	}
+
+	std::string reply;
+	size_t pos = 1;
+	u32 address, length, val = 0;
+
+	switch (packet[0])
+	{
+	case '\x03':
+		// Interrupt while already stopped.
+		return true;
+
+	case '?':
+		reply = "S05";
+		break;
+
+	case 'g':
+		for (unsigned int reg = 0; reg < registerCount; ++reg)
+		{
+			AppendHex(reply, GetRegister(stopRegisters_, reg), GetRegisterSize(reg));
+		}
+		break;
+
+	case 'G':
+	{
+		auto regs = stopRegisters_;
+		auto isValid = true;
+		for (unsigned int reg = 0; reg < registerCount && isValid; ++reg)
+		{
+			isValid = ParseHex(packet, pos, GetRegisterSize(reg), &val);
+			SetRegister(regs, reg, val);
+		}
+
+		request_.registers = regs;
+		reply = (isValid && SendCommand(Command::WriteRegisters) ? "OK" : "E01");
+		break;
+	}
+
+	case 'p':
+	{
+		const auto reg = std::strtoul(packet.c_str() + 1, nullptr, 16);
+		if (reg < registerCount)
+		{
+			AppendHex(reply, GetRegister(stopRegisters_, reg), GetRegisterSize(reg));
+		}
+		else
+		{
+			reply = "E01";
+		}
+		break;
+	}
+
+	case 'P':
+	{
+		char* end;
+		const auto reg = std::strtoul(packet.c_str() + 1, &end, 16);
+		pos = end - packet.c_str() + 1;
+		if (*end == '=' && reg < registerCount && ParseHex(packet, pos, GetRegisterSize(reg), &val))
+		{
+			request_.registers = stopRegisters_;
+			SetRegister(request_.registers, reg, val);
+			reply = (SendCommand(Command::WriteRegisters) ? "OK" : "E01");
+		}
+		else
+		{
+			reply = "E01";
+		}
+		break;
+	}
+
+	case 'm':
+		if (ParseAddressLength(packet, pos, &address, &length) && address < stopMemory_.size())
+		{
+			const auto end = std::min<size_t>(stopMemory_.size(), static_cast<size_t>(address) + length);
+			for (auto addr = address; addr < end; ++addr)
+			{
+				AppendHex(reply, stopMemory_[addr], 1);
+			}
+		}
+		else
+		{
+			reply = "E01";
+		}
+		break;
+
+	case 'M':
+		if (ParseAddressLength(packet, pos, &address, &length) && pos < packet.size() && packet[pos] == ':'
+			&& static_cast<size_t>(address) + length <= stopMemory_.size())
+		{
+			++pos;
+			request_.data.resize(length);
+			auto isValid = true;
+			for (u32 i = 0; i < length && isValid; ++i)
+			{
+				isValid = ParseHex(packet, pos, 1, &val);
+				request_.data[i] = static_cast<u8>(val);
+			}
+
+			reply = (isValid && SendCommand(Command::WriteMemory, static_cast<u16>(address), static_cast<u16>(length)) ? "OK" : "E01");
+		}
+		else
+		{
+			reply = "E01";
+		}
+		break;
+
+	case 'c':
+	case 's':
+		if (!SendCommand(packet[0] == 'c' ? Command::Continue : Command::Step) || !WaitForStop())
+		{
+			return false;
+		}
+		reply = "S05";
+		break;
+
+	case 'Z':
+	case 'z':
+	{
+		// Z0/Z1 are breakpoints, Z2/Z3/Z4 are write/read/access watchpoints.
+		const auto type = (packet.size() > 1 ? packet[1] - '0' : -1);
+		pos = 3;
+		if (type < 0 || type > 4 || packet.size() < 3 || packet[2] != ',' || !ParseAddressLength(packet, pos, &address, &length))
+		{
+			reply = "E01";
+			break;
+		}
+
+		const auto isSet = (packet[0] == 'Z');
+		const auto isWatch = (type >= 2);
+		const u8 access = (type == 2 ? CHIP8_OP_MEMORY_WRITE : (type == 3 ? CHIP8_OP_MEMORY_READ : CHIP8_OP_MEMORY_READ | CHIP8_OP_MEMORY_WRITE));
+		const auto setCommand = (isWatch ? Command::SetWatchpoint : Command::SetBreakpoint);
+		const auto undoCommand = (isWatch ? Command::RemoveWatchpoint : Command::RemoveBreakpoint);
+		const auto size = static_cast<u16>(isWatch ? length : 1);
+
+		// Remember how to undo each point the client sets, so that it only ever removes its own - also when it goes.
+		const auto it = std::find_if(clientPoints_.begin(), clientPoints_.end(), [&](const Request& point)
+		{
+			return (point.command == undoCommand && point.address == address && point.size == size && point.access == access);
+		});
+
+		if (isSet && it == clientPoints_.end())
+		{
+			if (!SendCommand(setCommand, static_cast<u16>(address), size, access))
+			{
+				reply = "E01";
+				break;
+			}
+
+			Request point = {};
+			point.command = undoCommand;
+			point.address = static_cast<u16>(address);
+			point.size = size;
+			point.access = access;
+			point.data = request_.data;
+			clientPoints_.push_back(point);
+		}
+		else if (!isSet && it != clientPoints_.end())
+		{
+			request_.data = it->data;
+			if (!SendCommand(undoCommand, it->address, it->size, it->access))
+			{
+				reply = "E01";
+				break;
+			}
+
+			clientPoints_.erase(it);
+		}
+
+		reply = "OK";
+		break;
+	}
+
+	case 'D':
+		SendPacket("OK");
+		return false;
+
+	case 'k':
+		return false;
+
+	case 'H':
+	case 'T':
+		reply = "OK";
+		break;
+
+	case 'q':
+		if (packet.compare(0, 10, "qSupported") == 0)
+		{
+			char features[128];
+			std::snprintf(features, sizeof(features), "PacketSize=%x;qXfer:features:read+;QStartNoAckMode+", CHIP8_GDB_MAX_PACKET_SIZE);
+			reply = features;
+		}
+		else if (packet == "qAttached")
+		{
+			reply = "1";
+		}
+		else if (packet == "qfThreadInfo")
+		{
+			reply = "m1";
+		}
+		else if (packet == "qsThreadInfo")
+		{
+			reply = "l";
+		}
+		else if (packet == "qC")
+		{
+			reply = "QC1";
+		}
+		else if (packet.compare(0, 31, "qXfer:features:read:target.xml:") == 0)
+		{
+			pos = 31;
+			u32 offset;
+			if (!ParseAddressLength(packet, pos, &offset, &length))
+			{
+				reply = "E01";
+				break;
+			}
+
+			const auto xmlSize = sizeof(targetXml) - 1;
+			if (offset >= xmlSize)
+			{
+				reply = "l";
+				break;
+			}
+
+			const auto chunkSize = std::min<size_t>(length, xmlSize - offset);
+			reply = (offset + chunkSize < xmlSize ? "m" : "l");
+			reply.append(targetXml + offset, chunkSize);
+		}
+		break;
+
+	case 'Q':
+		if (packet == "QStartNoAckMode")
+		{
+			const auto isSent = SendPacket("OK");
+			isNoAckMode_ = true;
+			return isSent;
+		}
+		break;
+	}
+
+	// Unsupported packets get an empty reply.
+	return SendPacket(reply);
+}
+
+
+void Chip8GdbServer::DetachClient()
+{
+	// Leave the program running without the client's breakpoints - resuming it is done last.
+	Request resume = {};
+	resume.command = Command::Continue;
+	clientPoints_.insert(clientPoints_.begin(), resume);
+
+	while (!clientPoints_.empty())
+	{
+		const auto& point = clientPoints_.back();
+		request_.data = point.data;
+		if (!SendCommand(point.command, point.address, point.size, point.access))
+		{
+			return;
+		}
+
+		clientPoints_.pop_back();
+	}
+}
+
+
+bool Chip8GdbServer::SendCommand(Command command, u16 address, u16 size, u8 access)
+{
+	request_.command = command;
+	request_.address = address;
+	request_.size = size;
+	request_.access = access;
+	mailboxState_.store(MailboxRequest, std::memory_order_release);
+
+	while (mailboxState_.load(std::memory_order_acquire) != MailboxReply)
+	{
+		if (isStopping_)
+		{
+			return false;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	const auto isOK = request_.isOK;
+	mailboxState_.store(MailboxEmpty, std::memory_order_release);
+	return isOK;
+}
+
+
+bool Chip8GdbServer::WaitForStop()
+{
+	while (!isStopping_)
+	{
+		if (hasStopped_.load(std::memory_order_acquire))
+		{
+			return true;
+		}
+
+		// Only interrupts are expected while the target runs - packets are left for once it has stopped, such as
+		// those a client sends straight after attaching.
+		auto pos = receiveBuffer_.find_first_not_of('+');
+		while (pos != std::string::npos && receiveBuffer_[pos] == '\x03')
+		{
+			receiveBuffer_.erase(0, pos + 1);
+			if (!SendCommand(Command::Halt))
+			{
+				return false;
+			}
+
+			pos = receiveBuffer_.find_first_not_of('+');
+		}
+
+		if (!ReceiveData())
+		{
+			return false;
+		}
+	}
+
+	return false;
+}
+
+
+bool Chip8GdbServer::ReceiveData()
+{
+	if (!WaitUntilReadable(clientSocket_))
+	{
+		return true;
+	}
+
+	char buffer[1024];
+	const auto received = recv(clientSocket_, buffer, sizeof(buffer), 0);
+	if (received <= 0)
+	{
+		return false;
+	}
+
+	if (receiveBuffer_.size() + received > CHIP8_GDB_MAX_PACKET_SIZE * 2)
+	{
+		// A client flooding us with garbage.
+		return false;
+	}
+
+	receiveBuffer_.append(buffer, received);
+	return true;
+}
+
+
+bool Chip8GdbServer::TakePacket(std::string* outPacket)
+{
+	while (!receiveBuffer_.empty())
+	{
+		const auto first = receiveBuffer_[0];
+		if (first == '\x03')
+		{
+			receiveBuffer_.erase(0, 1);
+			*outPacket = "\x03";
+			return true;
+		}
+
+		if (first != '$')
+		{
+			// Acks, and anything else between packets.
+			receiveBuffer_.erase(0, 1);
+			continue;
+		}
+
+		const auto hashPos = receiveBuffer_.find('#');
+		if (hashPos == std::string::npos || hashPos + 2 >= receiveBuffer_.size())
+		{
+			// Not all received yet.
+			return false;
+		}
+
+		u8 checksum = 0;
+		for (size_t i = 1; i < hashPos; ++i)
+		{
+			checksum += static_cast<u8>(receiveBuffer_[i]);
+		}
+
+		const auto hi = HexDigitValue(receiveBuffer_[hashPos + 1]);
+		const auto lo = HexDigitValue(receiveBuffer_[hashPos + 2]);
+		const auto isValid = (hi >= 0 && lo >= 0 && ((hi << 4) | lo) == checksum);
+
+		*outPacket = receiveBuffer_.substr(1, hashPos - 1);
+		receiveBuffer_.erase(0, hashPos + 3);
+
+		if (!isNoAckMode_)
+		{
+			send(clientSocket_, (isValid ? "+" : "-"), 1, 0);
+		}
+
+		if (isValid)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool Chip8GdbServer::SendPacket(const std::string& data)
+{
+	u8 checksum = 0;
+	for (const auto c : data)
+	{
+		checksum += static_cast<u8>(c);
+	}
+
+	std::string packet = "$" + data + "#";
+	AppendHex(packet, checksum, 1);
+
+	// Acks aren't waited for - a client asking for a resend gets nothing, which a local socket shouldn't need.
+	size_t sent = 0;
+	while (sent < packet.size())
+	{
+		const auto result = send(clientSocket_, packet.data() + sent, static_cast<int>(packet.size() - sent), 0);
+		if (result <= 0)
+		{
+			return false;
+		}
+
+		sent += result;
+	}
+
+	return true;
+}
+
+
+void Chip8GdbServer::CloseSocket(intptr_t socket)
+{
+	if (socket == invalidSocket)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	closesocket(static_cast<NativeSocket>(socket));
+#else
+	close(static_cast<NativeSocket>(socket));
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8CPU.h"
+#include "Chip8Types.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+* A GDB remote serial protocol server, for attaching a debugger front-end to the emulator over TCP.
+*
+* The protocol runs on a thread of its own. The emulation thread is only touched when it calls Poll(),
+* between frames or while paused - commands are handed over through a single-slot mailbox, and reads
+* are answered from a snapshot taken whenever the target stops, so an attached client costs nothing
+* until it sends a command. Stopping, stepping and breakpoints go through the CPU's debugger.
+*
+* Registers are V0-VF, I, PC, SP, DT and ST (in that order, little-endian), as described to the client
+* by the target.xml it can read with qXfer:features:read.
+*/
+class Chip8GdbServer
+{
+public:
+	Chip8GdbServer();
+	~Chip8GdbServer();
+
+	Chip8GdbServer(const Chip8GdbServer&) = delete;
+	Chip8GdbServer& operator=(const Chip8GdbServer&) = delete;
+
+	/**
+	* Starts listening for a client on a local TCP port.
+	* Returns true on success, false on failure.
+	*/
+	bool Start(u16 port = CHIP8_GDB_DEFAULT_PORT);
+
+	/**
+	* Disconnects any client and stops listening.
+	* Must be called from the emulation thread. The client's breakpoints and watchpoints are removed, and the target
+	* resumed, by the next Poll().
+	*/
+	void Stop();
+
+	/**
+	* Returns whether or not the server is listening.
+	*/
+	bool IsRunning() const;
+
+	/**
+	* Returns whether or not a client is attached.
+	*/
+	bool IsClientAttached() const;
+
+	/**
+	* Carries out any command from the client on the emulation thread, and reports stops of the target.
+	* Must be called regularly from the emulation thread - between frames, and while paused.
+	* Does nothing if the CPU has no debugger attached.
+	*/
+	void Poll(Chip8CPU& cpu, Chip8Memory& ram);
+
+private:
+	enum class Command : u8
+	{
+		Halt,
+		Continue,
+		Step,
+		SetBreakpoint,
+		RemoveBreakpoint,
+		SetWatchpoint,
+		RemoveWatchpoint,
+		WriteRegisters,
+		WriteMemory
+	};
+
+	enum MailboxState : u8
+	{
+		MailboxEmpty,
+		MailboxRequest,
+		MailboxReply
+	};
+
+	/**
+	* A command for the emulation thread, and its result.
+	*/
+	struct Request
+	{
+		Command command;
+		u16 address;
+		u16 size;
+		u8 access;
+		Chip8CPURegisters registers;
+		std::vector<u8> data; // Bytes to write, or for points, the accesses each byte gained when set (what removing them takes away)
+		bool isOK;
+	};
+
+	std::thread thread_;
+	std::atomic<bool> isRunning_, isStopping_, isClientAttached_;
+	intptr_t listenSocket_, clientSocket_;
+
+	// Handed between the threads by mailboxState_ - only the thread the state says owns it touches it.
+	std::atomic<u8> mailboxState_;
+	Request request_;
+
+	// Written by the emulation thread before it sets hasStopped_, or while replying to a request.
+	std::atomic<bool> hasStopped_;
+	Chip8CPURegisters stopRegisters_;
+	std::vector<u8> stopMemory_;
+
+	// Only touched by the emulation thread.
+	bool isTargetRunning_;
+	std::vector<Request> detachRequests_; // What's left of undoing a client's session that Stop() cut short
+
+	// Only touched by the server thread.
+	std::string receiveBuffer_;
+	bool isNoAckMode_;
+	std::vector<Request> clientPoints_; // How to undo the breakpoints and watchpoints set by the client, when it goes
+
+	/**
+	* The server thread - accepts clients one at a time and serves them.
+	*/
+	void Run();
+
+	/**
+	* Serves packets from the attached client until it detaches or disconnects.
+	*/
+	void ServeClient();
+
+	/**
+	* Handles a packet from the client.
+	* Returns false if the client should be disconnected, true otherwise.
+	*/
+	bool HandlePacket(const std::string& packet);
+
+	/**
+	* Undoes the client's breakpoints and watchpoints, and resumes the target, as the client goes.
+	* Whatever the emulation thread can't be asked to do because the server is stopping is left in clientPoints_.
+	*/
+	void DetachClient();
+
+	/**
+	* Hands a command to the emulation thread and waits for it to be carried out.
+	* Returns true if it succeeded, false if it failed or the server is stopping.
+	*/
+	bool SendCommand(Command command, u16 address = 0, u16 size = 0, u8 access = 0);
+
+	/**
+	* Waits for the target to stop, halting it if the client interrupts.
+	* Returns true once stopped, false if the client disconnected or the server is stopping.
+	*/
+	bool WaitForStop();
+
+	/**
+	* Carries out a command on the emulation thread.
+	*/
+	void HandleRequest(Request& request, Chip8CPU& cpu, Chip8Memory& ram);
+
+	/**
+	* Copies the registers and memory for the server thread to answer reads from.
+	*/
+	void TakeSnapshot(const Chip8CPU& cpu, const Chip8Memory& ram);
+
+	/**
+	* Waits up to CHIP8_GDB_POLL_MILLISECONDS for data from the client, appending it to the receive buffer.
+	* Returns false if the client disconnected, true otherwise.
+	*/
+	bool ReceiveData();
+
+	/**
+	* Takes the next complete packet, or interrupt (as "\x03"), out of the receive buffer.
+	* Returns true if there was one, false otherwise.
+	*/
+	bool TakePacket(std::string* outPacket);
+
+	/**
+	* Sends a packet to the client.
+	*/
+	bool SendPacket(const std::string& data);
+
+	/**
+	* Closes a socket.
+	*/
+	static void CloseSocket(intptr_t socket);
+};
\ No newline at end of file
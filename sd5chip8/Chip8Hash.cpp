@@ -0,0 +1,101 @@
+#include "Chip8Hash.h"
+
+#include <cstring>
+
+
+namespace
+{
+	const u64 prime1 = 11400714785074694791ULL;
+	const u64 prime2 = 14029467366897019727ULL;
+	const u64 prime3 = 1609587929392839161ULL;
+	const u64 prime4 = 9650029242287828579ULL;
+	const u64 prime5 = 2870177450012600261ULL;
+
+	inline u64 RotateLeft(u64 val, int bits) { return (val << bits) | (val >> (64 - bits)); }
+
+	// Reads unaligned little-endian values.
+	inline u64 Read64(const u8* p) { u64 val; std::memcpy(&val, p, sizeof(val)); return val; }
+	inline u32 Read32(const u8* p) { u32 val; std::memcpy(&val, p, sizeof(val)); return val; }
+
+	inline u64 Round(u64 acc, u64 input)
+	{
+		acc += input * prime2;
+		acc = RotateLeft(acc, 31);
+		return acc * prime1;
+	}
+
+	inline u64 MergeRound(u64 acc, u64 val)
+	{
+		acc ^= Round(0, val);
+		return acc * prime1 + prime4;
+	}
+}
+
+
+u64 Chip8Hash::XXH64(const void* data, size_t size, u64 seed)
+{
+	auto p = static_cast<const u8*>(data);
+	const auto end = p + size;
+	u64 hash;
+
+	if (size >= 32)
+	{
+		// Process 32-byte stripes with four accumulators.
+		u64 v1 = seed + prime1 + prime2;
+		u64 v2 = seed + prime2;
+		u64 v3 = seed;
+		u64 v4 = seed - prime1;
+
+		const auto limit = end - 32;
+		do
+		{
+			v1 = Round(v1, Read64(p));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		hash = MergeRound(hash, v1);
+		hash = MergeRound(hash, v2);
+		hash = MergeRound(hash, v3);
+		hash = MergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + prime5;
+	}
+
+	hash += size;
+
+	// Process the remaining bytes.
+	while (p + 8 <= end)
+	{
+		hash ^= Round(0, Read64(p));
+		hash = RotateLeft(hash, 27) * prime1 + prime4;
+		p += 8;
+	}
+
+	if (p + 4 <= end)
+	{
+		hash ^= static_cast<u64>(Read32(p)) * prime1;
+		hash = RotateLeft(hash, 23) * prime2 + prime3;
+		p += 4;
+	}
+
+	while (p < end)
+	{
+		hash ^= (*p) * prime5;
+		hash = RotateLeft(hash, 11) * prime1;
+		++p;
+	}
+
+	// Final avalanche.
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
\ No newline at end of file
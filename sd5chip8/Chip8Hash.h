@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+#include <cstddef>
+
+/**
+* Contains hash functions used for identifying program images.
+*/
+namespace Chip8Hash
+{
+	/**
+	* Returns the 64-bit xxHash (XXH64) of some data.
+	*/
+	u64 XXH64(const void* data, size_t size, u64 seed = 0);
+}
\ No newline at end of file
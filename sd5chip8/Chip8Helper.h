@@ -1,6 +1,9 @@
 #pragma once
 
+#include "Chip8Types.h"
+
 #include <chrono>
+#include <cstddef>
 
 namespace Chip8Helper
 {
@@ -8,4 +11,36 @@ namespace Chip8Helper
 	* Returns the current time since epoch.
 	*/
 	inline std::chrono::high_resolution_clock::duration GetNowDuration() { return std::chrono::high_resolution_clock::now().time_since_epoch(); }
-};
\ No newline at end of file
+
+	/**
+	* Returns the 64-bit FNV-1a hash of some data.
+	* Data can be hashed in pieces by passing the previous result in as hash.
+	*/
+	inline u64 HashFNV1a(const void* data, size_t size, u64 hash = 14695981039346656037ULL)
+	{
+		const auto bytes = static_cast<const u8*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
+	/**
+	* Continues a 64-bit FNV-1a hash over size zero bytes, as HashFNV1a() would, without needing them in memory.
+	* XORing in a zero byte changes nothing, so this is only the prime raised to the power of size, multiplied in.
+	*/
+	inline u64 HashFNV1aZeros(size_t size, u64 hash = 14695981039346656037ULL)
+	{
+		for (u64 factor = 1099511628211ULL; size > 0; size >>= 1, factor *= factor)
+		{
+			if ((size & 1) != 0)
+			{
+				hash *= factor;
+			}
+		}
+
+		return hash;
+	}
+}
\ No newline at end of file
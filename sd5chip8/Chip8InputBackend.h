@@ -0,0 +1,18 @@
+#pragma once
+
+class Chip8Keyboard;
+
+/**
+* Interface for the source of the emulator's key presses, such as a window's key events.
+*/
+class Chip8InputBackend
+{
+public:
+	virtual ~Chip8InputBackend() {}
+
+	/**
+	* Passes any key presses and releases since the last poll on to the keyboard.
+	* Called from the thread that runs the emulator, at the start of each frame before the key state is latched.
+	*/
+	virtual void PollInput(Chip8Keyboard& keyboard) = 0;
+};
\ No newline at end of file
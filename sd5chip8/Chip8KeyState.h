@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+/**
+* The key state seen by the CPU: a 16-bit mask latched once per frame (bit n is set if key n is down).
+* Chip8Keyboard builds it up from key presses; hosts that already have a mask, like the C interface, set it directly.
+*/
+class Chip8KeyState
+{
+public:
+	Chip8KeyState() :
+	keyState_(0)
+	{
+	}
+
+	/**
+	* Latches a key state as a mask, which is seen by the CPU until it is set again.
+	*/
+	inline void SetKeyState(u16 keys) { keyState_ = keys; }
+
+	/**
+	* Gets the latched key state as a mask (bit n is set if key n is down).
+	*/
+	inline u16 GetKeyState() const { return keyState_; }
+
+	/**
+	* Returns whether or not the specified key is down in the latched key state.
+	*/
+	inline bool IsKeyDown(u8 key) const { return (key < 16 && (keyState_ & (1 << key)) != 0); }
+
+	/**
+	* Writes to outKey containing the value of the lowest down key if there is one and returns true.
+	* If no key is down, false is returned and outKey is not modified.
+	*/
+	bool GetCurrentPressedKey(u8* outKey) const
+	{
+		if (keyState_ == 0)
+		{
+			// No keys are currently being pressed.
+			return false;
+		}
+
+		if (outKey != nullptr)
+		{
+			// Write the lowest down key code to outKey.
+			u8 key = 0;
+			while ((keyState_ & (1 << key)) == 0)
+			{
+				++key;
+			}
+
+			*outKey = key;
+		}
+
+		return true;
+	}
+
+private:
+	u16 keyState_;
+};
\ No newline at end of file
@@ -1,7 +1,19 @@
 #include "Chip8Keyboard.h"
 
 
-bool Chip8Keyboard::isKeyDown(u8 key)
+Chip8Keyboard::Chip8Keyboard() :
+heldKeys_(0),
+pressedKeys_(0)
+{
+}
+
+
+Chip8Keyboard::~Chip8Keyboard()
+{
+}
+
+
+bool Chip8Keyboard::QueueKeyEvent(u8 key, bool isDown)
 {
 	if (key >= 16)
 	{
@@ -9,26 +21,75 @@ bool Chip8Keyboard::isKeyDown(u8 key)
 		return false;
 	}
 
-	return sf::Keyboard::isKeyPressed(keys[key]);
+	KeyEvent keyEvent;
+	keyEvent.key = key;
+	keyEvent.isDown = isDown;
+	if (!queuedEvents_.TryPush(keyEvent))
+	{
+		// Queue is full.
+		return false;
+	}
+
+	// Wake up the emulator thread if it's sleeping on input. Taking the lock first makes sure
+	// the notify can't land between the waiter checking the queue and going to sleep.
+	{
+		std::lock_guard<std::mutex> lock(queuedEventsWaitMutex_);
+	}
+	queuedEventsWaitCond_.notify_one();
+	return true;
+}
+
+
+bool Chip8Keyboard::WaitForQueuedEvent(std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(queuedEventsWaitMutex_);
+	return queuedEventsWaitCond_.wait_for(lock, timeout, [this] { return !queuedEvents_.IsEmpty(); });
 }
 
 
-bool Chip8Keyboard::getCurrentPressedKey(u8* outKey)
+void Chip8Keyboard::Update()
 {
-	for (int i = 0; i < 16; ++i)
+	KeyEvent keyEvent;
+	while (queuedEvents_.TryPop(&keyEvent))
 	{
-		if (sf::Keyboard::isKeyPressed(keys[i]))
-		{
-			if (outKey != nullptr)
-			{
-				// Write the key code to outKey.
-				*outKey = i;
-			}
-
-			return true;
-		}
+		SetKey(keyEvent.key, keyEvent.isDown);
 	}
 
-	// No keys are currently being pressed.
-	return false;
+	SetKeyState(heldKeys_ | pressedKeys_);
+	pressedKeys_ = 0;
+}
+
+
+void Chip8Keyboard::ReleaseAll()
+{
+	heldKeys_ = pressedKeys_ = 0;
+	SetKeyState(0);
+}
+
+
+void Chip8Keyboard::SetHeldKeys(u16 keys)
+{
+	pressedKeys_ |= (keys & ~heldKeys_);
+	heldKeys_ = keys;
+}
+
+
+void Chip8Keyboard::SetKey(u8 key, bool isDown)
+{
+	if (key >= 16)
+	{
+		// No such key.
+		return;
+	}
+
+	const u16 keyBit = (1 << key);
+	if (isDown)
+	{
+		heldKeys_ |= keyBit;
+		pressedKeys_ |= keyBit;
+	}
+	else
+	{
+		heldKeys_ &= ~keyBit;
+	}
 }
\ No newline at end of file
@@ -1,47 +1,74 @@
 #pragma once
 
 #include "Chip8Types.h"
+#include "Chip8KeyState.h"
+#include "Chip8SPSCQueue.h"
 
-#include <utility>
-
-#include <SFML\Window\Keyboard.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 /**
-* Contains methods and data needed to emulate the Chip-8 keyboard.
+* Emulates the Chip-8 keyboard.
+* Key state is built up from key presses passed on by a Chip8InputBackend (and events queued from other threads)
+* and latched once per frame by Update(), so the CPU only ever reads a cached 16-bit mask instead of querying the OS.
 */
-namespace Chip8Keyboard
+class Chip8Keyboard : public Chip8KeyState
 {
+public:
+	Chip8Keyboard();
+	~Chip8Keyboard();
+
 	/**
-	* Contains a collection of SFML keys whose index values match their corrisponding Chip-8 key code.
+	* Presses or releases a key. Must be called from the thread that calls Update().
+	* A key pressed and released again before the next update is still reported as down for one frame.
 	*/
-	const sf::Keyboard::Key keys[16] = {
-		sf::Keyboard::X,	// 0
-		sf::Keyboard::Num1, // 1
-		sf::Keyboard::Num2,	// 2
-		sf::Keyboard::Num3, // 3
-		sf::Keyboard::Q,	// 4
-		sf::Keyboard::W,	// 5
-		sf::Keyboard::E,	// 6
-		sf::Keyboard::A,	// 7
-		sf::Keyboard::S,	// 8
-		sf::Keyboard::D,	// 9
-		sf::Keyboard::Z,	// A
-		sf::Keyboard::C,	// B
-		sf::Keyboard::Num4,	// C
-		sf::Keyboard::R,	// D
-		sf::Keyboard::F,	// E
-		sf::Keyboard::V		// F
-	};
+	void SetKey(u8 key, bool isDown);
+
+	/**
+	* Queues a key press or release from another thread. Only one thread may queue events.
+	* The event takes effect on the next call to Update().
+	* Returns true on success, false if the queue is full.
+	*/
+	bool QueueKeyEvent(u8 key, bool isDown);
+
+	/**
+	* Blocks until an event is queued from another thread or the timeout elapses.
+	* Returns true if there is a queued event waiting to be applied, false if the wait timed out.
+	*/
+	bool WaitForQueuedEvent(std::chrono::milliseconds timeout);
 
 	/**
-	* Returns whether or not the specified key is currently pressed down.
+	* Applies any queued events and latches the key state that is seen by the CPU until the next update.
+	* Keys that were pressed and released since the last update are reported as down for one frame.
 	*/
-	bool isKeyDown(u8 key);
+	void Update();
 
 	/**
-	* Writes to outKey containing the value of the current pressed key if there is one and returns true.
-	* If no key is currently being pressed, false is returned and outKey is not modified.
+	* Releases all keys.
 	*/
-	bool getCurrentPressedKey(u8* outKey);
-};
+	void ReleaseAll();
+
+	/**
+	* Sets which keys are held down as a mask (bit n is set if key n is down), as scripted input does.
+	* Must be called from the thread that calls Update(), and takes effect on the next call to it.
+	*/
+	void SetHeldKeys(u16 keys);
+
+private:
+	/**
+	* A key press or release queued from another thread.
+	*/
+	struct KeyEvent
+	{
+		u8 key;
+		bool isDown;
+	};
+
+	Chip8SPSCQueue<KeyEvent, 64> queuedEvents_;
+	std::mutex queuedEventsWaitMutex_;
+	std::condition_variable queuedEventsWaitCond_;
 
+	u16 heldKeys_;		// Keys currently held down
+	u16 pressedKeys_;	// Keys that went down since the last update
+};
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "Chip8MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+Chip8MappedFile::Chip8MappedFile() :
+data_(nullptr),
+size_(0)
+#ifdef _WIN32
+, fileHandle_(INVALID_HANDLE_VALUE),
+mappingHandle_(nullptr)
+#endif
+{
+}
+
+
+Chip8MappedFile::~Chip8MappedFile()
+{
+	Close();
+}
+
+
+#ifdef _WIN32
+
+bool Chip8MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+	fileHandle_ = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle_ == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle_, &fileSize) || fileSize.QuadPart == 0)
+	{
+		// Can't map an empty file.
+		Close();
+		return false;
+	}
+
+	mappingHandle_ = CreateFileMappingA(fileHandle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	data_ = static_cast<const u8*>(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+
+void Chip8MappedFile::Close()
+{
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+
+	if (mappingHandle_ != nullptr)
+	{
+		CloseHandle(mappingHandle_);
+	}
+
+	if (fileHandle_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle_);
+	}
+
+	data_ = nullptr;
+	size_ = 0;
+	mappingHandle_ = nullptr;
+	fileHandle_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool Chip8MappedFile::Open(const std::string& fileName)
+{
+	Close();
+
+	const auto fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+	{
+		// Can't map an empty file.
+		close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	const auto mapping = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	data_ = static_cast<const u8*>(mapping);
+	size_ = static_cast<size_t>(fileStat.st_size);
+	return true;
+}
+
+
+void Chip8MappedFile::Close()
+{
+	if (data_ != nullptr)
+	{
+		munmap(const_cast<u8*>(data_), size_);
+	}
+
+	data_ = nullptr;
+	size_ = 0;
+}
+
+#endif
+
+
+bool Chip8MappedFile::IsOpen() const
+{
+	return (data_ != nullptr);
+}
+
+
+const u8* Chip8MappedFile::GetData() const
+{
+	return data_;
+}
+
+
+size_t Chip8MappedFile::GetSize() const
+{
+	return size_;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+* A read-only memory mapping of a whole file.
+* The mapping is released when the object is destroyed or closed.
+*/
+class Chip8MappedFile
+{
+public:
+	Chip8MappedFile();
+	~Chip8MappedFile();
+
+	Chip8MappedFile(const Chip8MappedFile&) = delete;
+	Chip8MappedFile& operator=(const Chip8MappedFile&) = delete;
+
+	/**
+	* Maps a file into memory, closing any file that is already mapped.
+	* Returns true on success, false on failure (including if the file is empty).
+	*/
+	bool Open(const std::string& fileName);
+
+	/**
+	* Unmaps the file.
+	*/
+	void Close();
+
+	/**
+	* Returns whether or not a file is mapped.
+	*/
+	bool IsOpen() const;
+
+	/**
+	* Gets the mapped contents of the file, or null if no file is mapped.
+	*/
+	const u8* GetData() const;
+
+	/**
+	* Gets the size of the mapped file in bytes.
+	*/
+	size_t GetSize() const;
+
+private:
+	const u8* data_;
+	size_t size_;
+
+#ifdef _WIN32
+	void* fileHandle_;
+	void* mappingHandle_;
+#endif
+};
\ No newline at end of file
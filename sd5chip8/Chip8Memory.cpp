@@ -1,17 +1,37 @@
 #include "Chip8Memory.h"
 
 #include <cassert>
+#include <cstring>
 
 
 Chip8Memory::Chip8Memory(u16 size) :
 memSize_(size)
 {
-	// Allocate program RAM of specified size and zero out the memory.
-	mem_ = std::unique_ptr<u8[]>(new u8[size]);
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+	// Masking only works for power of two sizes that fit into the inline array.
+	assert(size <= CHIP8_MEMORY_SIZE && (size & (size - 1)) == 0);
+#else
+	// Allocate program RAM of specified size.
+	ownedMem_ = std::unique_ptr<u8[]>(new u8[size]);
+	mem_ = ownedMem_.get();
+#endif
+
+	// Zero out the memory.
 	Reset();
 }
 
 
+#ifndef CHIP8_MEMORY_INLINE_MASKED
+Chip8Memory::Chip8Memory(u8* storage, u16 size) :
+memSize_(size),
+mem_(storage)
+{
+	// Zero out the memory.
+	Reset();
+}
+#endif
+
+
 Chip8Memory::~Chip8Memory()
 {
 }
@@ -19,24 +39,23 @@ Chip8Memory::~Chip8Memory()
 
 void Chip8Memory::Reset()
 {
-	for (u16 i = 0; i < memSize_; ++i)
-	{
-		mem_[i] = 0;
-	}
+	std::memset(&mem_[0], 0, memSize_);
 }
 
 
-bool Chip8Memory::ReadValue(u16 address, u8* outVal)
+bool Chip8Memory::ReadValue(u16 address, u8* outVal) const
 {
+#ifndef CHIP8_MEMORY_INLINE_MASKED
 	// Make sure that the address we read from is valid.
 	if (address >= memSize_)
 	{
 		return false;
 	}
+#endif
 
 	if (outVal != nullptr)
 	{
-		*outVal = mem_[address];
+		*outVal = mem_[MaskAddress(address)];
 	}
 	return true;
 }
@@ -44,13 +63,78 @@ bool Chip8Memory::ReadValue(u16 address, u8* outVal)
 
 bool Chip8Memory::WriteValue(u16 address, u8 val)
 {
+#ifndef CHIP8_MEMORY_INLINE_MASKED
 	// Make sure that the address we write to is valid.
 	if (address >= memSize_)
 	{
 		return false;
 	}
+#endif
+
+	mem_[MaskAddress(address)] = val;
+	return true;
+}
+
+
+bool Chip8Memory::ReadBlock(u16 address, u8* outData, u16 size) const
+{
+	if (!IsRangeValid(address, size))
+	{
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+		// Range wraps around the end of RAM - copy byte by byte.
+		for (u16 i = 0; i < size; ++i)
+		{
+			outData[i] = mem_[MaskAddress(address + i)];
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	std::memcpy(outData, &mem_[address], size);
+	return true;
+}
+
+
+bool Chip8Memory::WriteBlock(u16 address, const u8* data, u16 size)
+{
+	if (!IsRangeValid(address, size))
+	{
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+		// Range wraps around the end of RAM - copy byte by byte.
+		for (u16 i = 0; i < size; ++i)
+		{
+			mem_[MaskAddress(address + i)] = data[i];
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	std::memcpy(&mem_[address], data, size);
+	return true;
+}
+
+
+bool Chip8Memory::Fill(u16 address, u8 val, u16 size)
+{
+	if (!IsRangeValid(address, size))
+	{
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+		// Range wraps around the end of RAM - fill byte by byte.
+		for (u16 i = 0; i < size; ++i)
+		{
+			mem_[MaskAddress(address + i)] = val;
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
 
-	mem_[address] = val;
+	std::memset(&mem_[address], val, size);
 	return true;
 }
 
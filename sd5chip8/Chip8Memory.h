@@ -1,12 +1,17 @@
 #pragma once
 
 #include <memory>
+#include <array>
 
 #include "Chip8Constants.h"
 #include "Chip8Types.h"
 
 /**
 * Represents the RAM used by a Chip-8 program.
+*
+* If CHIP8_MEMORY_INLINE_MASKED is defined, the RAM is stored inline in a fixed-size array instead of
+* being allocated, and addresses are masked to the RAM size rather than bounds checked. Out of range
+* accesses then wrap around to the start of RAM instead of failing. RAM sizes must be powers of two.
 */
 class Chip8Memory
 {
@@ -15,6 +20,14 @@ public:
 	* Allocates Chip-8 program RAM of a specified size (in bytes).
 	*/
 	Chip8Memory(u16 size = CHIP8_MEMORY_SIZE);
+
+#ifndef CHIP8_MEMORY_INLINE_MASKED
+	/**
+	* Uses size bytes of caller-owned storage as the RAM instead of allocating it.
+	* The storage must outlive the memory.
+	*/
+	Chip8Memory(u8* storage, u16 size);
+#endif
 	~Chip8Memory();
 
 	/**
@@ -26,7 +39,7 @@ public:
 	* Writes the value of a variable in memory at the specified address to outVal if outVal is not null.
 	* If the memory could be read, true is returned. False otherwise.
 	*/
-	bool ReadValue(u16 address, u8* outVal);
+	bool ReadValue(u16 address, u8* outVal) const;
 
 	/**
 	* Writes a value to a variable in memory at the specified address.
@@ -34,6 +47,39 @@ public:
 	*/
 	bool WriteValue(u16 address, u8 val);
 
+	/**
+	* Copies size bytes of memory starting at the specified address to outData.
+	* The whole range is checked once up front - if any of it is out of range nothing is copied and false is returned.
+	*/
+	bool ReadBlock(u16 address, u8* outData, u16 size) const;
+
+	/**
+	* Copies size bytes from data into memory starting at the specified address.
+	* The whole range is checked once up front - if any of it is out of range nothing is written and false is returned.
+	*/
+	bool WriteBlock(u16 address, const u8* data, u16 size);
+
+	/**
+	* Sets size bytes of memory starting at the specified address to val.
+	* The whole range is checked once up front - if any of it is out of range nothing is written and false is returned.
+	*/
+	bool Fill(u16 address, u8 val, u16 size);
+
+	/**
+	* Returns whether or not the range of size bytes starting at the specified address lies within RAM.
+	*/
+	inline bool IsRangeValid(u16 address, u16 size) const { return (static_cast<u32>(address) + size <= memSize_); }
+
+	/**
+	* Reads the value at the specified address without any checks. The address must be valid.
+	*/
+	inline u8 ReadValueUnchecked(u16 address) const { return mem_[MaskAddress(address)]; }
+
+	/**
+	* Writes a value at the specified address without any checks. The address must be valid.
+	*/
+	inline void WriteValueUnchecked(u16 address, u8 val) { mem_[MaskAddress(address)] = val; }
+
 	/**
 	* Gets the current amount of allocated Chip-8 RAM in bytes.
 	*/
@@ -41,6 +87,23 @@ public:
 
 private:
 	const u16 memSize_;
-	std::unique_ptr<u8[]> mem_;
-};
 
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+	std::array<u8, CHIP8_MEMORY_SIZE> mem_;
+#else
+	std::unique_ptr<u8[]> ownedMem_;
+	u8* mem_;
+#endif
+
+	/**
+	* Maps an address onto RAM - wraps it around the RAM size if memory is masked, otherwise leaves it as is.
+	*/
+	inline u16 MaskAddress(u16 address) const
+	{
+#ifdef CHIP8_MEMORY_INLINE_MASKED
+		return (address & (memSize_ - 1));
+#else
+		return address;
+#endif
+	}
+};
\ No newline at end of file
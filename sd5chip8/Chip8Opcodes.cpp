@@ -0,0 +1,70 @@
+#include "Chip8Opcodes.h"
+
+#include <cstddef>
+
+
+namespace
+{
+	// Indexed by Chip8OpType.
+	const Chip8OpInfo opInfos[static_cast<size_t>(Chip8OpType::Count)] = {
+		{ "???", "", CHIP8_OP_FLOW_STOP, CHIP8_OP_MEMORY_NONE },		// Invalid
+		{ "SYS", "%a", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },		// SYS
+		{ "CLS", "", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },		// CLS
+		{ "RET", "", CHIP8_OP_FLOW_RETURN, CHIP8_OP_MEMORY_NONE },		// RET
+		{ "JP", "%a", CHIP8_OP_FLOW_JUMP, CHIP8_OP_MEMORY_NONE },		// JPAddr
+		{ "CALL", "%a", CHIP8_OP_FLOW_CALL, CHIP8_OP_MEMORY_NONE },		// CALL
+		{ "SE", "%x, %b", CHIP8_OP_FLOW_SKIP, CHIP8_OP_MEMORY_NONE },	// SEVxByte
+		{ "SNE", "%x, %b", CHIP8_OP_FLOW_SKIP, CHIP8_OP_MEMORY_NONE },	// SNEVxByte
+		{ "SE", "%x, %y", CHIP8_OP_FLOW_SKIP, CHIP8_OP_MEMORY_NONE },	// SEVxVy
+		{ "LD", "%x, %b", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDVxByte
+		{ "ADD", "%x, %b", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// ADDVxByte
+		{ "LD", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDVxVy
+		{ "OR", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// OR
+		{ "AND", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// AND
+		{ "XOR", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// XOR
+		{ "ADD", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// ADDVxVy
+		{ "SUB", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// SUB
+		{ "SHR", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// SHR
+		{ "SUBN", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// SUBN
+		{ "SHL", "%x, %y", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// SHL
+		{ "SNE", "%x, %y", CHIP8_OP_FLOW_SKIP, CHIP8_OP_MEMORY_NONE },	// SNEVxVy
+		{ "LD", "I, %a", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDIAddr
+		{ "JP", "V0, %a", CHIP8_OP_FLOW_INDIRECT, CHIP8_OP_MEMORY_NONE }, // JPV0Addr
+		{ "RND", "%x, %b", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// RND
+		{ "DRW", "%x, %y, %n", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_READ }, // DRW
+		{ "SKP", "%x", CHIP8_OP_FLOW_SKIP, CHIP8_OP_MEMORY_NONE },		// SKP
+		{ "SKNP", "%x", CHIP8_OP_FLOW_SKIP, CHIP8_OP_MEMORY_NONE },		// SKNP
+		{ "LD", "%x, DT", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDVxDT
+		{ "LD", "%x, K", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDVxKey
+		{ "LD", "DT, %x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDDTVx
+		{ "LD", "ST, %x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDSTVx
+		{ "ADD", "I, %x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// ADDIVx
+		{ "LD", "F, %x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE },	// LDFVx
+		{ "LD", "B, %x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_WRITE },	// LDBVx
+		{ "LD", "[I], %x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_WRITE }, // LDIaddrVx
+		{ "LD", "%x, [I]", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_READ },	// LDVxIaddr
+		{ "AUDIO", "", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_READ },		// AUDIO
+		{ "PITCH", "%x", CHIP8_OP_FLOW_NEXT, CHIP8_OP_MEMORY_NONE }		// PITCH
+	};
+}
+
+
+const Chip8OpInfo& Chip8Opcodes::GetInfo(Chip8OpType type)
+{
+	const auto index = static_cast<size_t>(type);
+	return opInfos[index < static_cast<size_t>(Chip8OpType::Count) ? index : 0];
+}
+
+
+u16 Chip8Opcodes::GetMemoryAccessSize(u16 op)
+{
+	switch (Decode(op))
+	{
+	case Chip8OpType::DRW: return (op & 0x000F);
+	case Chip8OpType::LDBVx: return 3;
+	case Chip8OpType::LDIaddrVx:
+	case Chip8OpType::LDVxIaddr: return ((op & 0x0F00) >> 8) + 1;
+	case Chip8OpType::AUDIO: return 16;
+	default: return 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+/**
+* The instructions the CPU executes.
+*/
+enum class Chip8OpType : u8
+{
+	Invalid = 0,
+	SYS,
+	CLS,
+	RET,
+	JPAddr,
+	CALL,
+	SEVxByte,
+	SNEVxByte,
+	SEVxVy,
+	LDVxByte,
+	ADDVxByte,
+	LDVxVy,
+	OR,
+	AND,
+	XOR,
+	ADDVxVy,
+	SUB,
+	SHR,
+	SUBN,
+	SHL,
+	SNEVxVy,
+	LDIAddr,
+	JPV0Addr,
+	RND,
+	DRW,
+	SKP,
+	SKNP,
+	LDVxDT,
+	LDVxKey,
+	LDDTVx,
+	LDSTVx,
+	ADDIVx,
+	LDFVx,
+	LDBVx,
+	LDIaddrVx,
+	LDVxIaddr,
+	AUDIO,
+	PITCH,
+
+	Count
+};
+
+
+/* How an instruction affects control flow. */
+#define CHIP8_OP_FLOW_NEXT 0x00 // Continues with the next instruction
+#define CHIP8_OP_FLOW_JUMP 0x01 // Always jumps to its address operand
+#define CHIP8_OP_FLOW_CALL 0x02 // Calls its address operand, continuing with the next instruction once it returns
+#define CHIP8_OP_FLOW_RETURN 0x04 // Returns to the instruction after the last call
+#define CHIP8_OP_FLOW_SKIP 0x08 // Continues with either the next instruction or the one after it
+#define CHIP8_OP_FLOW_INDIRECT 0x10 // Jumps to an address only known at run time
+#define CHIP8_OP_FLOW_STOP 0x20 // Doesn't continue - the instruction is invalid
+
+/* How an instruction uses memory at I. */
+#define CHIP8_OP_MEMORY_NONE 0x00
+#define CHIP8_OP_MEMORY_READ 0x01
+#define CHIP8_OP_MEMORY_WRITE 0x02
+
+/**
+* Static information about an instruction.
+*
+* The operand format is literal text, except for:
+*   %x - Vx, %y - Vy, %n - the low nibble, %b - the low byte, %a - the 12-bit address.
+*/
+struct Chip8OpInfo
+{
+	const char* mnemonic;
+	const char* operandFormat;
+	u8 flow;
+	u8 memoryAccess;
+};
+
+
+namespace Chip8Opcodes
+{
+	/**
+	* Decodes an opcode into the instruction it executes.
+	* This is the decode table used by the CPU, so anything that inspects programs agrees with what runs them.
+	*/
+	inline Chip8OpType Decode(u16 op)
+	{
+		switch (op & 0xF000)
+		{
+		case 0x0000:
+			switch (op & 0x00FF)
+			{
+			case 0x00E0: return Chip8OpType::CLS;
+			case 0x00EE: return Chip8OpType::RET;
+			default: return Chip8OpType::SYS;
+			}
+
+		case 0x1000: return Chip8OpType::JPAddr;
+		case 0x2000: return Chip8OpType::CALL;
+		case 0x3000: return Chip8OpType::SEVxByte;
+		case 0x4000: return Chip8OpType::SNEVxByte;
+		case 0x5000: return Chip8OpType::SEVxVy;
+		case 0x6000: return Chip8OpType::LDVxByte;
+		case 0x7000: return Chip8OpType::ADDVxByte;
+
+		case 0x8000:
+			switch (op & 0x000F)
+			{
+			case 0x0000: return Chip8OpType::LDVxVy;
+			case 0x0001: return Chip8OpType::OR;
+			case 0x0002: return Chip8OpType::AND;
+			case 0x0003: return Chip8OpType::XOR;
+			case 0x0004: return Chip8OpType::ADDVxVy;
+			case 0x0005: return Chip8OpType::SUB;
+			case 0x0006: return Chip8OpType::SHR;
+			case 0x0007: return Chip8OpType::SUBN;
+			case 0x000E: return Chip8OpType::SHL;
+			default: return Chip8OpType::Invalid;
+			}
+
+		case 0x9000: return Chip8OpType::SNEVxVy;
+		case 0xA000: return Chip8OpType::LDIAddr;
+		case 0xB000: return Chip8OpType::JPV0Addr;
+		case 0xC000: return Chip8OpType::RND;
+		case 0xD000: return Chip8OpType::DRW;
+
+		case 0xE000:
+			switch (op & 0x00FF)
+			{
+			case 0x009E: return Chip8OpType::SKP;
+			case 0x00A1: return Chip8OpType::SKNP;
+			default: return Chip8OpType::Invalid;
+			}
+
+		case 0xF000:
+			switch (op & 0x00FF)
+			{
+			case 0x0002: return ((op & 0x0F00) == 0 ? Chip8OpType::AUDIO : Chip8OpType::Invalid);
+			case 0x0007: return Chip8OpType::LDVxDT;
+			case 0x000A: return Chip8OpType::LDVxKey;
+			case 0x0015: return Chip8OpType::LDDTVx;
+			case 0x0018: return Chip8OpType::LDSTVx;
+			case 0x001E: return Chip8OpType::ADDIVx;
+			case 0x0029: return Chip8OpType::LDFVx;
+			case 0x0033: return Chip8OpType::LDBVx;
+			case 0x003A: return Chip8OpType::PITCH;
+			case 0x0055: return Chip8OpType::LDIaddrVx;
+			case 0x0065: return Chip8OpType::LDVxIaddr;
+			default: return Chip8OpType::Invalid;
+			}
+
+		default:
+			return Chip8OpType::Invalid;
+		}
+	}
+
+	/**
+	* Gets the static information about an instruction.
+	*/
+	const Chip8OpInfo& GetInfo(Chip8OpType type);
+
+	/**
+	* Returns the amount of bytes of memory at I an opcode reads or writes (0 if it doesn't use memory at I).
+	*/
+	u16 GetMemoryAccessSize(u16 op);
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8Types.h"
+
+#include <string>
+
+/**
+* The machines a Chip-8 program can be written for.
+*/
+enum class Chip8Platform : u8
+{
+	Chip8 = 0,
+	ETI660,
+	Hires,
+	SChip,
+	XOChip
+};
+
+
+namespace Chip8PlatformHelper
+{
+	/**
+	* Returns the short name of a platform, as used on the command line and in program packs.
+	*/
+	inline const char* GetName(Chip8Platform platform)
+	{
+		switch (platform)
+		{
+		case Chip8Platform::Chip8: return "chip8";
+		case Chip8Platform::ETI660: return "eti660";
+		case Chip8Platform::Hires: return "hires";
+		case Chip8Platform::SChip: return "schip";
+		case Chip8Platform::XOChip: return "xochip";
+		default: return "unknown";
+		}
+	}
+
+	/**
+	* Gets the platform with the specified short name.
+	* Returns true on success, false if there is no platform with that name.
+	*/
+	inline bool Parse(const std::string& name, Chip8Platform* outPlatform)
+	{
+		for (u8 i = 0; i <= static_cast<u8>(Chip8Platform::XOChip); ++i)
+		{
+			if (name == GetName(static_cast<Chip8Platform>(i)))
+			{
+				*outPlatform = static_cast<Chip8Platform>(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	* Returns whether or not programs for a platform are loaded into ETI 660 memory.
+	*/
+	inline bool IsETI660(Chip8Platform platform) { return platform == Chip8Platform::ETI660; }
+
+	/**
+	* Returns the amount of CPU steps per frame programs for a platform expect.
+	*/
+	inline u32 GetStepsPerFrame(Chip8Platform platform)
+	{
+		switch (platform)
+		{
+		case Chip8Platform::SChip: return CHIP8_CPU_SCHIP_STEPS_PER_FRAME;
+		case Chip8Platform::XOChip: return CHIP8_CPU_XOCHIP_STEPS_PER_FRAME;
+		default: return CHIP8_CPU_STEPS_PER_FRAME;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Chip8Platform.h"
+#include "Chip8Types.h"
+
+#include <cstdlib>
+#include <string>
+
+/* Quirk flags - behaviours that differ between Chip-8 interpreters. With none set, the CPU behaves as it always has. */
+#define CHIP8_QUIRK_SHIFT_USES_VY 0x01 // SHR and SHL shift Vy into Vx instead of shifting Vx in place
+#define CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I 0x02 // LD [I], Vx and LD Vx, [I] leave I pointing after the last register (I + x + 1)
+#define CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I_BY_X 0x04 // LD [I], Vx and LD Vx, [I] leave I at I + x
+#define CHIP8_QUIRK_JUMP_USES_VX 0x08 // JP V0, addr jumps to addr + Vx, where x is the high nibble of addr
+#define CHIP8_QUIRK_CLIP_SPRITES 0x10 // DRW clips sprites at the edges of the display instead of wrapping them
+#define CHIP8_QUIRK_LOGIC_RESETS_VF 0x20 // OR, AND and XOR set VF to 0
+
+/* Quirks of the quirk profiles. */
+#define CHIP8_QUIRKS_DEFAULT 0
+#define CHIP8_QUIRKS_COSMAC_VIP (CHIP8_QUIRK_SHIFT_USES_VY | CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I | CHIP8_QUIRK_CLIP_SPRITES | CHIP8_QUIRK_LOGIC_RESETS_VF)
+#define CHIP8_QUIRKS_CHIP48 (CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I_BY_X | CHIP8_QUIRK_JUMP_USES_VX | CHIP8_QUIRK_CLIP_SPRITES)
+#define CHIP8_QUIRKS_SCHIP (CHIP8_QUIRK_JUMP_USES_VX | CHIP8_QUIRK_CLIP_SPRITES)
+#define CHIP8_QUIRKS_XOCHIP (CHIP8_QUIRK_SHIFT_USES_VY | CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I)
+
+#define CHIP8_QUIRKS_ALL 0x3F
+
+/**
+* The interpreters whose quirks can be emulated.
+*/
+enum class Chip8QuirkProfile : u8
+{
+	Default = 0,
+	CosmacVIP,
+	Chip48,
+	SChip,
+	XOChip
+};
+
+
+namespace Chip8QuirksHelper
+{
+	/**
+	* Returns the short name of a quirk profile, as used on the command line.
+	*/
+	inline const char* GetProfileName(Chip8QuirkProfile profile)
+	{
+		switch (profile)
+		{
+		case Chip8QuirkProfile::Default: return "default";
+		case Chip8QuirkProfile::CosmacVIP: return "vip";
+		case Chip8QuirkProfile::Chip48: return "chip48";
+		case Chip8QuirkProfile::SChip: return "schip";
+		case Chip8QuirkProfile::XOChip: return "xochip";
+		default: return "unknown";
+		}
+	}
+
+	/**
+	* Returns the quirk flags of a quirk profile.
+	*/
+	inline u32 GetProfileQuirks(Chip8QuirkProfile profile)
+	{
+		switch (profile)
+		{
+		case Chip8QuirkProfile::CosmacVIP: return CHIP8_QUIRKS_COSMAC_VIP;
+		case Chip8QuirkProfile::Chip48: return CHIP8_QUIRKS_CHIP48;
+		case Chip8QuirkProfile::SChip: return CHIP8_QUIRKS_SCHIP;
+		case Chip8QuirkProfile::XOChip: return CHIP8_QUIRKS_XOCHIP;
+		default: return CHIP8_QUIRKS_DEFAULT;
+		}
+	}
+
+	/**
+	* Returns the quirk flags programs for a platform expect by default.
+	*/
+	inline u32 GetPlatformQuirks(Chip8Platform platform)
+	{
+		switch (platform)
+		{
+		case Chip8Platform::SChip: return CHIP8_QUIRKS_SCHIP;
+		case Chip8Platform::XOChip: return CHIP8_QUIRKS_XOCHIP;
+		default: return CHIP8_QUIRKS_DEFAULT;
+		}
+	}
+
+	/**
+	* Gets quirk flags from either the name of a quirk profile or a number.
+	* Returns true on success, false if it is neither or has unknown flags set.
+	*/
+	inline bool Parse(const std::string& nameOrFlags, u32* outQuirks)
+	{
+		for (u8 i = 0; i <= static_cast<u8>(Chip8QuirkProfile::XOChip); ++i)
+		{
+			const auto profile = static_cast<Chip8QuirkProfile>(i);
+			if (nameOrFlags == GetProfileName(profile))
+			{
+				*outQuirks = GetProfileQuirks(profile);
+				return true;
+			}
+		}
+
+		char* end;
+		const auto quirks = std::strtoul(nameOrFlags.c_str(), &end, 0);
+		if (nameOrFlags.empty() || *end != '\0' || (quirks & ~CHIP8_QUIRKS_ALL) != 0)
+		{
+			return false;
+		}
+
+		*outQuirks = static_cast<u32>(quirks);
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "Chip8Random.h"
+
+
+namespace
+{
+	/**
+	* Scrambles a seed with SplitMix64, so similar seeds (such as 0, 1, 2...) start far apart.
+	*/
+	inline u64 MixSeed(u64 seed)
+	{
+		seed += 0x9E3779B97F4A7C15ULL;
+		seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+		return seed ^ (seed >> 31);
+	}
+}
+
+
+Chip8Random::Chip8Random(Chip8RandomEngine engine, u64 seed) :
+engine_(engine)
+{
+	Seed(seed);
+}
+
+
+void Chip8Random::Seed(u64 seed)
+{
+	const auto mixed = MixSeed(seed);
+	increment_ = 1;
+
+	switch (engine_)
+	{
+	case Chip8RandomEngine::Xorshift:
+		// Xorshift gets stuck on zero.
+		state_ = (mixed != 0 ? mixed : 0x9E3779B97F4A7C15ULL);
+		break;
+
+	case Chip8RandomEngine::COSMAC:
+		// So does the shift register, which only uses the low 16 bits.
+		state_ = ((mixed & 0xFFFF) != 0 ? (mixed & 0xFFFF) : 0xACE1);
+		break;
+
+	default:
+		// Seed as the PCG reference does, picking the stream from the seed too.
+		increment_ = (MixSeed(mixed) << 1) | 1;
+		state_ = 0;
+		NextByte();
+		state_ += mixed;
+		NextByte();
+		break;
+	}
+}
+
+
+void Chip8Random::SetEngine(Chip8RandomEngine engine)
+{
+	const auto seed = state_ ^ increment_;
+	engine_ = engine;
+	Seed(seed);
+}
+
+
+Chip8RandomEngine Chip8Random::GetEngine() const
+{
+	return engine_;
+}
\ No newline at end of file
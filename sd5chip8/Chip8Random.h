@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+#include <string>
+
+/**
+* The random number generators the RND instruction can use.
+*/
+enum class Chip8RandomEngine : u8
+{
+	PCG = 0,	// PCG32 (XSH RR) - 16 bytes of state, good quality.
+	Xorshift,	// xorshift64 - 8 bytes of state, the fastest.
+	COSMAC		// A 16-bit shift register, the kind of cheap generator the COSMAC VIP era interpreters used.
+};
+
+
+namespace Chip8RandomHelper
+{
+	/**
+	* Returns the short name of a random engine, as used on the command line.
+	*/
+	inline const char* GetName(Chip8RandomEngine engine)
+	{
+		switch (engine)
+		{
+		case Chip8RandomEngine::PCG: return "pcg";
+		case Chip8RandomEngine::Xorshift: return "xorshift";
+		case Chip8RandomEngine::COSMAC: return "cosmac";
+		default: return "unknown";
+		}
+	}
+
+	/**
+	* Gets the random engine with the specified short name.
+	* Returns true on success, false if there is no engine with that name.
+	*/
+	inline bool Parse(const std::string& name, Chip8RandomEngine* outEngine)
+	{
+		for (u8 i = 0; i <= static_cast<u8>(Chip8RandomEngine::COSMAC); ++i)
+		{
+			if (name == GetName(static_cast<Chip8RandomEngine>(i)))
+			{
+				*outEngine = static_cast<Chip8RandomEngine>(i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+
+/**
+* Generates the random bytes of the RND instruction.
+* The whole generator is a couple of words, so copying it along with the rest of the CPU state is cheap,
+* and its output only depends on the engine and the seed it was last given.
+*/
+class Chip8Random
+{
+public:
+	explicit Chip8Random(Chip8RandomEngine engine = Chip8RandomEngine::PCG, u64 seed = 0);
+
+	/**
+	* Restarts the sequence of the engine from a seed.
+	*/
+	void Seed(u64 seed);
+
+	/**
+	* Switches to another engine, seeding it from the state of the current one.
+	*/
+	void SetEngine(Chip8RandomEngine engine);
+
+	/**
+	* Gets the engine in use.
+	*/
+	Chip8RandomEngine GetEngine() const;
+
+	/**
+	* Generates the next random byte.
+	*/
+	inline u8 NextByte()
+	{
+		switch (engine_)
+		{
+		case Chip8RandomEngine::Xorshift:
+			state_ ^= state_ << 13;
+			state_ ^= state_ >> 7;
+			state_ ^= state_ << 17;
+			return static_cast<u8>(state_ >> 56);
+
+		case Chip8RandomEngine::COSMAC:
+			// Shift a whole byte out of a 16-bit Galois LFSR (x^16 + x^14 + x^13 + x^11 + 1).
+			for (int i = 0; i < 8; ++i)
+			{
+				state_ = (state_ >> 1) ^ ((0 - (state_ & 1)) & 0xB400);
+			}
+			return static_cast<u8>(state_);
+
+		default:
+		{
+			const auto oldState = state_;
+			state_ = oldState * 6364136223846793005ULL + increment_;
+			const auto xorShifted = static_cast<u32>(((oldState >> 18) ^ oldState) >> 27);
+			const auto rotation = static_cast<u32>(oldState >> 59);
+			return static_cast<u8>(((xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31))) >> 24);
+		}
+		}
+	}
+
+private:
+	u64 state_;
+	u64 increment_; // Only used by PCG - must be odd.
+	Chip8RandomEngine engine_;
+};
\ No newline at end of file
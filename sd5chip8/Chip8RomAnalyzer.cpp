@@ -0,0 +1,266 @@
+#include "Chip8RomAnalyzer.h"
+
+#include "Chip8Constants.h"
+#include "Chip8Opcodes.h"
+#include "Chip8Quirks.h"
+
+#include <algorithm>
+#include <bitset>
+
+
+namespace
+{
+	// Instructions checked after LD [I], Vx or LD Vx, [I] for another load or store at I.
+	const u8 loadStoreLookahead = 4;
+
+	// Most branches that will be followed at once - any more are dropped.
+	const size_t maxPendingBranches = 256;
+
+	/**
+	* Returns whether or not an opcode only exists on SCHIP (and XO-CHIP, which extends it).
+	*/
+	inline bool IsSChipOpcode(u16 op)
+	{
+		switch (op & 0xF000)
+		{
+		case 0x0000:
+			return (op & 0xFFF0) == 0x00C0 || (op >= 0x00FB && op <= 0x00FF);
+		case 0xD000:
+			return (op & 0x000F) == 0; // 16x16 sprite.
+		case 0xF000:
+			return (op & 0x00FF) == 0x30 || (op & 0x00FF) == 0x75 || (op & 0x00FF) == 0x85;
+		default:
+			return false;
+		}
+	}
+
+	/**
+	* Returns whether or not an opcode only exists on XO-CHIP.
+	*/
+	inline bool IsXOChipOpcode(u16 op)
+	{
+		switch (op & 0xF000)
+		{
+		case 0x0000:
+			return (op & 0xFFF0) == 0x00D0;
+		case 0x5000:
+			return (op & 0x000F) == 2 || (op & 0x000F) == 3;
+		case 0xF000:
+			return op == 0xF000 || op == 0xF002 || (op & 0x00FF) == 0x01 || (op & 0x00FF) == 0x3A;
+		default:
+			return false;
+		}
+	}
+
+	/**
+	* Returns whether or not an opcode is valid on any supported platform. Anything else is taken to be data.
+	*/
+	inline bool IsKnownOpcode(u16 op)
+	{
+		if (IsSChipOpcode(op) || IsXOChipOpcode(op))
+		{
+			return true;
+		}
+
+		// SYS is taken to be data.
+		const auto type = Chip8Opcodes::Decode(op);
+		return type != Chip8OpType::Invalid && type != Chip8OpType::SYS;
+	}
+
+	/**
+	* Returns whether or not an opcode is LD [I], Vx or LD Vx, [I].
+	*/
+	inline bool IsLoadStore(u16 op)
+	{
+		const auto low = (op & 0xF0FF);
+		return low == 0xF055 || low == 0xF065;
+	}
+
+	/**
+	* Returns whether or not an opcode sets or changes I.
+	*/
+	inline bool ChangesI(u16 op)
+	{
+		if ((op & 0xF000) == 0xA000)
+		{
+			return true;
+		}
+
+		const auto low = (op & 0xF0FF);
+		return op == 0xF000 || low == 0xF01E || low == 0xF029 || low == 0xF030;
+	}
+
+	/**
+	* Returns whether or not an opcode skips the next instruction on some condition.
+	*/
+	inline bool IsSkip(u16 op)
+	{
+		return Chip8Opcodes::GetInfo(Chip8Opcodes::Decode(op)).flow == CHIP8_OP_FLOW_SKIP;
+	}
+
+	/**
+	* Counts the jumps, calls and I loads that point into the program if it is loaded at loadAddress.
+	*/
+	u32 CountAddressesInProgram(const u8* data, size_t size, u16 loadAddress)
+	{
+		u32 count = 0;
+		for (size_t i = 0; i + 1 < size; i += 2)
+		{
+			const u16 op = (data[i] << 8) | data[i + 1];
+			const auto group = (op & 0xF000);
+			if (group == 0x1000 || group == 0x2000 || group == 0xA000)
+			{
+				const size_t addr = (op & 0x0FFF);
+				count += (addr >= loadAddress && addr < loadAddress + size ? 1 : 0);
+			}
+		}
+
+		return count;
+	}
+
+	/**
+	* Follows the control flow of the program from entryAddress, looking at each reachable instruction once.
+	*/
+	void ScanReachableCode(const u8* data, size_t size, u16 loadAddress, u16 entryAddress, Chip8RomAnalysis* analysis)
+	{
+		// Only the part of the program that fits in memory can ever run - anything past it would also index past isVisited.
+		size = std::min(size, static_cast<size_t>(CHIP8_MEMORY_SIZE - loadAddress));
+
+		std::bitset<CHIP8_MEMORY_SIZE> isVisited;
+		u16 pending[maxPendingBranches];
+		size_t pendingCount = 0;
+		pending[pendingCount++] = entryAddress;
+
+		while (pendingCount > 0)
+		{
+			auto addr = pending[--pendingCount];
+			u8 loadStoreCountdown = 0;
+			u16 lastLoadStore = 0;
+
+			while (addr >= loadAddress && static_cast<size_t>(addr - loadAddress) + 1 < size && !isVisited[addr])
+			{
+				isVisited[addr] = true;
+				const auto offset = addr - loadAddress;
+				const u16 op = (data[offset] << 8) | data[offset + 1];
+				if (!IsKnownOpcode(op))
+				{
+					// Ran into data.
+					break;
+				}
+
+				analysis->xochipOpcodeCount += (IsXOChipOpcode(op) ? 1 : 0);
+				analysis->schipOpcodeCount += (IsSChipOpcode(op) && !IsXOChipOpcode(op) ? 1 : 0);
+
+				// Look at the next load or store after one, if nothing sets I in between. Another of the same kind only
+				// makes sense if I moved on past the registers (walking through a table), while storing the registers
+				// just loaded only makes sense if it didn't (writing them back in place). Other uses of I could go
+				// either way.
+				if (loadStoreCountdown > 0)
+				{
+					--loadStoreCountdown;
+					if (IsLoadStore(op))
+					{
+						if ((op & 0x00FF) == (lastLoadStore & 0x00FF))
+						{
+							++analysis->loadStoreWalkCount;
+						}
+						else if ((lastLoadStore & 0x00FF) == 0x65 && (op & 0x0F00) == (lastLoadStore & 0x0F00))
+						{
+							++analysis->loadStoreInPlaceCount;
+						}
+					}
+					else if (ChangesI(op))
+					{
+						loadStoreCountdown = 0;
+					}
+				}
+
+				if (IsLoadStore(op))
+				{
+					loadStoreCountdown = loadStoreLookahead;
+					lastLoadStore = op;
+				}
+
+				// Follow the flow.
+				const auto target = static_cast<u16>(op & 0x0FFF);
+				if (op == 0x00EE || op == 0x00FD || (op & 0xF000) == 0xB000)
+				{
+					// Return, exit, or a jump that can't be followed statically.
+					break;
+				}
+				else if ((op & 0xF000) == 0x1000)
+				{
+					addr = target;
+					loadStoreCountdown = 0;
+					continue;
+				}
+				else if ((op & 0xF000) == 0x2000)
+				{
+					if (pendingCount < maxPendingBranches)
+					{
+						pending[pendingCount++] = target;
+					}
+					loadStoreCountdown = 0;
+				}
+				else if (IsSkip(op) && pendingCount < maxPendingBranches)
+				{
+					pending[pendingCount++] = addr + 4;
+				}
+
+				// F000 nnnn is 4 bytes long.
+				addr += (op == 0xF000 ? 4 : 2);
+			}
+		}
+	}
+}
+
+
+Chip8RomAnalysis Chip8RomAnalyzer::Analyze(const u8* data, size_t size)
+{
+	Chip8RomAnalysis analysis = {};
+
+	// Hires programs start by jumping to 0x260 - the CPU starts them at 0x2C0 instead.
+	analysis.hasHiresEntry = (size >= 2 && data[0] == 0x12 && data[1] == 0x60);
+
+	// ETI 660 programs are loaded at 0x600, so their addresses point there - and they have to fit in the ETI 660's RAM.
+	analysis.hasETI660Addresses = (size <= CHIP8_MEMORY_ETI660_SIZE - CHIP8_PROGRAM_ETI660_START &&
+		CountAddressesInProgram(data, size, CHIP8_PROGRAM_ETI660_START) > CountAddressesInProgram(data, size, CHIP8_PROGRAM_START));
+
+	const u16 loadAddress = (analysis.hasETI660Addresses ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START);
+	const u16 entryAddress = (analysis.hasHiresEntry ? CHIP8_PROGRAM_HIRES_START : loadAddress);
+	ScanReachableCode(data, size, loadAddress, entryAddress, &analysis);
+
+	// Pick the platform, from the most to the least specific evidence.
+	if (analysis.xochipOpcodeCount > 0)
+	{
+		analysis.platform = Chip8Platform::XOChip;
+	}
+	else if (analysis.schipOpcodeCount > 0)
+	{
+		analysis.platform = Chip8Platform::SChip;
+	}
+	else if (analysis.hasETI660Addresses)
+	{
+		analysis.platform = Chip8Platform::ETI660;
+	}
+	else if (analysis.hasHiresEntry)
+	{
+		analysis.platform = Chip8Platform::Hires;
+	}
+	else
+	{
+		analysis.platform = Chip8Platform::Chip8;
+	}
+
+	// Programs that walk through memory with LD [I], Vx and LD Vx, [I] rely on them incrementing I, as the original
+	// interpreter did - nothing else about that interpreter can be told from the code, so only that quirk is set.
+	analysis.reliesOnLoadStoreIncrement = (analysis.loadStoreWalkCount > analysis.loadStoreInPlaceCount);
+	analysis.quirks = Chip8QuirksHelper::GetPlatformQuirks(analysis.platform);
+	if (analysis.reliesOnLoadStoreIncrement)
+	{
+		analysis.quirks |= CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I;
+	}
+
+	analysis.stepsPerFrame = Chip8PlatformHelper::GetStepsPerFrame(analysis.platform);
+	return analysis;
+}
\ No newline at end of file
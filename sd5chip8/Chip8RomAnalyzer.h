@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Chip8Platform.h"
+#include "Chip8Types.h"
+
+#include <cstddef>
+
+/**
+* What static analysis found out about a program, and the settings picked for it.
+*/
+struct Chip8RomAnalysis
+{
+	/* Findings */
+	bool hasHiresEntry;			// Starts with JP 0x260, the hires entry idiom.
+	bool hasETI660Addresses;	// Its jumps, calls and I loads point into the program when loaded at 0x600, not 0x200.
+	u32 schipOpcodeCount;		// Opcodes only SCHIP (or XO-CHIP) has.
+	u32 xochipOpcodeCount;		// Opcodes only XO-CHIP has.
+	u32 loadStoreWalkCount;		// LD [I], Vx or LD Vx, [I] soon after another of the same kind, with I left as it was.
+	u32 loadStoreInPlaceCount;	// LD Vx, [I] soon followed by LD [I], Vx of the same registers, with I left as it was.
+	bool reliesOnLoadStoreIncrement; // Walks through memory with loads and stores more often than it writes back in place.
+
+	/* Picked settings */
+	Chip8Platform platform;
+	u32 quirks;
+	u32 stepsPerFrame;
+};
+
+
+namespace Chip8RomAnalyzer
+{
+	/**
+	* Scans a program image for the opcodes and idioms that give away the platform and interpreter it was
+	* written for, and picks the platform, quirk flags and steps per frame to run it with.
+	* It follows the control flow from the entry point and looks at each reachable instruction once, so it is cheap
+	* enough to run on every program loaded.
+	*/
+	Chip8RomAnalysis Analyze(const u8* data, size_t size);
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "Chip8RomCache.h"
+
+#include "Chip8Hash.h"
+#include "Chip8MappedFile.h"
+
+#include <algorithm>
+#include <fstream>
+
+
+Chip8RomCache::Chip8RomCache(size_t maxImages) :
+maxImages_(std::max<size_t>(maxImages, 1)),
+hits_(0),
+misses_(0)
+{
+}
+
+
+Chip8RomCache::~Chip8RomCache()
+{
+}
+
+
+std::shared_ptr<const Chip8RomImage> Chip8RomCache::Load(const std::string& fileName, size_t maxSize, Chip8RomLoadResult* outResult)
+{
+	auto result = Chip8RomLoadResult::OK;
+	std::shared_ptr<const Chip8RomImage> image;
+
+	Chip8MappedFile file;
+	if (!file.Open(fileName))
+	{
+		// Empty files can't be mapped - tell them apart from ones that can't be opened at all.
+		std::ifstream emptyCheck(fileName, std::ios::binary | std::ios::ate);
+		result = (emptyCheck && emptyCheck.tellg() == 0 ? Chip8RomLoadResult::Empty : Chip8RomLoadResult::OpenFailed);
+	}
+	else if (file.GetSize() > maxSize)
+	{
+		result = Chip8RomLoadResult::TooLarge;
+	}
+	else
+	{
+		image = Insert(file.GetData(), file.GetSize());
+	}
+
+	if (outResult != nullptr)
+	{
+		*outResult = result;
+	}
+
+	return image;
+}
+
+
+std::shared_ptr<const Chip8RomImage> Chip8RomCache::Insert(const u8* data, size_t size)
+{
+	// Hash outside of the lock.
+	const auto hash = Chip8Hash::XXH64(data, size);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	const auto it = images_.find(hash);
+	if (it != images_.end())
+	{
+		auto& entry = it->second;
+		if (entry.image->data.size() == size && std::equal(data, data + size, entry.image->data.begin()))
+		{
+			++hits_;
+			lru_.splice(lru_.begin(), lru_, entry.lruIt);
+			return entry.image;
+		}
+
+		// Hash collision - don't cache this one, the existing image keeps the slot.
+		++misses_;
+		return std::make_shared<const Chip8RomImage>(Chip8RomImage{ hash, std::vector<u8>(data, data + size) });
+	}
+
+	// Make room by evicting the least recently used image. Anything still using it keeps it alive.
+	if (images_.size() >= maxImages_)
+	{
+		images_.erase(lru_.back());
+		lru_.pop_back();
+	}
+
+	++misses_;
+	auto image = std::make_shared<const Chip8RomImage>(Chip8RomImage{ hash, std::vector<u8>(data, data + size) });
+	lru_.push_front(hash);
+	images_.emplace(hash, CacheEntry{ image, lru_.begin() });
+	return image;
+}
+
+
+std::shared_ptr<const Chip8RomImage> Chip8RomCache::Find(u64 hash) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	const auto it = images_.find(hash);
+	return (it != images_.end() ? it->second.image : nullptr);
+}
+
+
+void Chip8RomCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	images_.clear();
+	lru_.clear();
+}
+
+
+size_t Chip8RomCache::GetSize() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return images_.size();
+}
+
+
+unsigned long Chip8RomCache::GetHitCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return hits_;
+}
+
+
+unsigned long Chip8RomCache::GetMissCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return misses_;
+}
+
+
+Chip8RomCache& Chip8RomCache::GetShared()
+{
+	static Chip8RomCache cache;
+	return cache;
+}
+
+
+const char* Chip8RomCache::GetResultText(Chip8RomLoadResult result)
+{
+	switch (result)
+	{
+	case Chip8RomLoadResult::OK: return "no error";
+	case Chip8RomLoadResult::OpenFailed: return "could not open file";
+	case Chip8RomLoadResult::Empty: return "the file is empty";
+	case Chip8RomLoadResult::TooLarge: return "the file is too large to fit in memory";
+	default: return "unknown error";
+	}
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8Types.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+* An immutable program image, identified by the XXH64 hash of its contents.
+*/
+struct Chip8RomImage
+{
+	u64 hash;
+	std::vector<u8> data;
+};
+
+
+/**
+* Why loading a file into the cache failed, if it did.
+*/
+enum class Chip8RomLoadResult
+{
+	OK,
+	OpenFailed,
+	Empty,
+	TooLarge
+};
+
+
+/**
+* An in-process cache of program images keyed by the hash of their contents.
+* Files are memory mapped and hashed - a file whose contents are already cached is never copied again,
+* however many times (or under however many names) it is loaded. Safe to use from multiple threads.
+* Once it holds maxImages images, the least recently loaded or inserted one is evicted for each new one.
+*/
+class Chip8RomCache
+{
+public:
+	explicit Chip8RomCache(size_t maxImages = CHIP8_ROM_CACHE_MAX_IMAGES);
+	~Chip8RomCache();
+
+	/**
+	* Maps and hashes a file, returning the cached image of its contents.
+	* Files larger than maxSize are rejected before anything is copied or cached.
+	* Returns null on failure, writing why to outResult if it is not null.
+	*/
+	std::shared_ptr<const Chip8RomImage> Load(const std::string& fileName, size_t maxSize = CHIP8_ROM_MAX_SIZE,
+		Chip8RomLoadResult* outResult = nullptr);
+
+	/**
+	* Hashes an image in memory, returning the cached image of it.
+	*/
+	std::shared_ptr<const Chip8RomImage> Insert(const u8* data, size_t size);
+
+	/**
+	* Gets the cached image with the specified hash, or null if there isn't one.
+	*/
+	std::shared_ptr<const Chip8RomImage> Find(u64 hash) const;
+
+	/**
+	* Discards all cached images. Images still in use elsewhere stay alive until released.
+	*/
+	void Clear();
+
+	/**
+	* Gets the amount of cached images.
+	*/
+	size_t GetSize() const;
+
+	/**
+	* Gets the amount of loads that were found in the cache.
+	*/
+	unsigned long GetHitCount() const;
+
+	/**
+	* Gets the amount of loads that had to add a new image to the cache.
+	*/
+	unsigned long GetMissCount() const;
+
+	/**
+	* Gets the process-wide cache.
+	*/
+	static Chip8RomCache& GetShared();
+
+	/**
+	* Gets a description of why a load failed, to follow "Failed to load program - ".
+	*/
+	static const char* GetResultText(Chip8RomLoadResult result);
+
+private:
+	/**
+	* A cached image and its place in the eviction order.
+	*/
+	struct CacheEntry
+	{
+		std::shared_ptr<const Chip8RomImage> image;
+		std::list<u64>::iterator lruIt;
+	};
+
+	mutable std::mutex mutex_;
+	std::unordered_map<u64, CacheEntry> images_;
+	std::list<u64> lru_; // Hashes of the cached images, most recently used first
+	size_t maxImages_;
+	unsigned long hits_, misses_;
+};
\ No newline at end of file
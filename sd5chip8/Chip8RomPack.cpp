@@ -0,0 +1,396 @@
+#include "Chip8RomPack.h"
+
+#include "Chip8Hash.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+
+namespace
+{
+	const char packMagic[4] = { 'C', '8', 'P', 'K' };
+	const u16 packVersion = 1;
+	const u32 headerSize = 32;
+	const u32 entrySize = 32;
+
+	inline u16 Read16(const u8* p) { return static_cast<u16>(p[0] | (p[1] << 8)); }
+	inline u32 Read32(const u8* p) { return static_cast<u32>(Read16(p)) | (static_cast<u32>(Read16(p + 2)) << 16); }
+	inline u64 Read64(const u8* p) { return static_cast<u64>(Read32(p)) | (static_cast<u64>(Read32(p + 4)) << 32); }
+
+	inline void Write16(std::vector<u8>& out, u16 val) { out.push_back(val & 0xFF); out.push_back(val >> 8); }
+	inline void Write32(std::vector<u8>& out, u32 val) { Write16(out, val & 0xFFFF); Write16(out, val >> 16); }
+	inline void Write64(std::vector<u8>& out, u64 val) { Write32(out, val & 0xFFFFFFFF); Write32(out, val >> 32); }
+
+	/**
+	* Returns whether or not the range [offset, offset + size) lies within a file of fileSize bytes.
+	*/
+	inline bool IsInFile(u64 offset, u64 size, u64 fileSize) { return offset <= fileSize && size <= fileSize - offset; }
+
+	/**
+	* Compares a name against a name stored in the pack, like strcmp.
+	*/
+	inline int CompareName(const char* a, size_t aLength, const char* b, size_t bLength)
+	{
+		const auto result = std::memcmp(a, b, std::min(aLength, bLength));
+		if (result != 0)
+		{
+			return result;
+		}
+
+		return (aLength < bLength ? -1 : (aLength > bLength ? 1 : 0));
+	}
+}
+
+
+Chip8RomPack::Chip8RomPack() :
+entryCount_(0),
+entries_(nullptr),
+hashIndex_(nullptr),
+names_(nullptr),
+data_(nullptr)
+{
+}
+
+
+Chip8RomPack::~Chip8RomPack()
+{
+}
+
+
+bool Chip8RomPack::Open(const std::string& fileName)
+{
+	Close();
+
+	if (!file_.Open(fileName))
+	{
+		return false;
+	}
+
+	// Check the header.
+	const auto base = file_.GetData();
+	const u64 fileSize = file_.GetSize();
+	if (fileSize < headerSize || std::memcmp(base, packMagic, sizeof(packMagic)) != 0 ||
+		Read16(base + 4) != packVersion || Read16(base + 6) != entrySize)
+	{
+		Close();
+		return false;
+	}
+
+	const auto entryCount = Read32(base + 8);
+	const auto entriesOffset = Read32(base + 12);
+	const auto hashIndexOffset = Read32(base + 16);
+	const auto namesOffset = Read32(base + 20);
+	const auto dataOffset = Read32(base + 24);
+	if (!IsInFile(entriesOffset, static_cast<u64>(entryCount) * entrySize, fileSize) ||
+		!IsInFile(hashIndexOffset, static_cast<u64>(entryCount) * 4, fileSize) ||
+		!IsInFile(namesOffset, 0, fileSize) || !IsInFile(dataOffset, 0, fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	entryCount_ = entryCount;
+	entries_ = base + entriesOffset;
+	hashIndex_ = base + hashIndexOffset;
+	names_ = base + namesOffset;
+	data_ = base + dataOffset;
+
+	// Check every entry once up front, so lookups don't have to.
+	for (u32 i = 0; i < entryCount_; ++i)
+	{
+		const auto entry = entries_ + i * entrySize;
+		if (!IsInFile(dataOffset + static_cast<u64>(Read32(entry + 8)), Read32(entry + 12), fileSize) ||
+			!IsInFile(namesOffset + static_cast<u64>(Read32(entry + 16)), Read16(entry + 20), fileSize) ||
+			entry[22] > static_cast<u8>(Chip8Platform::XOChip) ||
+			Read32(hashIndex_ + i * 4) >= entryCount_)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+void Chip8RomPack::Close()
+{
+	file_.Close();
+	entryCount_ = 0;
+	entries_ = hashIndex_ = names_ = data_ = nullptr;
+}
+
+
+bool Chip8RomPack::IsOpen() const
+{
+	return file_.IsOpen();
+}
+
+
+u32 Chip8RomPack::GetEntryCount() const
+{
+	return entryCount_;
+}
+
+
+void Chip8RomPack::ReadEntry(u32 index, Chip8RomPackEntry* outEntry) const
+{
+	const auto entry = entries_ + index * entrySize;
+	outEntry->hash = Read64(entry);
+	outEntry->data = data_ + Read32(entry + 8);
+	outEntry->size = Read32(entry + 12);
+	outEntry->name = reinterpret_cast<const char*>(names_ + Read32(entry + 16));
+	outEntry->nameLength = Read16(entry + 20);
+	outEntry->platform = static_cast<Chip8Platform>(entry[22]);
+	outEntry->quirks = Read32(entry + 24);
+}
+
+
+bool Chip8RomPack::GetEntry(u32 index, Chip8RomPackEntry* outEntry) const
+{
+	if (index >= entryCount_)
+	{
+		return false;
+	}
+
+	ReadEntry(index, outEntry);
+	return true;
+}
+
+
+bool Chip8RomPack::FindByName(const std::string& name, Chip8RomPackEntry* outEntry) const
+{
+	// Entries are sorted by name.
+	u32 low = 0, high = entryCount_;
+	while (low < high)
+	{
+		const auto mid = low + (high - low) / 2;
+		const auto entry = entries_ + mid * entrySize;
+		const auto entryName = reinterpret_cast<const char*>(names_ + Read32(entry + 16));
+		const auto result = CompareName(entryName, Read16(entry + 20), name.data(), name.size());
+		if (result == 0)
+		{
+			ReadEntry(mid, outEntry);
+			return true;
+		}
+
+		if (result < 0)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return false;
+}
+
+
+bool Chip8RomPack::FindByHash(u64 hash, Chip8RomPackEntry* outEntry) const
+{
+	// The hash index holds entry indices sorted by the hash of their entry.
+	u32 low = 0, high = entryCount_;
+	while (low < high)
+	{
+		const auto mid = low + (high - low) / 2;
+		const auto index = Read32(hashIndex_ + mid * 4);
+		const auto entryHash = Read64(entries_ + index * entrySize);
+		if (entryHash == hash)
+		{
+			ReadEntry(index, outEntry);
+			return true;
+		}
+
+		if (entryHash < hash)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return false;
+}
+
+
+bool Chip8RomPack::Find(const std::string& nameOrHash, Chip8RomPackEntry* outEntry) const
+{
+	if (FindByName(nameOrHash, outEntry))
+	{
+		return true;
+	}
+
+	// Try it as a hash instead.
+	if (nameOrHash.empty() || nameOrHash.size() > 18)
+	{
+		return false;
+	}
+
+	char* end;
+	const auto hash = std::strtoull(nameOrHash.c_str(), &end, 16);
+	return (*end == '\0' && FindByHash(hash, outEntry));
+}
+
+
+Chip8RomPackBuilder::Chip8RomPackBuilder()
+{
+}
+
+
+Chip8RomPackBuilder::~Chip8RomPackBuilder()
+{
+}
+
+
+bool Chip8RomPackBuilder::Add(const std::string& name, const u8* data, size_t size, Chip8Platform platform, u32 quirks)
+{
+	if (size == 0 || size > 0xFFFFFFFF || name.size() > 0xFFFF)
+	{
+		return false;
+	}
+
+	if (names_.count(name) != 0)
+	{
+		return false;
+	}
+
+	// Programs with the same contents share their data.
+	const auto hash = Chip8Hash::XXH64(data, size);
+	auto dataIndex = datas_.size();
+	const auto sameHash = dataIndices_.equal_range(hash);
+	for (auto it = sameHash.first; it != sameHash.second; ++it)
+	{
+		const auto& programData = datas_[it->second];
+		if (programData.size() == size && std::equal(data, data + size, programData.begin()))
+		{
+			dataIndex = it->second;
+			break;
+		}
+	}
+
+	if (dataIndex == datas_.size())
+	{
+		datas_.emplace_back(data, data + size);
+		dataIndices_.emplace(hash, dataIndex);
+	}
+
+	names_.insert(name);
+	programs_.push_back(Program{ name, hash, platform, quirks, dataIndex });
+	return true;
+}
+
+
+size_t Chip8RomPackBuilder::GetEntryCount() const
+{
+	return programs_.size();
+}
+
+
+bool Chip8RomPackBuilder::Write(const std::string& fileName) const
+{
+	// Entries are stored in name order, with a separate index in hash order.
+	std::vector<u32> nameOrder(programs_.size()), hashOrder(programs_.size());
+	for (u32 i = 0; i < programs_.size(); ++i)
+	{
+		nameOrder[i] = i;
+	}
+
+	std::sort(nameOrder.begin(), nameOrder.end(), [this](u32 a, u32 b) {
+		const auto& nameA = programs_[a].name;
+		const auto& nameB = programs_[b].name;
+		return CompareName(nameA.data(), nameA.size(), nameB.data(), nameB.size()) < 0;
+	});
+
+	for (u32 i = 0; i < hashOrder.size(); ++i)
+	{
+		hashOrder[i] = i;
+	}
+
+	std::sort(hashOrder.begin(), hashOrder.end(), [this, &nameOrder](u32 a, u32 b) {
+		return programs_[nameOrder[a]].hash < programs_[nameOrder[b]].hash;
+	});
+
+	// Lay out the names and the data.
+	u64 namesSize = 0;
+	std::vector<u32> nameOffsets(programs_.size());
+	for (u32 i = 0; i < nameOrder.size(); ++i)
+	{
+		nameOffsets[i] = static_cast<u32>(namesSize);
+		namesSize += programs_[nameOrder[i]].name.size();
+	}
+
+	u64 dataSize = 0;
+	std::vector<u32> dataOffsets(datas_.size());
+	for (size_t i = 0; i < datas_.size(); ++i)
+	{
+		dataOffsets[i] = static_cast<u32>(dataSize);
+		dataSize += datas_[i].size();
+	}
+
+	const u64 entriesOffset = headerSize;
+	const u64 hashIndexOffset = entriesOffset + static_cast<u64>(programs_.size()) * entrySize;
+	const u64 namesOffset = hashIndexOffset + static_cast<u64>(programs_.size()) * 4;
+	const u64 dataOffset = namesOffset + namesSize;
+	if (dataOffset + dataSize > 0xFFFFFFFF)
+	{
+		// Too big for 32-bit offsets.
+		return false;
+	}
+
+	std::vector<u8> index;
+	index.reserve(static_cast<size_t>(dataOffset));
+	index.insert(index.end(), packMagic, packMagic + sizeof(packMagic));
+	Write16(index, packVersion);
+	Write16(index, static_cast<u16>(entrySize));
+	Write32(index, static_cast<u32>(programs_.size()));
+	Write32(index, static_cast<u32>(entriesOffset));
+	Write32(index, static_cast<u32>(hashIndexOffset));
+	Write32(index, static_cast<u32>(namesOffset));
+	Write32(index, static_cast<u32>(dataOffset));
+	Write32(index, 0);
+
+	for (u32 i = 0; i < nameOrder.size(); ++i)
+	{
+		const auto& program = programs_[nameOrder[i]];
+		Write64(index, program.hash);
+		Write32(index, dataOffsets[program.dataIndex]);
+		Write32(index, static_cast<u32>(datas_[program.dataIndex].size()));
+		Write32(index, nameOffsets[i]);
+		Write16(index, static_cast<u16>(program.name.size()));
+		index.push_back(static_cast<u8>(program.platform));
+		index.push_back(0);
+		Write32(index, program.quirks);
+		Write32(index, 0);
+	}
+
+	for (const auto entryIndex : hashOrder)
+	{
+		Write32(index, entryIndex);
+	}
+
+	for (const auto entryIndex : nameOrder)
+	{
+		const auto& name = programs_[entryIndex].name;
+		index.insert(index.end(), name.begin(), name.end());
+	}
+
+	auto file = std::ofstream(fileName, std::ios_base::binary | std::ios_base::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(index.data()), index.size());
+	for (const auto& data : datas_)
+	{
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+
+	return file.good();
+}
\ No newline at end of file
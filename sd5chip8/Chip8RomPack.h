@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Chip8MappedFile.h"
+#include "Chip8Platform.h"
+#include "Chip8Types.h"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+* A program stored in a program pack.
+* The name and data point into the mapped pack, so they're only valid while the pack stays open.
+*/
+struct Chip8RomPackEntry
+{
+	u64 hash;
+	const char* name;
+	size_t nameLength;
+	Chip8Platform platform;
+	u32 quirks; // 0 means the defaults for the platform.
+	const u8* data;
+	u32 size;
+};
+
+
+/**
+* A read-only program pack - many programs stored in a single file.
+*
+* The whole pack is memory mapped and checked once when it is opened. Looking programs up by name or
+* by hash is then a binary search over the index in the mapping, without any further file access.
+*
+* The layout (all values little-endian) is:
+*   Header     - magic "C8PK", u16 version, u16 entry size, u32 entry count, then u32 offsets to the
+*                entries, the hash index, the name table and the data.
+*   Entries    - one per program, sorted by name: u64 hash, u32 data offset, u32 size,
+*                u32 name offset, u16 name length, u8 platform, u8 reserved, u32 quirks, u32 reserved.
+*   Hash index - u32 entry indices, sorted by the hash of their entry.
+*   Names      - the names of the programs, not null-terminated.
+*   Data       - the contents of the programs. Programs with the same contents share the same data.
+*/
+class Chip8RomPack
+{
+public:
+	Chip8RomPack();
+	~Chip8RomPack();
+
+	/**
+	* Maps a pack file and checks that it is valid, closing any pack that is already open.
+	* Returns true on success, false on failure.
+	*/
+	bool Open(const std::string& fileName);
+
+	/**
+	* Closes the pack.
+	*/
+	void Close();
+
+	/**
+	* Returns whether or not a pack is open.
+	*/
+	bool IsOpen() const;
+
+	/**
+	* Gets the amount of programs in the pack.
+	*/
+	u32 GetEntryCount() const;
+
+	/**
+	* Gets the program at the specified index (in name order).
+	* Returns true on success, false if the index is out of range.
+	*/
+	bool GetEntry(u32 index, Chip8RomPackEntry* outEntry) const;
+
+	/**
+	* Finds the program with the specified name.
+	* Returns true if it was found, false otherwise.
+	*/
+	bool FindByName(const std::string& name, Chip8RomPackEntry* outEntry) const;
+
+	/**
+	* Finds a program with the specified XXH64 content hash.
+	* Returns true if one was found, false otherwise.
+	*/
+	bool FindByHash(u64 hash, Chip8RomPackEntry* outEntry) const;
+
+	/**
+	* Finds a program by name, or by hash if no program has that name and it is written as a hex number.
+	* Returns true if it was found, false otherwise.
+	*/
+	bool Find(const std::string& nameOrHash, Chip8RomPackEntry* outEntry) const;
+
+private:
+	Chip8MappedFile file_;
+	u32 entryCount_;
+	const u8* entries_;
+	const u8* hashIndex_;
+	const u8* names_;
+	const u8* data_;
+
+	/**
+	* Reads the entry at the specified index. The index must be in range.
+	*/
+	void ReadEntry(u32 index, Chip8RomPackEntry* outEntry) const;
+};
+
+
+/**
+* Builds program packs.
+*/
+class Chip8RomPackBuilder
+{
+public:
+	Chip8RomPackBuilder();
+	~Chip8RomPackBuilder();
+
+	/**
+	* Adds a program to the pack.
+	* Returns true on success, false if a program with that name was already added or the program is empty.
+	*/
+	bool Add(const std::string& name, const u8* data, size_t size, Chip8Platform platform, u32 quirks = 0);
+
+	/**
+	* Gets the amount of programs added.
+	*/
+	size_t GetEntryCount() const;
+
+	/**
+	* Writes the pack to a file.
+	* Returns true on success, false on failure.
+	*/
+	bool Write(const std::string& fileName) const;
+
+private:
+	struct Program
+	{
+		std::string name;
+		u64 hash;
+		Chip8Platform platform;
+		u32 quirks;
+		size_t dataIndex;
+	};
+
+	std::vector<Program> programs_;
+	std::vector<std::vector<u8>> datas_;
+	std::unordered_set<std::string> names_;
+	std::unordered_multimap<u64, size_t> dataIndices_;
+};
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "Chip8SFMLAudioStream.h"
+
+
+Chip8SFMLAudioStream::Chip8SFMLAudioStream(unsigned int bufferSamples, unsigned int sampleRate, unsigned int amplitude) :
+bufferSamples_(bufferSamples),
+underruns_(0),
+synth_(sampleRate, amplitude),
+streamedSamples_(0)
+{
+}
+
+
+Chip8SFMLAudioStream::~Chip8SFMLAudioStream()
+{
+	// Stop the audio thread before our members are destroyed from under it.
+	stream_.reset();
+}
+
+
+bool Chip8SFMLAudioStream::PushEvent(const Chip8AudioEvent& event)
+{
+	if (stream_)
+	{
+		return events_.TryPush(event);
+	}
+
+	// There is no audio thread yet, so the synth can be changed from here.
+	ApplyEvent(event);
+	if (event.type == Chip8AudioEvent::Beeping && event.value != 0)
+	{
+		// Stream continuously from now on - silence is synthesized while not beeping,
+		// so toggling the beep never restarts playback.
+		buf_.resize(bufferSamples_);
+		stream_ = std::make_unique<Stream>(*this, synth_.GetSampleRate());
+		stream_->play();
+	}
+
+	return true;
+}
+
+
+bool Chip8SFMLAudioStream::FillBuffer(sf::SoundStream::Chunk& data)
+{
+	CheckUnderrun();
+
+	// Apply any beep state changes made since the last buffer.
+	Chip8AudioEvent event;
+	while (events_.TryPop(&event))
+	{
+		ApplyEvent(event);
+	}
+
+	synth_.Generate(buf_.data(), buf_.size());
+	streamedSamples_ += buf_.size();
+
+	data.samples = buf_.data();
+	data.sampleCount = buf_.size();
+	return true; // Keep streaming forever.
+}
+
+
+void Chip8SFMLAudioStream::ApplyEvent(const Chip8AudioEvent& event)
+{
+	switch (event.type)
+	{
+	case Chip8AudioEvent::Reset:
+		synth_.Reset();
+		break;
+
+	case Chip8AudioEvent::Beeping:
+		synth_.SetBeeping(event.value != 0);
+		break;
+
+	case Chip8AudioEvent::Pitch:
+		synth_.SetPitch(event.value);
+		break;
+
+	case Chip8AudioEvent::Pattern:
+		synth_.SetPattern(event.pattern);
+		break;
+	}
+}
+
+
+void Chip8SFMLAudioStream::CheckUnderrun()
+{
+	// SFML doesn't tell us when the device starves, so estimate it: if more time has passed since streaming
+	// started than there were samples handed over to fill it, the device must have run dry at some point.
+	const auto now = Clock::now();
+	if (streamedSamples_ == 0)
+	{
+		streamStartTime_ = now;
+		return;
+	}
+
+	const auto elapsedSamples = std::chrono::duration_cast<std::chrono::microseconds>(now - streamStartTime_).count()
+		* static_cast<long long>(synth_.GetSampleRate()) / 1000000;
+	if (elapsedSamples > static_cast<long long>(streamedSamples_))
+	{
+		underruns_.fetch_add(1, std::memory_order_relaxed);
+
+		// Playback restarts from here.
+		streamStartTime_ = now;
+		streamedSamples_ = 0;
+	}
+}
+
+
+unsigned long Chip8SFMLAudioStream::GetUnderrunCount() const
+{
+	return underruns_.load(std::memory_order_relaxed);
+}
+
+
+unsigned int Chip8SFMLAudioStream::GetBufferSamples() const
+{
+	return bufferSamples_;
+}
+
+
+bool Chip8SFMLAudioStream::IsStarted() const
+{
+	return (stream_ != nullptr);
+}
+
+
+Chip8SFMLAudioStream::Stream::Stream(Chip8SFMLAudioStream& owner, unsigned int sampleRate) :
+owner_(owner)
+{
+	initialize(1, sampleRate);
+}
+
+
+Chip8SFMLAudioStream::Stream::~Stream()
+{
+	stop();
+}
+
+
+bool Chip8SFMLAudioStream::Stream::onGetData(Chunk& data)
+{
+	return owner_.FillBuffer(data);
+}
+
+
+void Chip8SFMLAudioStream::Stream::onSeek(sf::Time /*timeOffset*/)
+{
+	// Nothing to seek - the stream is generated on the fly.
+}
\ No newline at end of file
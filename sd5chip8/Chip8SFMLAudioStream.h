@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Chip8Types.h"
+#include "Chip8Constants.h"
+#include "Chip8AudioBackend.h"
+#include "Chip8AudioSynth.h"
+#include "Chip8SPSCQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <SFML/Audio/SoundStream.hpp>
+
+/**
+* Streams the Chip-8 beep to the audio device.
+* Beep state changes are passed through a lock-free queue and samples are synthesized on the audio thread,
+* so starting and stopping the beep never blocks the emulator or restarts playback.
+* The device is only opened on the first beep - most programs beep rarely and many never do, so until then
+* there is no audio thread or buffer, and beep state changes are applied to the synth straight away.
+*/
+class Chip8SFMLAudioStream : public Chip8AudioBackend
+{
+public:
+	/**
+	* Creates a stream which synthesizes bufferSamples samples at a time.
+	* Smaller buffers lower the latency of beep changes, but make underruns more likely.
+	*/
+	Chip8SFMLAudioStream(
+		unsigned int bufferSamples = CHIP8_BEEPER_DEFAULT_BUFFER_SAMPLES,
+		unsigned int sampleRate = CHIP8_BEEPER_DEFAULT_SAMPLE_RATE,
+		unsigned int amplitude = CHIP8_BEEPER_DEFAULT_AMPLITUDE
+		);
+	~Chip8SFMLAudioStream();
+
+	/**
+	* Queues a beep state change for the audio thread, opening the device and starting the stream on the first beep.
+	* Returns false if the queue is full.
+	*/
+	bool PushEvent(const Chip8AudioEvent& event) override;
+
+	/**
+	* Gets the amount of times the audio device is estimated to have run out of samples.
+	*/
+	unsigned long GetUnderrunCount() const override;
+
+	/**
+	* Gets the amount of samples synthesized per buffer.
+	*/
+	unsigned int GetBufferSamples() const;
+
+	/**
+	* Returns whether or not the device has been opened and the stream started.
+	*/
+	bool IsStarted() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	* The SFML stream itself, which pulls its samples from the owning Chip8SFMLAudioStream on the audio thread.
+	*/
+	class Stream : public sf::SoundStream
+	{
+	public:
+		Stream(Chip8SFMLAudioStream& owner, unsigned int sampleRate);
+		~Stream();
+
+	protected:
+		bool onGetData(Chunk& data) override;
+		void onSeek(sf::Time timeOffset) override;
+
+	private:
+		Chip8SFMLAudioStream& owner_;
+	};
+
+	const unsigned int bufferSamples_;
+
+	Chip8SPSCQueue<Chip8AudioEvent, 256> events_;
+	std::atomic<unsigned long> underruns_;
+
+	/* Only touched by the audio thread once the stream has started */
+	Chip8AudioSynth synth_;
+	std::vector<s16> buf_;
+	Clock::time_point streamStartTime_;
+	unsigned long long streamedSamples_;
+
+	// Declared last, so the audio thread is stopped before anything it uses is destroyed.
+	std::unique_ptr<Stream> stream_;
+
+	/**
+	* Synthesizes the next buffer of samples for the device.
+	*/
+	bool FillBuffer(sf::SoundStream::Chunk& data);
+
+	/**
+	* Applies a beep state change to the synth.
+	*/
+	void ApplyEvent(const Chip8AudioEvent& event);
+
+	/**
+	* Detects whether the device has played everything given to it so far.
+	*/
+	void CheckUnderrun();
+};
\ No newline at end of file
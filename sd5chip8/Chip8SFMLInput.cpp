@@ -0,0 +1,112 @@
+#include "Chip8SFMLInput.h"
+
+#include "Chip8Keyboard.h"
+
+
+namespace
+{
+	/**
+	* Contains a collection of SFML keys whose index values match their corrisponding Chip-8 key code.
+	*/
+	const sf::Keyboard::Key keys[16] = {
+		sf::Keyboard::X,	// 0
+		sf::Keyboard::Num1, // 1
+		sf::Keyboard::Num2,	// 2
+		sf::Keyboard::Num3, // 3
+		sf::Keyboard::Q,	// 4
+		sf::Keyboard::W,	// 5
+		sf::Keyboard::E,	// 6
+		sf::Keyboard::A,	// 7
+		sf::Keyboard::S,	// 8
+		sf::Keyboard::D,	// 9
+		sf::Keyboard::Z,	// A
+		sf::Keyboard::C,	// B
+		sf::Keyboard::Num4,	// C
+		sf::Keyboard::R,	// D
+		sf::Keyboard::F,	// E
+		sf::Keyboard::V		// F
+	};
+}
+
+
+Chip8SFMLInput::Chip8SFMLInput()
+{
+}
+
+
+Chip8SFMLInput::~Chip8SFMLInput()
+{
+}
+
+
+void Chip8SFMLInput::HandleEvent(const sf::Event& event)
+{
+	KeyEvent keyEvent = {};
+	switch (event.type)
+	{
+	case sf::Event::KeyPressed:
+		if (MapKey(event.key.code, &keyEvent.key))
+		{
+			keyEvent.type = KeyEvent::Pressed;
+			events_.push_back(keyEvent);
+		}
+		break;
+
+	case sf::Event::KeyReleased:
+		if (MapKey(event.key.code, &keyEvent.key))
+		{
+			keyEvent.type = KeyEvent::Released;
+			events_.push_back(keyEvent);
+		}
+		break;
+
+	// We won't get the release events for keys held while the window is out of focus.
+	case sf::Event::LostFocus:
+		keyEvent.type = KeyEvent::ReleasedAll;
+		events_.push_back(keyEvent);
+		break;
+
+	// Other events don't concern the keyboard.
+	default:
+		break;
+	}
+}
+
+
+void Chip8SFMLInput::PollInput(Chip8Keyboard& keyboard)
+{
+	for (const auto& keyEvent : events_)
+	{
+		if (keyEvent.type == KeyEvent::ReleasedAll)
+		{
+			// Keys pressed since the last update still show for a frame.
+			keyboard.SetHeldKeys(0);
+		}
+		else
+		{
+			keyboard.SetKey(keyEvent.key, (keyEvent.type == KeyEvent::Pressed));
+		}
+	}
+
+	events_.clear();
+}
+
+
+bool Chip8SFMLInput::MapKey(sf::Keyboard::Key code, u8* outKey)
+{
+	for (u8 i = 0; i < 16; ++i)
+	{
+		if (keys[i] == code)
+		{
+			if (outKey != nullptr)
+			{
+				*outKey = i;
+			}
+
+			return true;
+		}
+	}
+
+	// Not a Chip-8 key.
+	return false;
+}
\ No newline at end of file
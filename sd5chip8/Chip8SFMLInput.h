@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Chip8InputBackend.h"
+#include "Chip8Types.h"
+
+#include <vector>
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+/**
+* Maps the key events of an SFML window onto the Chip-8 keyboard.
+* The events are kept until the emulator polls for them, so none pressed and released within a frame are lost.
+*/
+class Chip8SFMLInput : public Chip8InputBackend
+{
+public:
+	Chip8SFMLInput();
+	~Chip8SFMLInput();
+
+	/**
+	* Handles a window event, keeping it for the next poll if it is a key event.
+	* Must be called from the thread that runs the emulator.
+	*/
+	void HandleEvent(const sf::Event& event);
+
+	void PollInput(Chip8Keyboard& keyboard) override;
+
+	/**
+	* Writes the Chip-8 key code mapped to an SFML key to outKey and returns true.
+	* If the SFML key isn't mapped to a Chip-8 key, false is returned and outKey is not modified.
+	*/
+	static bool MapKey(sf::Keyboard::Key code, u8* outKey);
+
+private:
+	/**
+	* A key press or release waiting for the next poll.
+	*/
+	struct KeyEvent
+	{
+		enum Type : u8
+		{
+			Pressed,
+			Released,
+			ReleasedAll	// The window lost focus, so the releases of the keys held down won't arrive
+		};
+
+		Type type;
+		u8 key;
+	};
+
+	std::vector<KeyEvent> events_;
+};
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "Chip8SFMLVideo.h"
+
+#include "Chip8Display.h"
+
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+
+Chip8SFMLVideo::Chip8SFMLVideo(sf::RenderTarget& target, const sf::Font* font, const sf::Color& displayColor, const sf::Color& backColor) :
+target_(target),
+font_(font),
+displayColor_(displayColor),
+backColor_(backColor)
+{
+}
+
+
+Chip8SFMLVideo::~Chip8SFMLVideo()
+{
+}
+
+
+void Chip8SFMLVideo::Clear()
+{
+	target_.clear(sf::Color(0, 0, 0));
+}
+
+
+void Chip8SFMLVideo::DrawDisplay(const Chip8Display& display)
+{
+	// Clear the screen to the background color.
+	target_.clear(backColor_);
+
+	const auto w = display.GetWidth();
+	const auto h = display.GetHeight();
+
+	// Calculate individual pixel size from size of target view
+	const auto pixWidth = target_.getView().getSize().x / static_cast<float>(w);
+	const auto pixHeight = target_.getView().getSize().y / static_cast<float>(h);
+
+	// Set the pixel color and size
+	sf::RectangleShape pixRect;
+	pixRect.setFillColor(displayColor_);
+	pixRect.setSize(sf::Vector2f(pixWidth, pixHeight));
+
+	// Draw active pixels.
+	for (u8 y = 0; y < h; ++y)
+	{
+		const auto row = display.GetRow(y);
+		for (u8 x = 0; x < w; ++x)
+		{
+			// If this pixel is on at this loc, draw it. (The leftmost pixel is the row's most significant bit.)
+			if ((row & (1ULL << (63 - x))) != 0)
+			{
+				pixRect.setPosition(sf::Vector2f(x * pixWidth, y * pixHeight));
+				target_.draw(pixRect);
+			}
+		}
+	}
+}
+
+
+void Chip8SFMLVideo::DrawDebugText(Chip8DebugPanel panel, const std::string& text)
+{
+	if (font_ == nullptr)
+	{
+		// Nothing to draw the text with.
+		return;
+	}
+
+	// The CPU info goes at the top, the debugger below it and the frame stats at the bottom.
+	sf::Vector2f position(0.0f, 0.0f);
+	switch (panel)
+	{
+	case Chip8DebugPanel::CPU:
+		break;
+
+	case Chip8DebugPanel::Debugger:
+		position.y = 80.0f;
+		break;
+
+	case Chip8DebugPanel::FrameStats:
+		position.y = target_.getView().getSize().y - 60.0f;
+		break;
+	}
+
+	sf::Text debugText;
+	debugText.setPosition(position);
+	debugText.setCharacterSize(14);
+	debugText.setFont(*font_);
+	debugText.setColor(sf::Color(255, 0, 0));
+	debugText.setString(text);
+	target_.draw(debugText);
+}
+
+
+void Chip8SFMLVideo::SetDisplayColor(const sf::Color& color)
+{
+	displayColor_ = color;
+}
+
+
+sf::Color Chip8SFMLVideo::GetDisplayColor() const
+{
+	return displayColor_;
+}
+
+
+void Chip8SFMLVideo::SetBackgroundColor(const sf::Color& color)
+{
+	backColor_ = color;
+}
+
+
+sf::Color Chip8SFMLVideo::GetBackgroundColor() const
+{
+	return backColor_;
+}
\ No newline at end of file
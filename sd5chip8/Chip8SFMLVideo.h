@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Chip8VideoBackend.h"
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+
+/**
+* Draws the emulator's video onto an SFML render target, such as a window.
+*/
+class Chip8SFMLVideo : public Chip8VideoBackend
+{
+public:
+	/**
+	* Creates a backend drawing to a render target.
+	* A font can be specified which will be used for the debug info (optional - pass null if not needed)
+	*/
+	Chip8SFMLVideo(
+		sf::RenderTarget& target,
+		const sf::Font* font = nullptr,
+		const sf::Color& displayColor = sf::Color(255, 255, 255),
+		const sf::Color& backColor = sf::Color(0, 0, 0)
+		);
+	~Chip8SFMLVideo();
+
+	void Clear() override;
+
+	/**
+	* Draws the display scaled to fill the view of the target.
+	*/
+	void DrawDisplay(const Chip8Display& display) override;
+
+	/**
+	* Draws a debug info panel if there is a font to draw it with.
+	*/
+	void DrawDebugText(Chip8DebugPanel panel, const std::string& text) override;
+
+	/**
+	* Set the color of the display foreground.
+	*/
+	void SetDisplayColor(const sf::Color& color);
+
+	/**
+	* Gets the current color of the display foreground.
+	*/
+	sf::Color GetDisplayColor() const;
+
+	/**
+	* Set the color of the display background.
+	*/
+	void SetBackgroundColor(const sf::Color& color);
+
+	/**
+	* Get the current color of the display background.
+	*/
+	sf::Color GetBackgroundColor() const;
+
+private:
+	sf::RenderTarget& target_;
+	const sf::Font* font_;
+
+	sf::Color displayColor_, backColor_;
+};
\ No newline at end of file
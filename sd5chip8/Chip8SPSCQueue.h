@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+* A fixed-size, lock-free queue for passing values from one producer thread to one consumer thread.
+* Capacity must be a power of two. Only one thread may push and only one thread may pop.
+*/
+template <typename T, size_t Capacity>
+class Chip8SPSCQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Chip8SPSCQueue capacity must be a power of two!");
+
+public:
+	Chip8SPSCQueue() :
+	head_(0),
+	tail_(0)
+	{
+	}
+
+	/**
+	* Pushes a value onto the back of the queue. Must only be called from the producer thread.
+	* Returns true on success, false if the queue is full.
+	*/
+	bool TryPush(const T& val)
+	{
+		const auto tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) >= Capacity)
+		{
+			// Queue is full.
+			return false;
+		}
+
+		buf_[tail & (Capacity - 1)] = val;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	* Pops the value at the front of the queue into outVal. Must only be called from the consumer thread.
+	* Returns true on success, false if the queue is empty.
+	*/
+	bool TryPop(T* outVal)
+	{
+		const auto head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire))
+		{
+			// Queue is empty.
+			return false;
+		}
+
+		*outVal = buf_[head & (Capacity - 1)];
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	* Returns whether or not the queue is currently empty.
+	* The result may be out of date by the time it is used if the other thread is active.
+	*/
+	bool IsEmpty() const
+	{
+		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+	}
+
+private:
+	std::array<T, Capacity> buf_;
+
+	// Keep the consumer and producer indices on separate cache lines so the threads don't fight over them.
+	alignas(64) std::atomic<size_t> head_;
+	alignas(64) std::atomic<size_t> tail_;
+};
\ No newline at end of file
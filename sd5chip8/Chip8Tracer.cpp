@@ -0,0 +1,260 @@
+#include "Chip8Tracer.h"
+
+#include <cstring>
+
+
+namespace
+{
+	const u8 traceMagic[4] = { 'C', '8', 'T', 'R' };
+	const u8 traceVersion = 1;
+	const size_t headerSize = 8;
+}
+
+
+Chip8Tracer::Chip8Tracer() :
+bufferSize_(0),
+lastPC_(0),
+recordCount_(0),
+pendingSize_(0),
+isClosing_(false),
+hasWriteFailed_(false)
+{
+}
+
+
+Chip8Tracer::~Chip8Tracer()
+{
+	Close();
+}
+
+
+bool Chip8Tracer::Open(const std::string& fileName)
+{
+	Close();
+
+	file_.open(fileName, std::ios_base::binary | std::ios_base::trunc);
+	if (!file_.is_open())
+	{
+		return false;
+	}
+
+	const u8 header[headerSize] = { traceMagic[0], traceMagic[1], traceMagic[2], traceMagic[3], traceVersion, 0, 0, 0 };
+	file_.write(reinterpret_cast<const char*>(header), headerSize);
+
+	buffer_.resize(CHIP8_TRACE_BUFFER_SIZE);
+	pending_.resize(CHIP8_TRACE_BUFFER_SIZE);
+	bufferSize_ = 0;
+	pendingSize_ = 0;
+	std::memset(&last_, 0, sizeof(last_));
+	lastPC_ = 0;
+	recordCount_ = 0;
+	isClosing_ = false;
+	hasWriteFailed_ = !file_.good();
+
+	writerThread_ = std::thread(&Chip8Tracer::RunWriter, this);
+	return true;
+}
+
+
+bool Chip8Tracer::Close()
+{
+	if (!IsOpen())
+	{
+		return true;
+	}
+
+	Flush();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isClosing_ = true;
+	}
+	condition_.notify_all();
+	writerThread_.join();
+
+	file_.close();
+	const auto isOK = !hasWriteFailed_ && !file_.fail();
+
+	buffer_ = std::vector<u8>();
+	pending_ = std::vector<u8>();
+	return isOK;
+}
+
+
+bool Chip8Tracer::IsOpen() const
+{
+	return file_.is_open();
+}
+
+
+u64 Chip8Tracer::GetRecordCount() const
+{
+	return recordCount_;
+}
+
+
+void Chip8Tracer::Flush()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	// Only wait if the writer has fallen a whole buffer behind.
+	condition_.wait(lock, [this] { return pendingSize_ == 0; });
+
+	buffer_.swap(pending_);
+	pendingSize_ = bufferSize_;
+	bufferSize_ = 0;
+
+	lock.unlock();
+	condition_.notify_all();
+}
+
+
+void Chip8Tracer::RunWriter()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true)
+	{
+		condition_.wait(lock, [this] { return pendingSize_ != 0 || isClosing_; });
+		if (pendingSize_ == 0)
+		{
+			// Closing, and everything has been written.
+			return;
+		}
+
+		// The emulation thread won't touch pending_ until pendingSize_ is 0 again.
+		const auto size = pendingSize_;
+		lock.unlock();
+		file_.write(reinterpret_cast<const char*>(pending_.data()), size);
+		const auto isGood = file_.good();
+		lock.lock();
+
+		hasWriteFailed_ = hasWriteFailed_ || !isGood;
+		pendingSize_ = 0;
+		condition_.notify_all();
+	}
+}
+
+
+Chip8TraceReader::Chip8TraceReader() :
+pos_(0)
+{
+}
+
+
+Chip8TraceReader::~Chip8TraceReader()
+{
+}
+
+
+bool Chip8TraceReader::Open(const std::string& fileName)
+{
+	if (!file_.Open(fileName))
+	{
+		return false;
+	}
+
+	const auto data = file_.GetData();
+	if (file_.GetSize() < headerSize || std::memcmp(data, traceMagic, sizeof(traceMagic)) != 0 || data[4] != traceVersion)
+	{
+		file_.Close();
+		return false;
+	}
+
+	pos_ = headerSize;
+	std::memset(&record_, 0, sizeof(record_));
+	return true;
+}
+
+
+bool Chip8TraceReader::Next(Chip8TraceRecord* outRecord)
+{
+	const auto data = file_.GetData();
+	const auto size = file_.GetSize();
+	auto pos = pos_;
+
+	// Fails if a record runs off the end of the file.
+	const auto readByte = [&](u8* outVal) {
+		if (pos >= size)
+		{
+			return false;
+		}
+		*outVal = data[pos++];
+		return true;
+	};
+
+	u8 hi, lo;
+	if (!readByte(&hi) || !readByte(&lo))
+	{
+		return false;
+	}
+
+	const u16 op = (hi << 8) | lo;
+
+	u32 changed = 0;
+	u8 byte;
+	unsigned int shift = 0;
+	do
+	{
+		if (shift > 28 || !readByte(&byte))
+		{
+			return false;
+		}
+
+		changed |= static_cast<u32>(byte & 0x7F) << shift;
+		shift += 7;
+	} while ((byte & 0x80) != 0);
+
+	auto record = record_;
+	record.PC += 2;
+	if ((changed & CHIP8_TRACE_JUMPED) != 0)
+	{
+		if (!readByte(&lo) || !readByte(&hi))
+		{
+			return false;
+		}
+		record.PC = (hi << 8) | lo;
+	}
+
+	for (u8 i = 0; i < 16; ++i)
+	{
+		if ((changed & (1 << i)) != 0 && !readByte(&record.registers.V[i]))
+		{
+			return false;
+		}
+	}
+
+	if ((changed & CHIP8_TRACE_CHANGED_I) != 0)
+	{
+		if (!readByte(&lo) || !readByte(&hi))
+		{
+			return false;
+		}
+		record.registers.I = (hi << 8) | lo;
+	}
+
+	if (((changed & CHIP8_TRACE_CHANGED_SP) != 0 && !readByte(&record.registers.SP))
+		|| ((changed & CHIP8_TRACE_CHANGED_DT) != 0 && !readByte(&record.registers.DT))
+		|| ((changed & CHIP8_TRACE_CHANGED_ST) != 0 && !readByte(&record.registers.ST)))
+	{
+		return false;
+	}
+
+	// The first record's cycle is 0.
+	record.cycle = (pos_ == headerSize ? 0 : record_.cycle + 1);
+	record.op = op;
+	record.changed = changed;
+
+	record_ = record;
+	pos_ = pos;
+	if (outRecord != nullptr)
+	{
+		*outRecord = record;
+	}
+	return true;
+}
+
+
+bool Chip8TraceReader::IsAtEnd() const
+{
+	return (pos_ >= file_.GetSize());
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Chip8Constants.h"
+#include "Chip8CPU.h"
+#include "Chip8MappedFile.h"
+#include "Chip8Types.h"
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHIP8_TRACE_CHANGED_I (1 << 16)
+#define CHIP8_TRACE_CHANGED_SP (1 << 17)
+#define CHIP8_TRACE_CHANGED_DT (1 << 18)
+#define CHIP8_TRACE_CHANGED_ST (1 << 19)
+#define CHIP8_TRACE_JUMPED (1 << 20) // The instruction didn't follow the previous one in memory
+
+/**
+* An executed instruction read back from a trace.
+*/
+struct Chip8TraceRecord
+{
+	u64 cycle; // The index of the instruction in the trace
+	u16 PC;
+	u16 op;
+	u32 changed; // Bits 0-15 for V0-VF and CHIP8_TRACE_CHANGED_* for the rest
+	Chip8CPURegisters registers; // The registers after the instruction (PC and the stack aren't traced)
+};
+
+
+/**
+* Records the instructions a CPU executes to a trace file.
+*
+* Each record is the opcode, followed by a varint of which registers the instruction changed and their
+* new values - PC is only stored when it doesn't follow on from the previous instruction, and the cycle
+* is implied by the record's position, so most records take 3 or 4 bytes. Records go into a buffer owned
+* by the emulation thread, which is handed to a writer thread to write out whenever it fills up.
+*
+* The layout is the magic "C8TR", a u8 version and 3 reserved bytes, then the records.
+*/
+class Chip8Tracer
+{
+public:
+	Chip8Tracer();
+	~Chip8Tracer();
+
+	Chip8Tracer(const Chip8Tracer&) = delete;
+	Chip8Tracer& operator=(const Chip8Tracer&) = delete;
+
+	/**
+	* Creates a trace file and starts the writer thread, closing any trace that is already open.
+	* Returns true on success, false on failure.
+	*/
+	bool Open(const std::string& fileName);
+
+	/**
+	* Writes out the remaining records and closes the trace.
+	* Returns true if every record was written, false otherwise.
+	*/
+	bool Close();
+
+	/**
+	* Returns whether or not a trace is open.
+	*/
+	bool IsOpen() const;
+
+	/**
+	* Gets the amount of records written.
+	*/
+	u64 GetRecordCount() const;
+
+	/**
+	* Records an instruction executed at pc, and the registers it left behind.
+	*/
+	inline void Record(u16 pc, u16 op, const Chip8CPURegisters& reg)
+	{
+		if (bufferSize_ + maxRecordSize > buffer_.size())
+		{
+			Flush();
+		}
+
+		u32 changed = (pc != static_cast<u16>(lastPC_ + 2) ? CHIP8_TRACE_JUMPED : 0);
+		for (u8 i = 0; i < 16; ++i)
+		{
+			changed |= static_cast<u32>(reg.V[i] != last_.V[i]) << i;
+		}
+		changed |= (reg.I != last_.I ? CHIP8_TRACE_CHANGED_I : 0);
+		changed |= (reg.SP != last_.SP ? CHIP8_TRACE_CHANGED_SP : 0);
+		changed |= (reg.DT != last_.DT ? CHIP8_TRACE_CHANGED_DT : 0);
+		changed |= (reg.ST != last_.ST ? CHIP8_TRACE_CHANGED_ST : 0);
+
+		auto out = buffer_.data() + bufferSize_;
+		*out++ = static_cast<u8>(op >> 8);
+		*out++ = static_cast<u8>(op);
+
+		// Changes are rare, so write the mask as a varint (one byte for most instructions).
+		auto mask = changed;
+		while (mask >= 0x80)
+		{
+			*out++ = static_cast<u8>(mask | 0x80);
+			mask >>= 7;
+		}
+		*out++ = static_cast<u8>(mask);
+
+		if ((changed & CHIP8_TRACE_JUMPED) != 0)
+		{
+			*out++ = static_cast<u8>(pc);
+			*out++ = static_cast<u8>(pc >> 8);
+		}
+
+		for (u8 i = 0; i < 16; ++i)
+		{
+			if ((changed & (1 << i)) != 0)
+			{
+				*out++ = reg.V[i];
+			}
+		}
+
+		if ((changed & CHIP8_TRACE_CHANGED_I) != 0)
+		{
+			*out++ = static_cast<u8>(reg.I);
+			*out++ = static_cast<u8>(reg.I >> 8);
+		}
+		if ((changed & CHIP8_TRACE_CHANGED_SP) != 0) *out++ = reg.SP;
+		if ((changed & CHIP8_TRACE_CHANGED_DT) != 0) *out++ = reg.DT;
+		if ((changed & CHIP8_TRACE_CHANGED_ST) != 0) *out++ = reg.ST;
+
+		bufferSize_ = out - buffer_.data();
+		last_ = reg;
+		lastPC_ = pc;
+		++recordCount_;
+	}
+
+private:
+	static const size_t maxRecordSize = 32;
+
+	std::ofstream file_;
+	std::thread writerThread_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+
+	// Owned by the emulation thread.
+	std::vector<u8> buffer_;
+	size_t bufferSize_;
+	Chip8CPURegisters last_;
+	u16 lastPC_;
+	u64 recordCount_;
+
+	// Owned by the writer thread while pendingSize_ isn't 0, guarded by mutex_.
+	std::vector<u8> pending_;
+	size_t pendingSize_;
+	bool isClosing_;
+	bool hasWriteFailed_;
+
+	/**
+	* Hands the buffered records to the writer thread, waiting for it to finish the previous ones first.
+	*/
+	void Flush();
+
+	/**
+	* The writer thread - writes out buffers as they are handed to it.
+	*/
+	void RunWriter();
+};
+
+
+/**
+* Reads back a trace written by Chip8Tracer.
+*/
+class Chip8TraceReader
+{
+public:
+	Chip8TraceReader();
+	~Chip8TraceReader();
+
+	/**
+	* Maps a trace file and checks its header, closing any trace that is already open.
+	* Returns true on success, false on failure.
+	*/
+	bool Open(const std::string& fileName);
+
+	/**
+	* Reads the next record.
+	* Returns true on success, false at the end of the trace or if the trace is truncated.
+	*/
+	bool Next(Chip8TraceRecord* outRecord);
+
+	/**
+	* Returns whether or not the whole trace has been read.
+	*/
+	bool IsAtEnd() const;
+
+private:
+	Chip8MappedFile file_;
+	size_t pos_;
+	Chip8TraceRecord record_;
+};
\ No newline at end of file
@@ -3,4 +3,7 @@
 #include <cstdint>
 
 typedef uint8_t	u8;
-typedef uint16_t u16;
\ No newline at end of file
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int16_t s16;
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Chip8Types.h"
+
+#include <string>
+
+class Chip8Display;
+
+/**
+* The debug info panels drawn over the display while in debug mode.
+*/
+enum class Chip8DebugPanel : u8
+{
+	CPU,		// The registers and the last executed opcode
+	Debugger,	// The debugger state, the disassembly around PC and the memory at I
+	FrameStats	// The frame timing stats
+};
+
+
+/**
+* Interface for the destination of the emulator's video, such as a window.
+* Called from the thread that runs the emulator, once per frame that has something new to show.
+*/
+class Chip8VideoBackend
+{
+public:
+	virtual ~Chip8VideoBackend() {}
+
+	/**
+	* Clears the frame, as nothing is shown while no program is loaded.
+	*/
+	virtual void Clear() = 0;
+
+	/**
+	* Draws the Chip-8 display onto the frame.
+	*/
+	virtual void DrawDisplay(const Chip8Display& display) = 0;
+
+	/**
+	* Draws a debug info panel over the display. Backends that can't draw text can ignore it.
+	*/
+	virtual void DrawDebugText(Chip8DebugPanel /*panel*/, const std::string& /*text*/) {}
+};
\ No newline at end of file
@@ -1,10 +1,210 @@
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
 
-#include <SFML\Graphics\RenderWindow.hpp>
-#include <SFML\Window\Event.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Window/Event.hpp>
 
 #include "Chip8.h"
+#include "Chip8Platform.h"
+#include "Chip8Quirks.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomCache.h"
+#include "Chip8RomPack.h"
+#include "Chip8SFMLAudioStream.h"
+#include "Chip8SFMLInput.h"
+#include "Chip8SFMLVideo.h"
+
+
+typedef std::chrono::steady_clock StartupClock;
+
+/**
+* Options the emulator was started with.
+*/
+struct EmulatorOptions
+{
+	std::string programFileName;
+	std::string packFileName; // If set, programFileName is the name or hash of a program in this pack.
+	bool isPlatformGiven = false;
+	Chip8Platform platform = Chip8Platform::Chip8;
+	bool isQuirksGiven = false;
+	u32 quirks = CHIP8_QUIRKS_DEFAULT;
+	u32 stepsPerFrame = 0; // 0 for the platform's default
+	unsigned long frames = 0; // 0 to run until the window is closed
+	bool isMuted = false;
+	bool isDebugging = false;
+};
+
+
+/**
+* A program read from disk, and the platform, quirks and speed picked for it, ready to be loaded.
+*/
+struct PreparedProgram
+{
+	std::shared_ptr<const Chip8RomImage> image;
+	std::unique_ptr<Chip8RomPack> pack; // Set instead of image if the program is in a pack.
+	Chip8RomAnalysis analysis;
+	std::string error;
+	StartupClock::duration loadTime;
+};
+
+
+/**
+* An audio backend that drops the beep, for running with the sound off.
+*/
+class MutedAudioBackend : public Chip8AudioBackend
+{
+public:
+	bool PushEvent(const Chip8AudioEvent&) override { return true; }
+};
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <program>" << std::endl
+		<< "       " << programName << " [options] <pack" CHIP8_ROM_PACK_EXTENSION ">:<name or hash>" << std::endl
+		<< "Runs a Chip-8 program in a window. The platform, quirks and speed are detected unless they are given." << std::endl
+		<< "To run programs without a window or audio device, use sd5chip8-headless." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --platform <p> Platform the program is for (chip8, eti660, hires, schip or xochip, default: detected)" << std::endl
+		<< "  --quirks <q>   Quirk profile (default, vip, chip48, schip or xochip) or flags (default: detected)" << std::endl
+		<< "                 Programs from packs run on the platform and with the quirks recorded for them in the pack." << std::endl
+		<< "  --steps <n>    Instructions run per frame, which sets the speed (default: the platform's)" << std::endl
+		<< "  --frames <n>   Exit after n frames rather than when the window is closed" << std::endl
+		<< "  --mute         Never open the audio device" << std::endl
+		<< "  --debug        Start with the debug panels shown" << std::endl;
+}
+
+
+/**
+* Parses the command line.
+* Returns true on success, false if it is invalid.
+*/
+static bool ParseOptions(int argc, char* argv[], EmulatorOptions* outOptions)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--platform") == 0 && hasValue)
+		{
+			if (!Chip8PlatformHelper::Parse(argv[++i], &outOptions->platform))
+			{
+				std::cerr << "Unknown platform \"" << argv[i] << "\"." << std::endl;
+				return false;
+			}
+
+			outOptions->isPlatformGiven = true;
+		}
+		else if (std::strcmp(argv[i], "--quirks") == 0 && hasValue)
+		{
+			if (!Chip8QuirksHelper::Parse(argv[++i], &outOptions->quirks))
+			{
+				std::cerr << "Unknown quirk profile \"" << argv[i] << "\"." << std::endl;
+				return false;
+			}
+
+			outOptions->isQuirksGiven = true;
+		}
+		else if (std::strcmp(argv[i], "--steps") == 0 && hasValue)
+		{
+			outOptions->stepsPerFrame = static_cast<u32>(std::strtoul(argv[++i], nullptr, 0));
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			outOptions->frames = std::strtoul(argv[++i], nullptr, 0);
+		}
+		else if (std::strcmp(argv[i], "--mute") == 0)
+		{
+			outOptions->isMuted = true;
+		}
+		else if (std::strcmp(argv[i], "--debug") == 0)
+		{
+			outOptions->isDebugging = true;
+		}
+		else if (argv[i][0] == '-' || !outOptions->programFileName.empty())
+		{
+			return false;
+		}
+		else
+		{
+			outOptions->programFileName = argv[i];
+		}
+	}
+
+	if (outOptions->programFileName.empty())
+	{
+		return false;
+	}
+
+	// Check if the program is in a pack.
+	const auto packSeparatorPos = outOptions->programFileName.find(CHIP8_ROM_PACK_EXTENSION ":");
+	if (packSeparatorPos != std::string::npos)
+	{
+		const auto packNamePos = packSeparatorPos + sizeof(CHIP8_ROM_PACK_EXTENSION ":") - 1;
+		outOptions->packFileName = outOptions->programFileName.substr(0, packNamePos - 1);
+		outOptions->programFileName = outOptions->programFileName.substr(packNamePos);
+	}
+
+	return true;
+}
+
+
+/**
+* Reads the program (or opens its pack) and picks the platform, quirks and speed to run it with.
+* Only touches the disk and the program cache, so it can run while the window is being created.
+*/
+static PreparedProgram PrepareProgram(const EmulatorOptions& options)
+{
+	const auto startTime = StartupClock::now();
+	PreparedProgram program;
+
+	if (!options.packFileName.empty())
+	{
+		program.pack = std::make_unique<Chip8RomPack>();
+		if (!program.pack->Open(options.packFileName))
+		{
+			program.error = "Failed to open program pack \"" + options.packFileName + "\".";
+		}
+	}
+	else
+	{
+		Chip8RomLoadResult loadResult;
+		program.image = Chip8RomCache::GetShared().Load(options.programFileName, CHIP8_ROM_MAX_SIZE, &loadResult);
+		if (program.image == nullptr)
+		{
+			program.error = "Failed to load program \"" + options.programFileName + "\" - " + Chip8RomCache::GetResultText(loadResult) + ".";
+		}
+		else if (options.isPlatformGiven)
+		{
+			program.analysis = Chip8RomAnalysis();
+			program.analysis.platform = options.platform;
+			program.analysis.quirks = Chip8QuirksHelper::GetPlatformQuirks(options.platform);
+			program.analysis.stepsPerFrame = Chip8PlatformHelper::GetStepsPerFrame(options.platform);
+		}
+		else
+		{
+			program.analysis = Chip8RomAnalyzer::Analyze(program.image->data.data(), program.image->data.size());
+		}
+
+		if (options.isQuirksGiven)
+		{
+			program.analysis.quirks = options.quirks;
+		}
+	}
+
+	program.loadTime = StartupClock::now() - startTime;
+	return program;
+}
 
 
 /**
@@ -12,6 +212,8 @@
 */
 int main(int argc, char* argv[])
 {
+	const auto startTime = StartupClock::now();
+
 #ifdef CHIP8_RELEASE
 	std::cout << "SD5 Chip-8 [Release]";
 #elif CHIP8_DEBUG
@@ -21,44 +223,103 @@ int main(int argc, char* argv[])
 #endif
 	std::cout << std::endl << std::endl;
 
-	// Ask for program name as input.
-	std::cout << "Specify program to load: ";
-	std::string programFileName;
-	getline(std::cin, programFileName);
+	EmulatorOptions options;
+	if (!ParseOptions(argc, argv, &options))
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Creating the window is the slowest part of starting up, and has to happen on this thread -
+	// read the program and load the font on others in the meantime.
+	auto programFuture = std::async(std::launch::async, PrepareProgram, std::cref(options));
+	auto fontFuture = std::async(std::launch::async, []()
+	{
+		const auto fontStartTime = StartupClock::now();
+		auto font = std::make_unique<sf::Font>();
+		if (!font->loadFromFile(CHIP8_EMULATOR_DEFAULT_FONT_FILENAME))
+		{
+			font.reset();
+		}
 
-	// Ask if program is for the ETI 660.
-	std::cout << "Is this an ETI 660 program? (Y / N): ";
-	const auto isETI660YN = tolower(getchar());
-	std::cout << std::endl;
+		return std::make_pair(std::move(font), StartupClock::now() - fontStartTime);
+	});
 
-	// Create window and Chip-8 emu instance.
-	auto window = sf::RenderWindow(
+	// Create window.
+	const auto windowStartTime = StartupClock::now();
+	sf::RenderWindow window(
 		sf::VideoMode(CHIP8_WINDOW_WIDTH, CHIP8_WINDOW_HEIGHT),
 		"SD5 Chip-8"
 		);
 
-	// Create default font.
-	sf::Font font;
-	const auto isFontLoaded = font.loadFromFile(CHIP8_EMULATOR_DEFAULT_FONT_FILENAME);
-	if (!isFontLoaded)
+	// Frames are paced by the emulator, so don't let vsync add its own wait on top.
+	window.setVerticalSyncEnabled(false);
+	const auto windowTime = StartupClock::now() - windowStartTime;
+
+	// Pick up the font.
+	auto fontResult = fontFuture.get();
+	const auto font = std::move(fontResult.first);
+	if (font == nullptr)
 	{
 		std::cerr << "Warning: Failed to load emulator font!" << std::endl;
 	}
 
-	// Create emulator instance and feed in font if it successfully loaded.
-	Chip8 chip8(window, (isFontLoaded ? &font : nullptr));
+	// Create the backends the emulator draws, beeps and reads keys through, feeding in the font if it successfully loaded.
+	Chip8SFMLVideo video(window, font.get());
+	Chip8SFMLInput input;
+
+	// The audio device is only opened once the program first beeps.
+	std::unique_ptr<Chip8AudioBackend> audio;
+	if (options.isMuted)
+	{
+		audio = std::make_unique<MutedAudioBackend>();
+	}
+	else
+	{
+		audio = std::make_unique<Chip8SFMLAudioStream>();
+	}
+
+	// Create emulator instance.
+	Chip8 chip8(video, std::move(audio), &input);
 #ifdef CHIP8_DEBUG
 	chip8.SetDebugMode(true);
 #endif
+	if (options.isDebugging)
+	{
+		chip8.SetDebugMode(true);
+	}
 
-	// Attempt to load program.
-	if (!chip8.LoadProgram(programFileName, (isETI660YN == 'y')))
+	// Load the program that was read while the window was created.
+	const auto program = programFuture.get();
+	if (!program.error.empty())
+	{
+		std::cerr << program.error << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (program.pack == nullptr)
+	{
+		std::cout << "Loading program \"" << options.programFileName << "\"..." << std::endl;
+	}
+
+	const auto isLoaded = (program.pack != nullptr ?
+		chip8.LoadProgram(*program.pack, options.programFileName) :
+		chip8.LoadProgram(program.image->data.data(), program.image->data.size(), program.analysis));
+	if (!isLoaded)
 	{
 		// Failed to load program.
 		std::cerr << "Program load error - exiting." << std::endl;
 		return EXIT_FAILURE;
 	}
 
+	if (options.stepsPerFrame != 0)
+	{
+		chip8.SetStepsPerFrame(options.stepsPerFrame);
+	}
+
+	bool isFirstFrameShown = false;
+	unsigned long frameCount = 0;
+
 	std::cout << "Running program..." << std::endl;
 	while (window.isOpen())
 	{
@@ -66,6 +327,9 @@ int main(int argc, char* argv[])
 		sf::Event event;
 		while (window.pollEvent(event))
 		{
+			// Pass key events on to the emulator's keyboard.
+			input.HandleEvent(event);
+
 			switch (event.type)
 			{
 			// Handle window close event by closing the window.
@@ -73,6 +337,12 @@ int main(int argc, char* argv[])
 				window.close();
 				break;
 
+			// The window contents may need drawing again, even if the program is idle.
+			case sf::Event::Resized:
+			case sf::Event::GainedFocus:
+				chip8.RequestRedraw();
+				break;
+
 			// Handle window key press.
 			case sf::Event::KeyPressed:
 				// F11 for soft reset.
@@ -85,6 +355,49 @@ int main(int argc, char* argv[])
 				{
 					chip8.SetDebugMode(!chip8.IsInDebugMode());
 				}
+				// F2 for dumping frame timing stats.
+				else if (event.key.code == sf::Keyboard::F2)
+				{
+					chip8.WriteFrameStats(CHIP8_FRAME_STATS_CSV_FILENAME, CHIP8_FRAME_SAMPLES_CSV_FILENAME);
+				}
+				// F5 to pause or continue.
+				else if (event.key.code == sf::Keyboard::F5)
+				{
+					if (chip8.GetDebugger().IsPaused())
+					{
+						chip8.GetDebugger().Continue();
+					}
+					else
+					{
+						chip8.GetDebugger().Pause();
+					}
+				}
+				// F6, F7 and F8 to step into, over and out of the instruction at PC.
+				else if (event.key.code == sf::Keyboard::F6)
+				{
+					chip8.GetDebugger().StepInto();
+				}
+				else if (event.key.code == sf::Keyboard::F7)
+				{
+					chip8.GetDebugger().StepOver();
+				}
+				else if (event.key.code == sf::Keyboard::F8)
+				{
+					chip8.GetDebugger().StepOut();
+				}
+				// F9 to toggle a breakpoint at PC.
+				else if (event.key.code == sf::Keyboard::F9)
+				{
+					chip8.ToggleBreakpointAtPC();
+				}
+				// F10 to start the GDB server.
+				else if (event.key.code == sf::Keyboard::F10)
+				{
+					chip8.StartGdbServer();
+				}
+				break;
+
+			default:
 				break;
 			}
 		}
@@ -96,8 +409,41 @@ int main(int argc, char* argv[])
 			return EXIT_FAILURE;
 		}
 
+		// Stop once the requested amount of frames have run, idle ones included.
+		const auto isLastFrame = (options.frames != 0 && ++frameCount >= options.frames);
+
+		if (chip8.IsIdle())
+		{
+			if (isLastFrame)
+			{
+				window.close();
+				continue;
+			}
+
+			// Program is blocked waiting for a key - sleep rather than displaying identical frames.
+			chip8.WaitForInput(std::chrono::milliseconds(CHIP8_IDLE_WAIT_MILLISECONDS));
+			continue;
+		}
+
 		// Display whats been drawn to the screen.
 		window.display();
+
+		if (!isFirstFrameShown)
+		{
+			// Report what startup took, as launchers wait on it.
+			typedef std::chrono::duration<double, std::milli> Milliseconds;
+			isFirstFrameShown = true;
+			std::cout << std::fixed << std::setprecision(1)
+				<< "First frame shown " << Milliseconds(StartupClock::now() - startTime).count() << " ms after starting (window: "
+				<< Milliseconds(windowTime).count() << " ms, alongside it font: " << Milliseconds(fontResult.second).count()
+				<< " ms and program: " << Milliseconds(program.loadTime).count() << " ms)." << std::endl
+				<< std::defaultfloat;
+		}
+
+		if (isLastFrame)
+		{
+			window.close();
+		}
 	}
 
 	std::cout << "Window closed - exiting." << std::endl;
@@ -0,0 +1,104 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Chip8Constants.h"
+#include "Chip8Quirks.h"
+#include "Chip8RomAnalyzer.h"
+
+/**
+* Regression tests for the ROM analyzer. Built with AddressSanitizer where the compiler supports it,
+* so scanning past the end of memory fails the test instead of silently overwriting the stack.
+*/
+
+
+/**
+* Analyzes a program made of one opcode repeated to fill size bytes.
+* Returns true if the analysis picked the expected platform, false if not.
+*/
+static bool CheckRepeatedOpcode(const char* testName, u16 op, size_t size, Chip8Platform expectedPlatform)
+{
+	std::vector<u8> program(size);
+	for (size_t i = 0; i + 1 < size; i += 2)
+	{
+		program[i] = static_cast<u8>(op >> 8);
+		program[i + 1] = static_cast<u8>(op & 0xFF);
+	}
+
+	const auto analysis = Chip8RomAnalyzer::Analyze(program.data(), program.size());
+	if (analysis.platform != expectedPlatform)
+	{
+		std::cerr << testName << ": expected platform " << Chip8PlatformHelper::GetName(expectedPlatform)
+			<< ", got " << Chip8PlatformHelper::GetName(analysis.platform) << "." << std::endl;
+		return false;
+	}
+
+	std::cout << testName << ": ok" << std::endl;
+	return true;
+}
+
+
+/**
+* Analyzes a program made of the given opcodes.
+* Returns true if the analysis picked the expected quirks, false if not.
+*/
+static bool CheckQuirks(const char* testName, const std::vector<u16>& ops, u32 expectedQuirks)
+{
+	std::vector<u8> program;
+	for (const auto op : ops)
+	{
+		program.push_back(static_cast<u8>(op >> 8));
+		program.push_back(static_cast<u8>(op & 0xFF));
+	}
+
+	const auto analysis = Chip8RomAnalyzer::Analyze(program.data(), program.size());
+	if (analysis.quirks != expectedQuirks)
+	{
+		std::cerr << testName << ": expected quirks 0x" << std::hex << expectedQuirks
+			<< ", got 0x" << analysis.quirks << "." << std::dec << std::endl;
+		return false;
+	}
+
+	std::cout << testName << ": ok" << std::endl;
+	return true;
+}
+
+
+int main()
+{
+	const size_t fittingSize = CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_START;
+
+	bool isOK = true;
+
+	// Straight line code (LD V1, 0x61) that runs to the end of the program.
+	isOK &= CheckRepeatedOpcode("fitting", 0x6161, fittingSize, Chip8Platform::Chip8);
+	isOK &= CheckRepeatedOpcode("one byte too large", 0x6161, fittingSize + 1, Chip8Platform::Chip8);
+	isOK &= CheckRepeatedOpcode("oversized", 0x6161, 10000, Chip8Platform::Chip8);
+	isOK &= CheckRepeatedOpcode("larger than the address space", 0x6161, 0x12000, Chip8Platform::Chip8);
+
+	// SCHIP code (SCD 1) running off the end of memory.
+	isOK &= CheckRepeatedOpcode("oversized schip", 0x00C1, 10000, Chip8Platform::SChip);
+
+	// No loads or stores at all.
+	isOK &= CheckQuirks("no loads or stores", { 0x6001, 0x7001, 0x1202 }, 0);
+
+	// Loading V0-V1, bumping V1, then writing them back to the same place only works if I stays put.
+	isOK &= CheckQuirks("load then store in place", { 0xA300, 0xF165, 0x7101, 0xF155, 0x1200 }, 0);
+
+	// Storing V0 twice without setting I in between only fills a table if I moves on.
+	isOK &= CheckQuirks("store walk", { 0xA300, 0x6001, 0xF055, 0x6002, 0xF055, 0x1208 },
+		CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I);
+
+	// Setting I again between the stores means they don't depend on it being incremented.
+	isOK &= CheckQuirks("store with I reset", { 0xA300, 0xF055, 0xA300, 0xF055, 0x1200 }, 0);
+
+	// Drawing after a load uses I, but works the same either way.
+	isOK &= CheckQuirks("load then draw", { 0xA300, 0xF065, 0xD015, 0x1200 }, 0);
+
+	// SCHIP programs keep the rest of their platform's quirks.
+	isOK &= CheckQuirks("schip store walk", { 0x00FF, 0xA300, 0xF055, 0xF055, 0x1202 },
+		CHIP8_QUIRKS_SCHIP | CHIP8_QUIRK_LOAD_STORE_INCREMENTS_I);
+
+	return (isOK ? EXIT_SUCCESS : EXIT_FAILURE);
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Chip8Constants.h"
+#include "Chip8Coverage.h"
+#include "Chip8Platform.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomCache.h"
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <program> <coverage" CHIP8_COVERAGE_EXTENSION ">..." << std::endl
+		<< "Merges the coverage of a program from any amount of runs and reports it." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --json <file>  Write a JSON report listing every instruction with its disassembly and coverage" << std::endl
+		<< "  --lcov <file>  Write an lcov tracefile (line numbers are instruction addresses)" << std::endl
+		<< "  -o <file>      Write the merged coverage to a " CHIP8_COVERAGE_EXTENSION " file" << std::endl
+		<< "  --eti          The program is an ETI 660 program (default: detected)" << std::endl
+		<< "  --chip8        The program is a Chip-8 program (default: detected)" << std::endl;
+}
+
+
+/**
+* Main entry point for the coverage tool.
+*/
+int main(int argc, char* argv[])
+{
+	std::string jsonFileName, lcovFileName, outputFileName, programFileName;
+	std::vector<std::string> coverageFileNames;
+	auto isPlatformGiven = false;
+	auto platform = Chip8Platform::Chip8;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+		{
+			jsonFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--lcov") == 0 && hasValue)
+		{
+			lcovFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "-o") == 0 && hasValue)
+		{
+			outputFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--eti") == 0 || std::strcmp(argv[i], "--chip8") == 0)
+		{
+			isPlatformGiven = true;
+			platform = (argv[i][2] == 'e' ? Chip8Platform::ETI660 : Chip8Platform::Chip8);
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else if (programFileName.empty())
+		{
+			programFileName = argv[i];
+		}
+		else
+		{
+			coverageFileNames.push_back(argv[i]);
+		}
+	}
+
+	if (programFileName.empty() || coverageFileNames.empty())
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	Chip8RomLoadResult loadResult;
+	const auto image = Chip8RomCache::GetShared().Load(programFileName, CHIP8_ROM_MAX_SIZE, &loadResult);
+	if (image == nullptr)
+	{
+		std::cerr << "Failed to load program \"" << programFileName << "\" - " << Chip8RomCache::GetResultText(loadResult) << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!isPlatformGiven)
+	{
+		platform = Chip8RomAnalyzer::Analyze(image->data.data(), image->data.size()).platform;
+	}
+
+	Chip8Coverage coverage, runCoverage;
+	for (const auto& fileName : coverageFileNames)
+	{
+		if (!runCoverage.Load(fileName))
+		{
+			std::cerr << "Failed to load coverage \"" << fileName << "\"." << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		coverage.Merge(runCoverage);
+	}
+
+	const u16 loadAddress = (Chip8PlatformHelper::IsETI660(platform) ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START);
+	std::cout << programFileName << ": " << coverage.GetExecutedCount() << " instruction addresses executed over "
+		<< coverageFileNames.size() << " runs." << std::endl;
+
+	if (!outputFileName.empty() && !coverage.Save(outputFileName))
+	{
+		std::cerr << "Failed to write coverage to \"" << outputFileName << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!jsonFileName.empty() && !coverage.WriteJSON(jsonFileName, programFileName, image->data.data(), image->data.size(), loadAddress))
+	{
+		std::cerr << "Failed to write the JSON report to \"" << jsonFileName << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!lcovFileName.empty() && !coverage.WriteLcov(lcovFileName, programFileName, image->data.data(), image->data.size(), loadAddress))
+	{
+		std::cerr << "Failed to write the lcov tracefile to \"" << lcovFileName << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Chip8Constants.h"
+#include "Chip8Disassembler.h"
+#include "Chip8Platform.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomCache.h"
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <program>" << std::endl
+		<< "Disassembles a Chip-8 program, separating code from data by following its control flow." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --dot          Write the control flow graph in the Graphviz DOT language instead of a listing" << std::endl
+		<< "  --eti          The program is an ETI 660 program (default: detected)" << std::endl
+		<< "  --chip8        The program is a Chip-8 program (default: detected)" << std::endl
+		<< "  --entry <a>    Also follow the code from this address, such as the target of a JP V0, addr" << std::endl;
+}
+
+
+/**
+* Main entry point for the disassembler.
+*/
+int main(int argc, char* argv[])
+{
+	auto isWritingDOT = false;
+	auto isPlatformGiven = false;
+	auto platform = Chip8Platform::Chip8;
+	std::vector<u16> extraEntryAddresses;
+	std::string programFileName;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--dot") == 0)
+		{
+			isWritingDOT = true;
+		}
+		else if (std::strcmp(argv[i], "--eti") == 0 || std::strcmp(argv[i], "--chip8") == 0)
+		{
+			isPlatformGiven = true;
+			platform = (argv[i][2] == 'e' ? Chip8Platform::ETI660 : Chip8Platform::Chip8);
+		}
+		else if (std::strcmp(argv[i], "--entry") == 0 && hasValue)
+		{
+			extraEntryAddresses.push_back(static_cast<u16>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (argv[i][0] == '-' || !programFileName.empty())
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{
+			programFileName = argv[i];
+		}
+	}
+
+	if (programFileName.empty())
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	Chip8RomLoadResult loadResult;
+	const auto image = Chip8RomCache::GetShared().Load(programFileName, CHIP8_ROM_MAX_SIZE, &loadResult);
+	if (image == nullptr)
+	{
+		std::cerr << "Failed to load program \"" << programFileName << "\" - " << Chip8RomCache::GetResultText(loadResult) << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Work out where the program is loaded and where it starts.
+	const auto analysis = Chip8RomAnalyzer::Analyze(image->data.data(), image->data.size());
+	if (!isPlatformGiven)
+	{
+		platform = analysis.platform;
+	}
+
+	const u16 loadAddress = (Chip8PlatformHelper::IsETI660(platform) ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START);
+	auto entryAddresses = extraEntryAddresses;
+	entryAddresses.insert(entryAddresses.begin(), loadAddress);
+
+	Chip8ControlFlowGraph cfg;
+	if (!cfg.Build(image->data.data(), image->data.size(), loadAddress, entryAddresses))
+	{
+		std::cerr << "Failed to disassemble program - is it too large, or is an entry point outside of it?" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (isWritingDOT)
+	{
+		cfg.WriteDOT(std::cout, programFileName);
+	}
+	else
+	{
+		std::cout << "; " << programFileName << " (" << Chip8PlatformHelper::GetName(platform) << ", " << image->data.size() << " bytes)" << std::endl;
+		cfg.WriteText(std::cout);
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,720 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Chip8Constants.h"
+#include "Chip8Coverage.h"
+#include "Chip8CPU.h"
+#include "Chip8Display.h"
+#include "Chip8Keyboard.h"
+#include "Chip8Memory.h"
+#include "Chip8Platform.h"
+#include "Chip8Quirks.h"
+#include "Chip8Random.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomCache.h"
+
+/**
+* An input to run a program with - the seed for the RND instruction and the keys held down during each frame.
+*
+* Saved inputs (all values little-endian) are the magic "C8FZ", a u8 version and 3 reserved bytes,
+* the u32 seed, the u32 frame count, then a u16 key mask for each frame.
+*/
+struct FuzzInput
+{
+	u32 seed;
+	std::vector<u16> keys;
+};
+
+
+/**
+* The program being fuzzed and how to run it.
+*/
+struct FuzzTarget
+{
+	std::shared_ptr<const Chip8RomImage> image;
+	Chip8Platform platform;
+	u32 quirks;
+	u32 frames;
+	Chip8RandomEngine randomEngine;
+};
+
+
+/**
+* The result of running an input.
+*/
+struct FuzzResult
+{
+	bool isOK;
+	u32 frames; // Frames run before the CPU error, if any.
+	u16 PC;
+	u16 op;
+};
+
+
+/**
+* Exec counter of a worker, aligned to its own cache line so workers don't contend for it.
+*/
+struct alignas(64) FuzzWorkerStats
+{
+	std::atomic<unsigned long long> execs;
+};
+
+
+/**
+* State shared by the workers. The corpus, the coverage seen so far and the crashes found are guarded by mutex.
+*/
+struct FuzzShared
+{
+	FuzzTarget target;
+	std::string crashPrefix;
+
+	std::mutex mutex;
+	std::vector<FuzzInput> corpus;
+	u8 seenEdges[CHIP8_COVERAGE_EDGE_MAP_SIZE];
+	u64 seenExecuted[CHIP8_MEMORY_SIZE / 64];
+	std::set<u32> crashes; // Crashes found, as (PC << 16) | opcode.
+
+	std::atomic<size_t> corpusSize;
+	std::atomic<bool> isStopping;
+	// The workers' counters, lined up with a cache line within statsStorage - new only aligns to
+	// alignof(std::max_align_t) before C++17.
+	std::unique_ptr<char[]> statsStorage;
+	FuzzWorkerStats* stats;
+};
+
+
+/**
+* A fast xorshift64* generator for picking and mutating inputs.
+*/
+class FuzzRandom
+{
+public:
+	explicit FuzzRandom(u64 seed) : state_(seed != 0 ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+	inline u32 Next()
+	{
+		state_ ^= state_ >> 12;
+		state_ ^= state_ << 25;
+		state_ ^= state_ >> 27;
+		return static_cast<u32>((state_ * 0x2545F4914F6CDD1DULL) >> 32);
+	}
+
+	/**
+	* Returns a value in [0, bound).
+	*/
+	inline u32 Next(u32 bound) { return static_cast<u32>((static_cast<u64>(Next()) * bound) >> 32); }
+
+private:
+	u64 state_;
+};
+
+
+/**
+* A machine to run inputs on, reset from a snapshot taken just after the program was loaded.
+* The CPU's messages go to log, or to the standard streams if null.
+*/
+class FuzzMachine
+{
+public:
+	FuzzMachine(const FuzzTarget& target, std::ostream* log) :
+	ram_(Chip8PlatformHelper::IsETI660(target.platform) ? CHIP8_MEMORY_ETI660_SIZE : CHIP8_MEMORY_SIZE),
+	cpu_(ram_, display_, keyboard_, nullptr, Chip8PlatformHelper::IsETI660(target.platform), target.quirks),
+	coverage_(std::make_unique<Chip8Coverage>())
+	{
+		const auto& data = target.image->data;
+		const u16 programStart = (Chip8PlatformHelper::IsETI660(target.platform) ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START);
+		isLoaded_ = (data.size() <= static_cast<size_t>(ram_.GetAllocatedSize() - programStart) &&
+			ram_.WriteBlock(programStart, data.data(), static_cast<u16>(data.size())));
+
+		cpu_.SetStepsPerFrame(Chip8PlatformHelper::GetStepsPerFrame(target.platform));
+		cpu_.SetRealTimeTimers(false);
+		cpu_.SetCoverage(coverage_.get());
+		cpu_.SetLogStream(log);
+		cpu_.SetRandomEngine(target.randomEngine);
+		cpu_.SaveState(&snapshot_);
+	}
+
+	/**
+	* Returns whether or not the program fit in memory.
+	*/
+	bool IsLoaded() const { return isLoaded_; }
+
+	/**
+	* Runs an input from the snapshot, recording its coverage.
+	*/
+	FuzzResult Run(const FuzzInput& input)
+	{
+		cpu_.RestoreState(snapshot_);
+		cpu_.SeedRandom(input.seed);
+		keyboard_.ReleaseAll();
+		coverage_->Clear();
+
+		for (u32 frame = 0; frame < input.keys.size(); ++frame)
+		{
+			keyboard_.SetHeldKeys(input.keys[frame]);
+			keyboard_.Update();
+			if (!cpu_.RunFrame())
+			{
+				return FuzzResult{ false, frame, cpu_.GetRegisters().PC, cpu_.GetLastOpcode() };
+			}
+		}
+
+		return FuzzResult{ true, static_cast<u32>(input.keys.size()), cpu_.GetRegisters().PC, cpu_.GetLastOpcode() };
+	}
+
+	/**
+	* Gets the coverage of the last run.
+	*/
+	const Chip8Coverage& GetCoverage() const { return *coverage_; }
+
+private:
+	Chip8Memory ram_;
+	Chip8Display display_;
+	Chip8Keyboard keyboard_;
+	Chip8CPU cpu_;
+	std::unique_ptr<Chip8Coverage> coverage_;
+	Chip8MachineState snapshot_;
+	bool isLoaded_;
+};
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <program>" << std::endl
+		<< "       " << programName << " [options] --replay <input" CHIP8_FUZZ_INPUT_EXTENSION "> <program>" << std::endl
+		<< "Runs a Chip-8 program with generated key input and RND seeds, keeping the inputs that reach new code" << std::endl
+		<< "and saving those that make the CPU fail (stack over/underflows, out of range accesses, unknown opcodes)." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --time <s>       Seconds to fuzz for (default: 60)" << std::endl
+		<< "  --jobs <n>       Worker threads (default: one per core)" << std::endl
+		<< "  --frames <n>     Frames each input runs for (default: 300)" << std::endl
+		<< "  --quirks <q>     Quirk profile or flags to run the program with (default: detected)" << std::endl
+		<< "  --rng <e>        Random number generator for the RND instruction (pcg, xorshift or cosmac, default: pcg)" << std::endl
+		<< "  --eti            The program is an ETI 660 program (default: detected)" << std::endl
+		<< "  --chip8          The program is a Chip-8 program (default: detected)" << std::endl
+		<< "  --crashes <p>    Prefix of the files crashing inputs are saved to (default: crash-)" << std::endl
+		<< "  --replay <file>  Run a saved input once and print its result" << std::endl;
+}
+
+
+/**
+* Saves an input to a file.
+* Returns true on success, false on failure.
+*/
+static bool SaveInput(const std::string& fileName, const FuzzInput& input)
+{
+	std::vector<u8> out = { 'C', '8', 'F', 'Z', 1, 0, 0, 0 };
+	const u32 frames = static_cast<u32>(input.keys.size());
+	for (int i = 0; i < 4; ++i)
+	{
+		out.push_back(static_cast<u8>(input.seed >> (i * 8)));
+	}
+	for (int i = 0; i < 4; ++i)
+	{
+		out.push_back(static_cast<u8>(frames >> (i * 8)));
+	}
+	for (const auto keys : input.keys)
+	{
+		out.push_back(static_cast<u8>(keys));
+		out.push_back(static_cast<u8>(keys >> 8));
+	}
+
+	auto file = std::ofstream(fileName, std::ios_base::binary);
+	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	return file.good();
+}
+
+
+/**
+* Loads an input saved by SaveInput().
+* Returns true on success, false on failure.
+*/
+static bool LoadInput(const std::string& fileName, FuzzInput* outInput)
+{
+	auto file = std::ifstream(fileName, std::ios_base::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const std::vector<u8> in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (in.size() < 16 || std::memcmp(in.data(), "C8FZ", 4) != 0 || in[4] != 1)
+	{
+		return false;
+	}
+
+	const auto read32 = [&in](size_t i) { return in[i] | (in[i + 1] << 8) | (in[i + 2] << 16) | (static_cast<u32>(in[i + 3]) << 24); };
+	const auto frames = read32(12);
+	if (in.size() != 16 + static_cast<size_t>(frames) * 2)
+	{
+		return false;
+	}
+
+	outInput->seed = read32(8);
+	outInput->keys.resize(frames);
+	for (u32 i = 0; i < frames; ++i)
+	{
+		outInput->keys[i] = static_cast<u16>(in[16 + i * 2] | (in[17 + i * 2] << 8));
+	}
+
+	return true;
+}
+
+
+/**
+* Applies 1 to 4 random mutations to an input: flipping, holding or releasing keys over spans of frames,
+* reseeding, or splicing in frames of another input from the corpus.
+*/
+static void Mutate(FuzzInput& input, const std::vector<FuzzInput>& corpus, FuzzRandom& rnd)
+{
+	const auto frames = static_cast<u32>(input.keys.size());
+	const auto mutations = 1 + rnd.Next(4);
+	for (u32 i = 0; i < mutations; ++i)
+	{
+		const auto start = rnd.Next(frames);
+		const auto end = std::min(frames, start + 1 + rnd.Next(32));
+		const auto keyBit = static_cast<u16>(1 << rnd.Next(16));
+
+		switch (rnd.Next(6))
+		{
+		case 0:
+			input.keys[start] ^= keyBit;
+			break;
+
+		case 1:
+			for (auto frame = start; frame < end; ++frame)
+			{
+				input.keys[frame] |= keyBit;
+			}
+			break;
+
+		case 2:
+			for (auto frame = start; frame < end; ++frame)
+			{
+				input.keys[frame] &= ~keyBit;
+			}
+			break;
+
+		case 3:
+			// Most programs only check one key at a time, so mostly try single keys.
+			input.keys[start] = (rnd.Next(4) == 0 ? static_cast<u16>(rnd.Next()) : keyBit);
+			break;
+
+		case 4:
+			input.seed = rnd.Next();
+			break;
+
+		case 5:
+		{
+			const auto& other = corpus[rnd.Next(static_cast<u32>(corpus.size()))];
+			std::copy(other.keys.begin() + start, other.keys.begin() + end, input.keys.begin() + start);
+			break;
+		}
+		}
+	}
+}
+
+
+/**
+* Bucket of a hit count, so a loop running a few more times is only new when its count changes magnitude.
+*/
+static inline u8 GetHitBucket(u8 count)
+{
+	if (count <= 2) return count;
+	if (count == 3) return 4;
+	if (count < 8) return 8;
+	if (count < 16) return 16;
+	if (count < 32) return 32;
+	return (count < 128 ? 64 : 128);
+}
+
+
+/**
+* Returns whether or not coverage reached an edge hit bucket or an address that isn't in the seen maps.
+*/
+static bool HasNewCoverage(const Chip8Coverage& coverage, const u8* seenEdges, const u64* seenExecuted)
+{
+	const auto executed = coverage.GetExecutedBitmap();
+	for (size_t i = 0; i < CHIP8_MEMORY_SIZE / 64; ++i)
+	{
+		if ((executed[i] & ~seenExecuted[i]) != 0)
+		{
+			return true;
+		}
+	}
+
+	// Most of the edge map is untouched, so skip it 8 counters at a time.
+	const auto edges = coverage.GetEdgeCounts();
+	for (size_t i = 0; i < CHIP8_COVERAGE_EDGE_MAP_SIZE; i += 8)
+	{
+		u64 word;
+		std::memcpy(&word, edges + i, sizeof(word));
+		if (word == 0)
+		{
+			continue;
+		}
+
+		for (size_t j = i; j < i + 8; ++j)
+		{
+			if ((GetHitBucket(edges[j]) & ~seenEdges[j]) != 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+
+/**
+* Adds coverage to the seen maps.
+*/
+static void AddCoverage(const Chip8Coverage& coverage, u8* seenEdges, u64* seenExecuted)
+{
+	const auto executed = coverage.GetExecutedBitmap();
+	for (size_t i = 0; i < CHIP8_MEMORY_SIZE / 64; ++i)
+	{
+		seenExecuted[i] |= executed[i];
+	}
+
+	const auto edges = coverage.GetEdgeCounts();
+	for (size_t i = 0; i < CHIP8_COVERAGE_EDGE_MAP_SIZE; ++i)
+	{
+		seenEdges[i] |= GetHitBucket(edges[i]);
+	}
+}
+
+
+/**
+* Saves a crashing input, unless a crash at the same PC and opcode was already found.
+*/
+static void ReportCrash(FuzzShared& shared, const FuzzInput& input, const FuzzResult& result)
+{
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	if (!shared.crashes.insert((static_cast<u32>(result.PC) << 16) | result.op).second)
+	{
+		return;
+	}
+
+	std::ostringstream fileName;
+	fileName << shared.crashPrefix << std::hex << std::setfill('0') << std::setw(3) << result.PC << '-' << std::setw(4) << result.op
+		<< CHIP8_FUZZ_INPUT_EXTENSION;
+
+	std::cerr << std::hex << "CPU error at pc=0x" << result.PC << " op=0x" << result.op << std::dec
+		<< " after " << result.frames << " frames";
+	if (SaveInput(fileName.str(), input))
+	{
+		std::cerr << ", saved to \"" << fileName.str() << "\"." << std::endl;
+	}
+	else
+	{
+		std::cerr << ", failed to save to \"" << fileName.str() << "\"." << std::endl;
+	}
+}
+
+
+/**
+* Mutates inputs from the corpus and runs them until told to stop.
+* Each worker checks coverage against its own copy of the seen maps, and only takes the lock when that finds
+* something new - the copy is refreshed from the shared maps whenever it does.
+*/
+static void RunWorker(FuzzShared& shared, unsigned int index)
+{
+	// The CPU reports every ignored SYS instruction and CPU error, which would drown the progress report (and slow
+	// the worker down) - give it a stream of its own that discards them.
+	std::ostream nullLog(nullptr);
+	FuzzMachine machine(shared.target, &nullLog);
+	FuzzRandom rnd(static_cast<u64>(std::chrono::steady_clock::now().time_since_epoch().count()) ^ (0x9E3779B97F4A7C15ULL * (index + 1)));
+
+	std::vector<FuzzInput> corpus;
+	std::vector<u8> seenEdges(CHIP8_COVERAGE_EDGE_MAP_SIZE, 0);
+	std::vector<u64> seenExecuted(CHIP8_MEMORY_SIZE / 64, 0);
+	FuzzInput input;
+
+	while (!shared.isStopping.load(std::memory_order_relaxed))
+	{
+		if (shared.corpusSize.load(std::memory_order_acquire) != corpus.size())
+		{
+			std::lock_guard<std::mutex> lock(shared.mutex);
+			corpus.insert(corpus.end(), shared.corpus.begin() + corpus.size(), shared.corpus.end());
+			std::copy(std::begin(shared.seenEdges), std::end(shared.seenEdges), seenEdges.begin());
+			std::copy(std::begin(shared.seenExecuted), std::end(shared.seenExecuted), seenExecuted.begin());
+		}
+
+		input = corpus[rnd.Next(static_cast<u32>(corpus.size()))];
+		Mutate(input, corpus, rnd);
+
+		const auto result = machine.Run(input);
+		shared.stats[index].execs.fetch_add(1, std::memory_order_relaxed);
+		if (!result.isOK)
+		{
+			ReportCrash(shared, input, result);
+			continue;
+		}
+
+		if (!HasNewCoverage(machine.GetCoverage(), seenEdges.data(), seenExecuted.data()))
+		{
+			continue;
+		}
+
+		// Another worker may have found the same coverage first.
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		if (HasNewCoverage(machine.GetCoverage(), shared.seenEdges, shared.seenExecuted))
+		{
+			AddCoverage(machine.GetCoverage(), shared.seenEdges, shared.seenExecuted);
+			shared.corpus.push_back(input);
+			shared.corpusSize.store(shared.corpus.size(), std::memory_order_release);
+		}
+		else
+		{
+			AddCoverage(machine.GetCoverage(), seenEdges.data(), seenExecuted.data());
+		}
+	}
+}
+
+
+/**
+* Counts the edge hit buckets and addresses seen so far. Must be called with the lock held.
+*/
+static void CountSeen(const FuzzShared& shared, size_t* outEdges, size_t* outAddresses)
+{
+	*outEdges = std::count_if(std::begin(shared.seenEdges), std::end(shared.seenEdges), [](u8 buckets) { return buckets != 0; });
+
+	*outAddresses = 0;
+	for (const auto word : shared.seenExecuted)
+	{
+		for (auto bits = word; bits != 0; bits &= bits - 1)
+		{
+			++*outAddresses;
+		}
+	}
+}
+
+
+/**
+* Runs a saved input once and prints its result.
+* Returns true if the CPU ran it without error, false otherwise.
+*/
+static bool Replay(const FuzzTarget& target, const std::string& inputFileName)
+{
+	FuzzInput input;
+	if (!LoadInput(inputFileName, &input))
+	{
+		std::cerr << "Failed to load input \"" << inputFileName << "\"." << std::endl;
+		return false;
+	}
+
+	FuzzMachine machine(target, nullptr);
+	if (!machine.IsLoaded())
+	{
+		std::cerr << "The program doesn't fit in memory." << std::endl;
+		return false;
+	}
+
+	const auto result = machine.Run(input);
+	std::cout << inputFileName << " status=" << (result.isOK ? "ok" : "cpu_error")
+		<< " frames=" << result.frames
+		<< " seed=" << input.seed
+		<< std::hex
+		<< " pc=0x" << result.PC
+		<< " op=0x" << result.op
+		<< std::dec << std::endl;
+	return result.isOK;
+}
+
+
+/**
+* Main entry point for the fuzzer.
+*/
+int main(int argc, char* argv[])
+{
+	unsigned long seconds = 60;
+	unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+	u32 frames = 300;
+	auto isQuirksGiven = false, isPlatformGiven = false;
+	u32 quirks = CHIP8_QUIRKS_DEFAULT;
+	auto platform = Chip8Platform::Chip8;
+	auto randomEngine = Chip8RandomEngine::PCG;
+	std::string crashPrefix = "crash-", replayFileName, programFileName;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--time") == 0 && hasValue)
+		{
+			seconds = std::strtoul(argv[++i], nullptr, 0);
+		}
+		else if (std::strcmp(argv[i], "--jobs") == 0 && hasValue)
+		{
+			jobs = std::max(1u, static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			frames = std::max(1u, static_cast<u32>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (std::strcmp(argv[i], "--quirks") == 0 && hasValue)
+		{
+			if (!Chip8QuirksHelper::Parse(argv[++i], &quirks))
+			{
+				std::cerr << "Unknown quirk profile \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+			isQuirksGiven = true;
+		}
+		else if (std::strcmp(argv[i], "--rng") == 0 && hasValue)
+		{
+			if (!Chip8RandomHelper::Parse(argv[++i], &randomEngine))
+			{
+				std::cerr << "Unknown random number generator \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[i], "--eti") == 0 || std::strcmp(argv[i], "--chip8") == 0)
+		{
+			isPlatformGiven = true;
+			platform = (argv[i][2] == 'e' ? Chip8Platform::ETI660 : Chip8Platform::Chip8);
+		}
+		else if (std::strcmp(argv[i], "--crashes") == 0 && hasValue)
+		{
+			crashPrefix = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+		{
+			replayFileName = argv[++i];
+		}
+		else if (argv[i][0] == '-' || !programFileName.empty())
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{
+			programFileName = argv[i];
+		}
+	}
+
+	if (programFileName.empty())
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FuzzShared shared;
+	Chip8RomLoadResult loadResult;
+	shared.target.image = Chip8RomCache::GetShared().Load(programFileName, CHIP8_ROM_MAX_SIZE, &loadResult);
+	if (shared.target.image == nullptr)
+	{
+		std::cerr << "Failed to load program \"" << programFileName << "\" - " << Chip8RomCache::GetResultText(loadResult) << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const auto analysis = Chip8RomAnalyzer::Analyze(shared.target.image->data.data(), shared.target.image->data.size());
+	shared.target.platform = (isPlatformGiven ? platform : analysis.platform);
+	shared.target.quirks = (isQuirksGiven ? quirks : analysis.quirks);
+	shared.target.frames = frames;
+	shared.target.randomEngine = randomEngine;
+
+	if (!replayFileName.empty())
+	{
+		return (Replay(shared.target, replayFileName) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	if (!FuzzMachine(shared.target, nullptr).IsLoaded())
+	{
+		std::cerr << "The program doesn't fit in memory." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Start from a single input that presses nothing.
+	shared.crashPrefix = crashPrefix;
+	shared.corpus.push_back(FuzzInput{ 0, std::vector<u16>(frames, 0) });
+	std::fill(std::begin(shared.seenEdges), std::end(shared.seenEdges), 0);
+	std::fill(std::begin(shared.seenExecuted), std::end(shared.seenExecuted), 0);
+	shared.corpusSize = shared.corpus.size();
+	shared.isStopping = false;
+	size_t statsSpace = sizeof(FuzzWorkerStats) * jobs + alignof(FuzzWorkerStats);
+	shared.statsStorage = std::make_unique<char[]>(statsSpace);
+	void* statsStart = shared.statsStorage.get();
+	shared.stats = static_cast<FuzzWorkerStats*>(std::align(alignof(FuzzWorkerStats), sizeof(FuzzWorkerStats) * jobs, statsStart, statsSpace));
+	for (unsigned int i = 0; i < jobs; ++i)
+	{
+		new (&shared.stats[i]) FuzzWorkerStats;
+		shared.stats[i].execs = 0;
+	}
+
+	std::cerr << "Fuzzing \"" << programFileName << "\" as " << Chip8PlatformHelper::GetName(shared.target.platform)
+		<< std::hex << " (quirks 0x" << shared.target.quirks << std::dec << ") with " << jobs << " workers, "
+		<< frames << " frames per input, for " << seconds << " s." << std::endl;
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < jobs; ++i)
+	{
+		workers.emplace_back(RunWorker, std::ref(shared), i);
+	}
+
+	// Report progress every second.
+	const auto startTime = std::chrono::steady_clock::now();
+	unsigned long long lastExecs = 0;
+	auto lastTime = startTime;
+	for (unsigned long elapsed = 1; elapsed <= seconds; ++elapsed)
+	{
+		std::this_thread::sleep_until(startTime + std::chrono::seconds(elapsed));
+
+		unsigned long long execs = 0;
+		for (unsigned int i = 0; i < jobs; ++i)
+		{
+			execs += shared.stats[i].execs.load(std::memory_order_relaxed);
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		const auto execsPerSecond = (execs - lastExecs) / std::chrono::duration<double>(now - lastTime).count();
+		lastExecs = execs;
+		lastTime = now;
+
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		size_t edges, addresses;
+		CountSeen(shared, &edges, &addresses);
+		std::cerr << "[" << elapsed << " s] execs " << execs << " (" << static_cast<unsigned long long>(execsPerSecond) << "/s)"
+			<< ", corpus " << shared.corpus.size()
+			<< ", edges " << edges
+			<< ", addresses " << addresses
+			<< ", crashes " << shared.crashes.size() << std::endl;
+	}
+
+	shared.isStopping = true;
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	unsigned long long execs = 0;
+	for (unsigned int i = 0; i < jobs; ++i)
+	{
+		execs += shared.stats[i].execs.load();
+	}
+
+	const auto totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Ran " << execs << " inputs in " << totalSeconds << " s (" << static_cast<unsigned long long>(execs / totalSeconds)
+		<< "/s), found " << shared.corpus.size() << " interesting inputs and " << shared.crashes.size() << " distinct crashes." << std::endl;
+	return (shared.crashes.empty() ? EXIT_SUCCESS : EXIT_FAILURE);
+}
\ No newline at end of file
@@ -0,0 +1,459 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Chip8AudioRecorder.h"
+#include "Chip8Beeper.h"
+#include "Chip8Coverage.h"
+#include "Chip8CPU.h"
+#include "Chip8Debugger.h"
+#include "Chip8Display.h"
+#include "Chip8GdbServer.h"
+#include "Chip8Helper.h"
+#include "Chip8Keyboard.h"
+#include "Chip8Memory.h"
+#include "Chip8Opcodes.h"
+#include "Chip8Platform.h"
+#include "Chip8Quirks.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomCache.h"
+#include "Chip8RomPack.h"
+#include "Chip8Random.h"
+#include "Chip8Tracer.h"
+
+/**
+* Options for a headless run.
+*/
+struct HeadlessOptions
+{
+	unsigned long frames = 600;
+	u64 seed = 0;
+	Chip8RandomEngine randomEngine = Chip8RandomEngine::PCG;
+	bool isETI660 = false;
+	bool isAutoDetecting = false;
+	u32 quirks = CHIP8_QUIRKS_DEFAULT;
+	std::string wavFileName;
+	std::string packFileName;
+	std::vector<u16> breakpoints;
+	std::vector<u16> watchpoints;
+	std::vector<Chip8BreakCondition> conditions;
+	u16 gdbPort = 0;
+	std::string traceFileName;
+	std::string coverageFileName;
+};
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <program>..." << std::endl
+		<< "       " << programName << " [options] --pack <pack" CHIP8_ROM_PACK_EXTENSION "> [<name or hash>...]" << std::endl
+		<< "Runs Chip-8 programs without a window or audio device and prints one result line per program." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --frames <n>   Frames (60ths of a second of emulated time) to run for (default: 600)" << std::endl
+		<< "  --seed <n>     Seed for the RND instruction (default: 0)" << std::endl
+		<< "  --rng <e>      Random number generator for the RND instruction (pcg, xorshift or cosmac, default: pcg)" << std::endl
+		<< "  --eti          Programs are ETI 660 programs" << std::endl
+		<< "  --auto         Detect the platform, quirks and steps per frame of each program by analysing it" << std::endl
+		<< "  --quirks <q>   Quirk profile (default, vip, chip48, schip or xochip) or flags to run programs with (default: default)" << std::endl
+		<< "  --wav <file>   Write the audio of the program to a WAV file (only with a single program)" << std::endl
+		<< "  --pack <file>  Run programs from a program pack, or every program in it if none are named." << std::endl
+		<< "                 Each program runs on the platform and with the quirks recorded for it in the pack." << std::endl
+		<< "  --break <a>    Stop a program when it reaches address a" << std::endl
+		<< "  --watch <a>    Stop a program when it is about to read or write the byte at address a" << std::endl
+		<< "  --break-if <c> Stop a program when a condition such as V3==0x10, I>0x400 or DT!=0 becomes true" << std::endl
+		<< "  --gdb <port>   Wait for a GDB client on a local port before running (only with a single program)" << std::endl
+		<< "  --trace <file> Record the executed instructions to a " CHIP8_TRACE_EXTENSION " trace file (only with a single program)" << std::endl
+		<< "  --coverage <file> Write which instructions were executed to a " CHIP8_COVERAGE_EXTENSION " coverage file (only with a single program)" << std::endl;
+}
+
+
+/**
+* Returns the 64-bit FNV-1a hash of the display contents.
+*/
+static u64 HashDisplay(Chip8Display& display)
+{
+	auto hash = Chip8Helper::HashFNV1a(nullptr, 0);
+	for (u8 y = 0; y < display.GetHeight(); ++y)
+	{
+		for (u8 x = 0; x < display.GetWidth(); ++x)
+		{
+			const auto pix = display.GetPixelState(x, y);
+			hash = Chip8Helper::HashFNV1a(&pix, 1, hash);
+		}
+	}
+
+	return hash;
+}
+
+
+/**
+* Runs a single program image and prints its result line.
+* ram is reused between programs, and only reallocated if the program needs a different amount.
+* Returns true on success, false on failure.
+*/
+static bool RunProgram(const std::string& name, const u8* data, size_t size, Chip8Platform platform, u32 quirks,
+	std::unique_ptr<Chip8Memory>& ram, const HeadlessOptions& options)
+{
+	std::cout << name;
+
+	const auto isETI660 = Chip8PlatformHelper::IsETI660(platform);
+	const u16 memSize = (isETI660 ? CHIP8_MEMORY_ETI660_SIZE : CHIP8_MEMORY_SIZE);
+	if (ram == nullptr || ram->GetAllocatedSize() != memSize)
+	{
+		ram = std::make_unique<Chip8Memory>(memSize);
+	}
+	else
+	{
+		ram->Reset();
+	}
+
+	const u16 programStart = (isETI660 ? CHIP8_PROGRAM_ETI660_START : CHIP8_PROGRAM_START);
+	if (size > static_cast<size_t>(memSize - programStart) || !ram->WriteBlock(programStart, data, static_cast<u16>(size)))
+	{
+		std::cout << " status=load_error" << std::endl;
+		return false;
+	}
+
+	// Record the audio from emulated time - no audio device is opened.
+	auto recorder = std::make_unique<Chip8AudioRecorder>(!options.wavFileName.empty());
+	auto& recorderRef = *recorder;
+
+	Chip8Display display;
+	Chip8Keyboard keyboard;
+	Chip8Beeper beeper(std::move(recorder));
+	Chip8CPU cpu(*ram, display, keyboard, &beeper, isETI660, quirks);
+	cpu.SetStepsPerFrame(Chip8PlatformHelper::GetStepsPerFrame(platform));
+	cpu.SetRealTimeTimers(false);
+	cpu.SeedRandom(options.seed);
+	cpu.SetRandomEngine(options.randomEngine);
+
+	Chip8Debugger debugger;
+	for (const auto address : options.breakpoints)
+	{
+		debugger.AddBreakpoint(address);
+	}
+	for (const auto address : options.watchpoints)
+	{
+		debugger.AddWatchpoint(address, 1, CHIP8_OP_MEMORY_READ | CHIP8_OP_MEMORY_WRITE);
+	}
+	for (const auto& condition : options.conditions)
+	{
+		debugger.AddCondition(condition);
+	}
+	cpu.SetDebugger(&debugger);
+
+	Chip8Tracer tracer;
+	if (!options.traceFileName.empty())
+	{
+		if (!tracer.Open(options.traceFileName))
+		{
+			std::cout << " status=trace_error" << std::endl;
+			return false;
+		}
+
+		cpu.SetTracer(&tracer);
+	}
+
+	Chip8Coverage coverage;
+	if (!options.coverageFileName.empty())
+	{
+		cpu.SetCoverage(&coverage);
+	}
+
+	// The client controls the run, so its breaks don't end it.
+	Chip8GdbServer gdbServer;
+	if (options.gdbPort != 0)
+	{
+		if (!gdbServer.Start(options.gdbPort))
+		{
+			std::cout << " status=gdb_error" << std::endl;
+			return false;
+		}
+
+		while (!gdbServer.IsClientAttached())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(CHIP8_GDB_POLL_MILLISECONDS));
+		}
+	}
+
+	unsigned long frame = 0;
+	auto isOK = true;
+	while (frame < options.frames)
+	{
+		if (gdbServer.IsRunning())
+		{
+			gdbServer.Poll(cpu, *ram);
+			if (debugger.IsPaused())
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+		}
+		else if (debugger.IsPaused())
+		{
+			break;
+		}
+
+		keyboard.Update();
+		if (!cpu.RunFrame())
+		{
+			isOK = false;
+			break;
+		}
+
+		++frame;
+	}
+
+	std::cout << std::dec << " status=" << (!isOK ? "cpu_error" : (debugger.IsPaused() ? "break" : "ok"))
+		<< " platform=" << Chip8PlatformHelper::GetName(platform)
+		<< std::hex << " quirks=0x" << quirks << std::dec
+		<< " frames=" << frame
+		<< std::hex
+		<< " pc=0x" << cpu.GetRegisters().PC
+		<< " display=" << HashDisplay(display)
+		<< " audio=" << recorderRef.GetHash()
+		<< std::dec
+		<< " audio_samples=" << recorderRef.GetSampleCount()
+		<< std::endl;
+
+	if (!options.wavFileName.empty() && !recorderRef.WriteWAV(options.wavFileName))
+	{
+		std::cerr << "Failed to write audio to \"" << options.wavFileName << "\"." << std::endl;
+		return false;
+	}
+
+	if (!options.coverageFileName.empty() && !coverage.Save(options.coverageFileName))
+	{
+		std::cerr << "Failed to write coverage to \"" << options.coverageFileName << "\"." << std::endl;
+		return false;
+	}
+
+	if (tracer.IsOpen())
+	{
+		const auto records = tracer.GetRecordCount();
+		if (!tracer.Close())
+		{
+			std::cerr << "Failed to write the trace to \"" << options.traceFileName << "\"." << std::endl;
+			return false;
+		}
+
+		std::cerr << "Traced " << records << " instructions to \"" << options.traceFileName << "\"." << std::endl;
+	}
+
+	return isOK;
+}
+
+
+/**
+* Returns the quirks to run a program from a pack with - 0 in a pack means the defaults for the program's platform.
+*/
+static u32 GetEntryQuirks(const Chip8RomPackEntry& entry)
+{
+	return (entry.quirks != 0 ? entry.quirks : Chip8QuirksHelper::GetPlatformQuirks(entry.platform));
+}
+
+
+/**
+* Runs the named programs from a pack, or all of them if none are named.
+* Returns true if they all ran successfully, false otherwise.
+*/
+static bool RunPack(const std::vector<std::string>& programNames, std::unique_ptr<Chip8Memory>& ram, const HeadlessOptions& options)
+{
+	// Map the whole pack once - programs are then read straight from the mapping.
+	Chip8RomPack pack;
+	if (!pack.Open(options.packFileName))
+	{
+		std::cerr << "Failed to open program pack \"" << options.packFileName << "\"." << std::endl;
+		return false;
+	}
+
+	auto isAllOK = true;
+	Chip8RomPackEntry entry;
+	if (programNames.empty())
+	{
+		for (u32 i = 0; i < pack.GetEntryCount(); ++i)
+		{
+			pack.GetEntry(i, &entry);
+			isAllOK &= RunProgram(std::string(entry.name, entry.nameLength), entry.data, entry.size, entry.platform, GetEntryQuirks(entry), ram, options);
+		}
+	}
+	else
+	{
+		for (const auto& name : programNames)
+		{
+			if (!pack.Find(name, &entry))
+			{
+				std::cout << name << " status=not_found" << std::endl;
+				isAllOK = false;
+				continue;
+			}
+
+			isAllOK &= RunProgram(name, entry.data, entry.size, entry.platform, GetEntryQuirks(entry), ram, options);
+		}
+	}
+
+	return isAllOK;
+}
+
+
+/**
+* Runs program files, loading them through the program cache.
+* Returns true if they all ran successfully, false otherwise.
+*/
+static bool RunFiles(const std::vector<std::string>& fileNames, std::unique_ptr<Chip8Memory>& ram, const HeadlessOptions& options)
+{
+	auto isAllOK = true;
+	std::chrono::steady_clock::duration analysisTime(0);
+	for (const auto& fileName : fileNames)
+	{
+		// Map the program and get its image from the cache.
+		const auto image = Chip8RomCache::GetShared().Load(fileName);
+		if (image == nullptr)
+		{
+			std::cout << fileName << " status=load_error" << std::endl;
+			isAllOK = false;
+			continue;
+		}
+
+		auto platform = (options.isETI660 ? Chip8Platform::ETI660 : Chip8Platform::Chip8);
+		auto quirks = options.quirks;
+		if (options.isAutoDetecting)
+		{
+			const auto analysisStart = std::chrono::steady_clock::now();
+			const auto analysis = Chip8RomAnalyzer::Analyze(image->data.data(), image->data.size());
+			analysisTime += std::chrono::steady_clock::now() - analysisStart;
+
+			platform = analysis.platform;
+			quirks = analysis.quirks;
+		}
+
+		isAllOK &= RunProgram(fileName, image->data.data(), image->data.size(), platform, quirks, ram, options);
+	}
+
+	if (options.isAutoDetecting && !fileNames.empty())
+	{
+		const auto analysisMicroseconds = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(analysisTime).count();
+		std::cerr << "Program analysis: " << analysisMicroseconds << " us total, " << analysisMicroseconds / fileNames.size() << " us per program" << std::endl;
+	}
+
+	const auto& cache = Chip8RomCache::GetShared();
+	std::cerr << "Program cache: " << cache.GetSize() << " images, " << cache.GetHitCount() << " hits, " << cache.GetMissCount() << " misses" << std::endl;
+	return isAllOK;
+}
+
+
+/**
+* Main entry point for the headless runner.
+*/
+int main(int argc, char* argv[])
+{
+	HeadlessOptions options;
+	std::vector<std::string> programNames;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+		{
+			options.frames = std::strtoul(argv[++i], nullptr, 0);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+		{
+			options.seed = std::strtoull(argv[++i], nullptr, 0);
+		}
+		else if (std::strcmp(argv[i], "--rng") == 0 && hasValue)
+		{
+			if (!Chip8RandomHelper::Parse(argv[++i], &options.randomEngine))
+			{
+				std::cerr << "Unknown random number generator \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[i], "--eti") == 0)
+		{
+			options.isETI660 = true;
+		}
+		else if (std::strcmp(argv[i], "--auto") == 0)
+		{
+			options.isAutoDetecting = true;
+		}
+		else if (std::strcmp(argv[i], "--quirks") == 0 && hasValue)
+		{
+			if (!Chip8QuirksHelper::Parse(argv[++i], &options.quirks))
+			{
+				std::cerr << "Unknown quirk profile \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[i], "--wav") == 0 && hasValue)
+		{
+			options.wavFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--pack") == 0 && hasValue)
+		{
+			options.packFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+		{
+			options.traceFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--coverage") == 0 && hasValue)
+		{
+			options.coverageFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--gdb") == 0 && hasValue)
+		{
+			options.gdbPort = static_cast<u16>(std::strtoul(argv[++i], nullptr, 0));
+		}
+		else if (std::strcmp(argv[i], "--break") == 0 && hasValue)
+		{
+			options.breakpoints.push_back(static_cast<u16>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (std::strcmp(argv[i], "--watch") == 0 && hasValue)
+		{
+			options.watchpoints.push_back(static_cast<u16>(std::strtoul(argv[++i], nullptr, 0)));
+		}
+		else if (std::strcmp(argv[i], "--break-if") == 0 && hasValue)
+		{
+			Chip8BreakCondition condition;
+			if (!Chip8Debugger::ParseCondition(argv[++i], &condition))
+			{
+				std::cerr << "Invalid break condition \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+			options.conditions.push_back(condition);
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{
+			programNames.push_back(argv[i]);
+		}
+	}
+
+	if ((programNames.empty() && options.packFileName.empty()) ||
+		(!options.wavFileName.empty() && programNames.size() != 1) ||
+		(options.gdbPort != 0 && programNames.size() != 1) ||
+		(!options.traceFileName.empty() && programNames.size() != 1) ||
+		(!options.coverageFileName.empty() && programNames.size() != 1))
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::unique_ptr<Chip8Memory> ram;
+	const auto isAllOK = (options.packFileName.empty() ? RunFiles(programNames, ram, options) : RunPack(programNames, ram, options));
+	return (isAllOK ? EXIT_SUCCESS : EXIT_FAILURE);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Chip8Constants.h"
+#include "Chip8MappedFile.h"
+#include "Chip8Platform.h"
+#include "Chip8Quirks.h"
+#include "Chip8RomAnalyzer.h"
+#include "Chip8RomPack.h"
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " -o <pack" CHIP8_ROM_PACK_EXTENSION "> [options] <program>..." << std::endl
+		<< "       " << programName << " --list <pack" CHIP8_ROM_PACK_EXTENSION ">" << std::endl
+		<< "Packs Chip-8 programs into a single program pack, or lists the contents of one." << std::endl
+		<< std::endl
+		<< "Options (apply to the programs after them):" << std::endl
+		<< "  --platform <name>  Platform of the programs: auto, chip8, eti660, hires, schip or xochip (default: auto)" << std::endl
+		<< "  --quirks <q>       Quirk profile or flags of the programs (default: the platform defaults, or detected with auto)" << std::endl;
+}
+
+
+/**
+* Lists the programs in a pack.
+* Returns true on success, false on failure.
+*/
+static bool ListPack(const std::string& fileName)
+{
+	Chip8RomPack pack;
+	if (!pack.Open(fileName))
+	{
+		std::cerr << "Failed to open program pack \"" << fileName << "\"." << std::endl;
+		return false;
+	}
+
+	for (u32 i = 0; i < pack.GetEntryCount(); ++i)
+	{
+		Chip8RomPackEntry entry;
+		pack.GetEntry(i, &entry);
+		std::cout << std::hex << std::setfill('0') << std::setw(16) << entry.hash << std::dec
+			<< ' ' << std::setfill(' ') << std::setw(6) << entry.size
+			<< ' ' << std::setw(6) << std::left << Chip8PlatformHelper::GetName(entry.platform) << std::right
+			<< " 0x" << std::hex << entry.quirks << std::dec
+			<< ' ' << std::string(entry.name, entry.nameLength) << std::endl;
+	}
+
+	return true;
+}
+
+
+/**
+* Main entry point for the pack tool.
+*/
+int main(int argc, char* argv[])
+{
+	if (argc == 3 && std::strcmp(argv[1], "--list") == 0)
+	{
+		return (ListPack(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	Chip8RomPackBuilder builder;
+	std::string outFileName;
+	// Detect the platform and quirks of each program unless they are given.
+	auto isAutoDetecting = true;
+	auto platform = Chip8Platform::Chip8;
+	u32 quirks = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if ((std::strcmp(argv[i], "-o") == 0 || std::strcmp(argv[i], "--output") == 0) && hasValue)
+		{
+			outFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--platform") == 0 && hasValue)
+		{
+			isAutoDetecting = (std::strcmp(argv[++i], "auto") == 0);
+			if (!isAutoDetecting && !Chip8PlatformHelper::Parse(argv[i], &platform))
+			{
+				std::cerr << "Unknown platform \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[i], "--quirks") == 0 && hasValue)
+		{
+			if (!Chip8QuirksHelper::Parse(argv[++i], &quirks))
+			{
+				std::cerr << "Unknown quirk profile \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{
+			Chip8MappedFile file;
+			if (!file.Open(argv[i]))
+			{
+				std::cerr << "Failed to open program \"" << argv[i] << "\"." << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			// Programs are named by their path, with the same separators on every system.
+			auto name = std::string(argv[i]);
+			std::replace(name.begin(), name.end(), '\\', '/');
+			auto programPlatform = platform;
+			auto programQuirks = quirks;
+			if (isAutoDetecting)
+			{
+				// Given quirks still win over detected ones.
+				const auto analysis = Chip8RomAnalyzer::Analyze(file.GetData(), file.GetSize());
+				programPlatform = analysis.platform;
+				if (programQuirks == 0 && analysis.quirks != Chip8QuirksHelper::GetPlatformQuirks(analysis.platform))
+				{
+					programQuirks = analysis.quirks;
+				}
+			}
+
+			if (!builder.Add(name, file.GetData(), file.GetSize(), programPlatform, programQuirks))
+			{
+				std::cerr << "Failed to add program \"" << argv[i] << "\" - is it listed twice?" << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	if (outFileName.empty() || builder.GetEntryCount() == 0)
+	{
+		PrintUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (!builder.Write(outFileName))
+	{
+		std::cerr << "Failed to write program pack \"" << outFileName << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "Packed " << builder.GetEntryCount() << " programs into \"" << outFileName << "\"." << std::endl;
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
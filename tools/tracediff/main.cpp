@@ -0,0 +1,182 @@
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "Chip8Constants.h"
+#include "Chip8Disassembler.h"
+#include "Chip8Tracer.h"
+
+
+/**
+* Prints the usage message.
+*/
+static void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options] <trace" CHIP8_TRACE_EXTENSION "> <trace" CHIP8_TRACE_EXTENSION ">" << std::endl
+		<< "Compares two execution traces, reporting the first instruction where they diverge." << std::endl
+		<< "Exits with 0 if the traces match, 1 if they diverge and 2 on error." << std::endl
+		<< std::endl
+		<< "Options:" << std::endl
+		<< "  --context <n>  Instructions to show before the divergence (default: 8)" << std::endl;
+}
+
+
+/**
+* Formats a record as its cycle, PC, opcode, instruction and the registers it changed.
+*/
+static std::string FormatRecord(const Chip8TraceRecord& record)
+{
+	std::ostringstream oss;
+	oss << std::dec << record.cycle << std::hex << ": 0x" << record.PC << "  " << record.op << "  "
+		<< Chip8Disassembler::FormatInstruction(record.op);
+
+	const auto& reg = record.registers;
+	oss << "  [";
+	for (u8 i = 0; i < 16; ++i)
+	{
+		if ((record.changed & (1 << i)) != 0)
+		{
+			oss << " V" << std::uppercase << +i << std::nouppercase << "=0x" << +reg.V[i];
+		}
+	}
+	if ((record.changed & CHIP8_TRACE_CHANGED_I) != 0) oss << " I=0x" << reg.I;
+	if ((record.changed & CHIP8_TRACE_CHANGED_SP) != 0) oss << " SP=0x" << +reg.SP;
+	if ((record.changed & CHIP8_TRACE_CHANGED_DT) != 0) oss << " DT=0x" << +reg.DT;
+	if ((record.changed & CHIP8_TRACE_CHANGED_ST) != 0) oss << " ST=0x" << +reg.ST;
+	oss << " ]";
+
+	return oss.str();
+}
+
+
+/**
+* Lists how two records differ, or returns an empty string if they match.
+*/
+static std::string DescribeDifferences(const Chip8TraceRecord& a, const Chip8TraceRecord& b)
+{
+	std::ostringstream oss;
+	oss << std::hex;
+	if (a.PC != b.PC) oss << " PC 0x" << a.PC << " vs 0x" << b.PC << ";";
+	if (a.op != b.op) oss << " opcode 0x" << a.op << " vs 0x" << b.op << ";";
+	for (u8 i = 0; i < 16; ++i)
+	{
+		if (a.registers.V[i] != b.registers.V[i])
+		{
+			oss << " V" << std::uppercase << +i << std::nouppercase << " 0x" << +a.registers.V[i] << " vs 0x" << +b.registers.V[i] << ";";
+		}
+	}
+	if (a.registers.I != b.registers.I) oss << " I 0x" << a.registers.I << " vs 0x" << b.registers.I << ";";
+	if (a.registers.SP != b.registers.SP) oss << " SP 0x" << +a.registers.SP << " vs 0x" << +b.registers.SP << ";";
+	if (a.registers.DT != b.registers.DT) oss << " DT 0x" << +a.registers.DT << " vs 0x" << +b.registers.DT << ";";
+	if (a.registers.ST != b.registers.ST) oss << " ST 0x" << +a.registers.ST << " vs 0x" << +b.registers.ST << ";";
+
+	return oss.str();
+}
+
+
+/**
+* Main entry point for the trace diff tool.
+*/
+int main(int argc, char* argv[])
+{
+	size_t contextSize = 8;
+	std::string fileNames[2];
+	int fileCount = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const auto hasValue = (i + 1 < argc);
+		if (std::strcmp(argv[i], "--context") == 0 && hasValue)
+		{
+			contextSize = std::strtoul(argv[++i], nullptr, 0);
+		}
+		else if (argv[i][0] == '-' || fileCount == 2)
+		{
+			PrintUsage(argv[0]);
+			return 2;
+		}
+		else
+		{
+			fileNames[fileCount++] = argv[i];
+		}
+	}
+
+	if (fileCount != 2)
+	{
+		PrintUsage(argv[0]);
+		return 2;
+	}
+
+	Chip8TraceReader readers[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		if (!readers[i].Open(fileNames[i]))
+		{
+			std::cerr << "Failed to open trace \"" << fileNames[i] << "\"." << std::endl;
+			return 2;
+		}
+	}
+
+	// The instructions leading up to a divergence, which both traces agree on.
+	std::deque<Chip8TraceRecord> context;
+	Chip8TraceRecord records[2];
+	u64 cycle = 0;
+	while (true)
+	{
+		const auto hasA = readers[0].Next(&records[0]);
+		const auto hasB = readers[1].Next(&records[1]);
+		for (int i = 0; i < 2; ++i)
+		{
+			if (!(i == 0 ? hasA : hasB) && !readers[i].IsAtEnd())
+			{
+				std::cerr << "Trace \"" << fileNames[i] << "\" is truncated after " << cycle << " instructions." << std::endl;
+				return 2;
+			}
+		}
+
+		if (!hasA && !hasB)
+		{
+			std::cout << "Traces match (" << cycle << " instructions)." << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		const auto differences = (hasA && hasB ? DescribeDifferences(records[0], records[1]) : std::string());
+		if (!hasA || !hasB || !differences.empty())
+		{
+			std::cout << "Traces diverge at cycle " << cycle << ":" << std::endl;
+			for (const auto& record : context)
+			{
+				std::cout << "     " << FormatRecord(record) << std::endl;
+			}
+
+			for (int i = 0; i < 2; ++i)
+			{
+				std::cout << (i == 0 ? "  A: " : "  B: ");
+				if (i == 0 ? hasA : hasB)
+				{
+					std::cout << FormatRecord(records[i]) << std::endl;
+				}
+				else
+				{
+					std::cout << "(end of trace)" << std::endl;
+				}
+			}
+
+			if (!differences.empty())
+			{
+				std::cout << "Differences:" << differences << std::endl;
+			}
+			return 1;
+		}
+
+		context.push_back(records[0]);
+		if (context.size() > contextSize)
+		{
+			context.pop_front();
+		}
+		++cycle;
+	}
+}
\ No newline at end of file